@@ -0,0 +1,335 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ActivityGate.h"
+#include "RmsLevelDetector.h"
+
+/**
+ * Converts a raw sample into a signed value, centred on zero.
+ */
+static inline int activity_gate_sample(int8_t s) { return s; }
+static inline int activity_gate_sample(uint8_t s) { return (int)s - 128; }
+static inline int activity_gate_sample(int16_t s) { return s; }
+static inline int activity_gate_sample(uint16_t s) { return (int)s - 32768; }
+
+/**
+ * Creates an ActivityGate attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams. The output has the same format as the input.
+ *
+ * @param source the DataSource to gate.
+ * @param id the ID used when raising events.
+ */
+ActivityGate::ActivityGate(DataSource &source, uint16_t id) : upstream(source)
+{
+    this->downstream = NULL;
+    this->id = id;
+    this->open = false;
+    this->level = 0;
+    this->floor = -1;
+    this->hangoverRemaining = 0;
+    this->passed = 0;
+    this->dropped = 0;
+
+    setThreshold(ACTIVITY_GATE_DEFAULT_THRESHOLD_DB);
+    setMinimumLevel(ACTIVITY_GATE_DEFAULT_MINIMUM_DB);
+    setHangover(ACTIVITY_GATE_DEFAULT_HANGOVER_MS);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller.
+ */
+ManagedBuffer
+ActivityGate::pull()
+{
+    // The pre-roll goes first, when the gate has just opened.
+    if (pending.length())
+    {
+        ManagedBuffer b = pending;
+        pending = ManagedBuffer();
+        return b;
+    }
+
+    return buffer;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+ActivityGate::pullRequest()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            level = measureBuffer<int8_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            level = measureBuffer<uint8_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            level = measureBuffer<int16_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            level = measureBuffer<uint16_t>(buf);
+            break;
+
+        default:
+            return DEVICE_NOT_SUPPORTED;
+    }
+
+    int n = buf.length() / DATASTREAM_FORMAT_BYTES_PER_SAMPLE(upstream.getFormat());
+
+    if (n == 0)
+        return DEVICE_OK;
+
+    if (floor < 0)
+        floor = level;
+
+    bool active = level >= minimum && level - floor >= threshold;
+
+    if (active)
+        hangoverRemaining = (int)(hangoverMs * upstream.getSampleRate() / 1000);
+    else
+        hangoverRemaining -= n;
+
+    floor += (level - floor) >> (level > floor ? ACTIVITY_GATE_FLOOR_RISE_SHIFT : ACTIVITY_GATE_FLOOR_FALL_SHIFT);
+
+    if (!open && active)
+    {
+        open = true;
+        MicroBitEvent(id, ACTIVITY_GATE_EVT_OPEN);
+
+        if (preRoll.length())
+        {
+            dropped--;
+            passed++;
+            pending = preRoll;
+            preRoll = ManagedBuffer();
+        }
+    }
+
+    if (open && hangoverRemaining <= 0)
+    {
+        open = false;
+
+        // With no hangover, the gate can close on the buffer that opened it, before the pre-roll is pulled.
+        if (pending.length())
+        {
+            pending = ManagedBuffer();
+            passed--;
+            dropped++;
+        }
+
+        MicroBitEvent(id, ACTIVITY_GATE_EVT_CLOSE);
+    }
+
+    if (open)
+        return deliver(buf);
+
+    preRoll = buf;
+    dropped++;
+
+    return DEVICE_OK;
+}
+
+/**
+ * Measures the level of the given buffer, interpreted as type T, in hundredths of a dB.
+ */
+template <typename T> int
+ActivityGate::measureBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    T *end = p + buf.length() / sizeof(T);
+    int64_t n = end - p;
+    int32_t sum = 0;
+    uint64_t sumSquares = 0;
+    int s;
+
+    if (n == 0)
+        return level;
+
+    while (p < end)
+    {
+        s = activity_gate_sample(*p++);
+        sum += s;
+        sumSquares += (uint32_t)(s * s);
+    }
+
+    // The variance, n^2 times over, so the mean (any DC offset) is removed without a division per sample.
+    uint64_t variance = (uint64_t)(sumSquares * n - (int64_t)sum * sum);
+
+    // 8 bit samples are treated as the top byte of a 16 bit sample.
+    if (sizeof(T) == 1)
+        variance <<= 16;
+
+    return rms_level_millibels(variance / (n * n));
+}
+
+/**
+ * Hands the given buffer, preceded by any pending pre-roll, to our downstream component.
+ */
+int
+ActivityGate::deliver(ManagedBuffer &buf)
+{
+    buffer = buf;
+    passed++;
+
+    if (downstream)
+    {
+        // One request per buffer, so both the pre-roll and this buffer are pulled.
+        if (pending.length())
+            downstream->pullRequest();
+
+        return downstream->pullRequest();
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+ActivityGate::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+ActivityGate::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+ActivityGate::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+ActivityGate::getFormat()
+{
+    return upstream.getFormat();
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+ActivityGate::getSampleRate()
+{
+    return upstream.getSampleRate();
+}
+
+/**
+ * Determines if the gate is currently passing buffers downstream.
+ */
+bool
+ActivityGate::isOpen()
+{
+    return open;
+}
+
+/**
+ * Determines the level of the most recent buffer, in dB.
+ */
+int
+ActivityGate::getLevel()
+{
+    return level / 100;
+}
+
+/**
+ * Determines the current noise floor estimate, in dB.
+ */
+int
+ActivityGate::getFloor()
+{
+    return floor < 0 ? 0 : floor / 100;
+}
+
+/**
+ * Determines the number of buffers passed downstream since the gate was created.
+ */
+uint32_t
+ActivityGate::getPassedCount()
+{
+    return passed;
+}
+
+/**
+ * Determines the number of buffers dropped since the gate was created.
+ */
+uint32_t
+ActivityGate::getDroppedCount()
+{
+    return dropped;
+}
+
+/**
+ * Sets the rise above the noise floor, in dB, that opens the gate.
+ */
+void
+ActivityGate::setThreshold(int dB)
+{
+    threshold = dB * 100;
+}
+
+/**
+ * Sets the level, in dB, below which the gate never opens.
+ */
+void
+ActivityGate::setMinimumLevel(int dB)
+{
+    minimum = dB * 100;
+}
+
+/**
+ * Sets the time the gate stays open after the activity ends.
+ * @param ms the hangover time, in milliseconds.
+ */
+void
+ActivityGate::setHangover(int ms)
+{
+    hangoverMs = max(0, ms);
+}
@@ -0,0 +1,176 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef ACTIVITY_GATE_H
+#define ACTIVITY_GATE_H
+
+#define DEVICE_ID_ACTIVITY_GATE 9015
+#define ACTIVITY_GATE_EVT_OPEN          1
+#define ACTIVITY_GATE_EVT_CLOSE         2
+
+// Default gate parameters. Levels are in dB, relative to an RMS of one 16 bit LSB.
+#define ACTIVITY_GATE_DEFAULT_THRESHOLD_DB  9       // Rise above the noise floor that opens the gate.
+#define ACTIVITY_GATE_DEFAULT_MINIMUM_DB    55      // Level below which the gate never opens.
+#define ACTIVITY_GATE_DEFAULT_HANGOVER_MS   300     // Time the gate stays open after the activity ends.
+
+// Noise floor smoothing per buffer, as right shifts. The floor follows falls quickly but rises slowly,
+// so it is not pulled up by the activity itself, but a persistent new noise eventually closes the gate.
+#define ACTIVITY_GATE_FLOOR_RISE_SHIFT      7
+#define ACTIVITY_GATE_FLOOR_FALL_SHIFT      2
+
+/**
+ * A DataSource and DataSink that only passes on its upstream while there is activity, so expensive
+ * downstream stages (recording, FFT, serial streaming) do no work at all in silence.
+ *
+ * Each buffer costs one pass to measure its level (its variance, so any DC offset is ignored) in integer
+ * arithmetic. The gate opens when the level rises the threshold above a tracked noise floor, and closes
+ * once it has fallen back for the hangover time. While closed, buffers are dropped without the downstream
+ * being called. The most recent dropped buffer is held back and delivered first when the gate opens,
+ * so the start of the activity is not lost: the downstream is asked to pull twice, and is handed the
+ * pre-roll and then the buffer that opened the gate.
+ *
+ * ACTIVITY_GATE_EVT_OPEN and ACTIVITY_GATE_EVT_CLOSE are raised as the gate changes state.
+ */
+class ActivityGate : public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    uint16_t        id;
+    ManagedBuffer   buffer;             // Buffer to be handed downstream on the next pull.
+    ManagedBuffer   preRoll;            // Most recent buffer dropped while closed.
+    ManagedBuffer   pending;            // Pre-roll to be handed downstream on the next pull, ahead of buffer.
+    bool            open;
+    int             level;              // Level of the most recent buffer, in hundredths of a dB.
+    int             floor;              // Noise floor, in hundredths of a dB. Negative until the first buffer.
+    int             hangoverRemaining;  // Samples until the gate closes, once activity has ended.
+    uint32_t        passed;
+    uint32_t        dropped;
+
+    int             threshold;          // Parameters, in hundredths of a dB.
+    int             minimum;
+    int             hangoverMs;
+
+    /**
+     * Measures the level of the given buffer, interpreted as type T, in hundredths of a dB.
+     */
+    template <typename T> int measureBuffer(ManagedBuffer &buf);
+
+    /**
+     * Hands the given buffer, preceded by any pending pre-roll, to our downstream component.
+     */
+    int deliver(ManagedBuffer &buf);
+
+    public:
+    /**
+     * Creates an ActivityGate attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams. The output has the same format as the input.
+     *
+     * @param source the DataSource to gate.
+     * @param id the ID used when raising events.
+     */
+    ActivityGate(DataSource &source, uint16_t id = DEVICE_ID_ACTIVITY_GATE);
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Determines if the gate is currently passing buffers downstream.
+     */
+    bool isOpen();
+
+    /**
+     * Determines the level of the most recent buffer, in dB.
+     */
+    int getLevel();
+
+    /**
+     * Determines the current noise floor estimate, in dB.
+     */
+    int getFloor();
+
+    /**
+     * Determines the number of buffers passed downstream since the gate was created.
+     */
+    uint32_t getPassedCount();
+
+    /**
+     * Determines the number of buffers dropped since the gate was created.
+     */
+    uint32_t getDroppedCount();
+
+    /**
+     * Sets the rise above the noise floor, in dB, that opens the gate.
+     */
+    void setThreshold(int dB);
+
+    /**
+     * Sets the level, in dB, below which the gate never opens.
+     */
+    void setMinimumLevel(int dB);
+
+    /**
+     * Sets the time the gate stays open after the activity ends.
+     * @param ms the hangover time, in milliseconds.
+     */
+    void setHangover(int ms);
+};
+
+#endif
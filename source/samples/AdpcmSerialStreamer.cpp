@@ -0,0 +1,135 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AdpcmSerialStreamer.h"
+#include "Tests.h"
+
+/**
+ * Converts a raw sample into a 16 bit signed value.
+ */
+static inline int adpcm_sample(int8_t s) { return s << 8; }
+static inline int adpcm_sample(uint8_t s) { return ((int)s - 128) << 8; }
+static inline int adpcm_sample(int16_t s) { return s; }
+static inline int adpcm_sample(uint16_t s) { return (int)s - 32768; }
+
+/**
+ * Creates an AdpcmSerialStreamer attached to the given source.
+ *
+ * @param source a DataSource to stream.
+ */
+AdpcmSerialStreamer::AdpcmSerialStreamer(DataSource &source) : upstream(source)
+{
+    this->sequence = 0;
+    this->dropped = 0;
+
+    static_assert(2 * sizeof(block) <= ADPCM_STREAM_TX_BUFFER_SIZE - 1, "two ADPCM blocks must fit in the serial transmit buffer");
+
+    // Ensure two whole blocks can be queued in one go, so the audio pipeline never waits on the UART.
+    if (uBit.serial.getTxBufferSize() < ADPCM_STREAM_TX_BUFFER_SIZE)
+        uBit.serial.setTxBufferSize(ADPCM_STREAM_TX_BUFFER_SIZE);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+AdpcmSerialStreamer::pullRequest()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return streamBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return streamBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return streamBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return streamBuffer<uint16_t>(buf);
+    }
+
+    return DEVICE_NOT_SUPPORTED;
+}
+
+/**
+ * Encodes and sends the given buffer, interpreted as type T, as one or more blocks.
+ */
+template <typename T> int
+AdpcmSerialStreamer::streamBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    int len = buf.length() / sizeof(T);
+    int sampleRate = (int) upstream.getSampleRate();
+    AdpcmStreamHeader *header = (AdpcmStreamHeader *)block;
+
+    while (len > 0)
+    {
+        int n = len > ADPCM_STREAM_BLOCK_SAMPLES ? ADPCM_STREAM_BLOCK_SAMPLES : len;
+        uint8_t *out = block + ADPCM_STREAM_HEADER_SIZE;
+
+        header->sync = ADPCM_STREAM_SYNC;
+        header->predictor = encoder.predictor;
+        header->index = encoder.index;
+        header->sequence = sequence++;
+        header->samples = n;
+        header->sampleRate = sampleRate;
+
+        for (int i = 0; i < n; i += 2)
+        {
+            uint8_t lo = encoder.encode(adpcm_sample(*p++));
+            uint8_t hi = i + 1 < n ? encoder.encode(adpcm_sample(*p++)) : 0;
+
+            *out++ = lo | (hi << 4);
+        }
+
+        int size = out - block;
+
+        // If the UART has fallen behind, drop the block rather than stall. The next header resyncs the decoder.
+        // The transmit ring keeps one slot empty, so it holds one byte less than its size.
+        if (uBit.serial.getTxBufferSize() - 1 - uBit.serial.txBufferedSize() < size)
+            dropped++;
+        else
+            uBit.serial.send(block, size, ASYNC);
+
+        len -= n;
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Determines the number of blocks dropped because the serial transmit buffer was full.
+ */
+uint32_t
+AdpcmSerialStreamer::getDroppedBlocks()
+{
+    return dropped;
+}
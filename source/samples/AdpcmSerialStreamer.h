@@ -0,0 +1,97 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+#include "ImaAdpcm.h"
+
+#ifndef ADPCM_SERIAL_STREAMER_H
+#define ADPCM_SERIAL_STREAMER_H
+
+// Maximum number of samples coded in each block. Every block starts with a resync header,
+// so a decoder can join the stream (or recover from a dropped block) at any block boundary.
+// Two whole blocks fit in the largest serial transmit buffer, so an upstream buffer of up to
+// 2 * ADPCM_STREAM_BLOCK_SAMPLES samples is queued in full when the UART has caught up.
+#define ADPCM_STREAM_BLOCK_SAMPLES 232
+
+#define ADPCM_STREAM_SYNC 0x4441
+#define ADPCM_STREAM_HEADER_SIZE 10
+
+// The serial transmit buffer requested, the largest the UART driver supports. Its ring holds one byte less.
+#define ADPCM_STREAM_TX_BUFFER_SIZE 255
+
+/**
+ * Resync header sent at the start of every block. All fields are little endian.
+ * The header is followed by (samples+1)/2 bytes of 4 bit codes, low nibble first.
+ */
+struct AdpcmStreamHeader
+{
+    uint16_t        sync;               // ADPCM_STREAM_SYNC ("AD" on the wire)
+    int16_t         predictor;          // Encoder state before the first sample of the block.
+    uint8_t         index;
+    uint8_t         sequence;           // Block sequence number, used to detect dropped blocks.
+    uint16_t        samples;            // Number of samples in this block.
+    uint16_t        sampleRate;         // Upstream sample rate, in Hz.
+} __attribute__((packed));
+
+/**
+ * A DataSink that streams its upstream over serial as 4 bit IMA-ADPCM, a quarter of the bandwidth
+ * of 16 bit binary streaming (or half that of 8 bit). See utils/audio/adpcm_decode.py for the matching decoder.
+ */
+class AdpcmSerialStreamer : public DataSink
+{
+    DataSource      &upstream;
+    ImaAdpcm        encoder;
+    uint8_t         sequence;
+    uint32_t        dropped;
+    uint8_t         block[ADPCM_STREAM_HEADER_SIZE + ADPCM_STREAM_BLOCK_SAMPLES / 2];
+
+    /**
+     * Encodes and sends the given buffer, interpreted as type T, as one or more blocks.
+     */
+    template <typename T> int streamBuffer(ManagedBuffer &buf);
+
+    public:
+    /**
+     * Creates an AdpcmSerialStreamer attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source a DataSource to stream.
+     */
+    AdpcmSerialStreamer(DataSource &source);
+
+    /**
+     * Callback provided when data is ready.
+     * @return DEVICE_OK, or DEVICE_NOT_SUPPORTED if the upstream format cannot be encoded.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Determines the number of blocks dropped because the serial transmit buffer was full.
+     */
+    uint32_t getDroppedBlocks();
+};
+
+#endif
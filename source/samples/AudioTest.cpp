@@ -1,5 +1,6 @@
 #include "MicroBit.h"
 #include "Tests.h"
+#include "SoundExpressionCompiler.h"
 
 enum Note {
     C = 262,
@@ -127,4 +128,51 @@ void audio_sound_expression_test()
             uBit.audio.soundExpressions.play(names[i]);
         }
     }
-}
\ No newline at end of file
+}
+
+// "sad" with the additional zero-duration frame, and the zero-duration frame alone, as in audio_sound_expression_test.
+#define SAD_EXPRESSION "010232279000001440226608881023012800000000240000000000000000000000000000,000000440000000440044008880000012800000000240000000000000000000000000000,310232226070801440162408881023012800000100240000000000000000000000000000,310231623093602440093908880000012800000100240000000000000000000000000000"
+
+static constexpr SoundExpressionFrame sadFrames[] = {
+    sound_expression_compile(SAD_EXPRESSION, 0),
+    sound_expression_compile(SAD_EXPRESSION, 1),
+    sound_expression_compile(SAD_EXPRESSION, 2),
+    sound_expression_compile(SAD_EXPRESSION, 3)
+};
+
+#define ZERO_EXPRESSION "000000440000000440044008880000012800000000240000000000000000000000000000"
+
+static constexpr SoundExpressionFrame zeroFrames[] = {
+    sound_expression_compile(ZERO_EXPRESSION)
+};
+
+static const SoundExpressionEntry compiledExpressions[] = {
+    { "sad", sadFrames, 4 },
+    { "zero", zeroFrames, 1 }
+};
+
+// Both paths are timed through playAsync(), which returns without waiting for the sound to finish, so the
+// difference is the cost of parsing the string.
+void audio_compiled_expression_test()
+{
+    SoundExpressionPlayer player(uBit.audio.synth, compiledExpressions, 2);
+    int handles[2];
+    uint32_t start;
+
+    for (int i = 0; i < 2; ++i)
+        handles[i] = player.add(compiledExpressions[i].frames, compiledExpressions[i].count);
+
+    while (1) {
+        for (int i = 0; i < 2; ++i) {
+            start = system_timer_current_time_us();
+            player.playAsync(handles[i]);
+            DMESG("compiled %s: %d us to start", compiledExpressions[i].name, (int)(system_timer_current_time_us() - start));
+            uBit.sleep(1500);
+
+            start = system_timer_current_time_us();
+            uBit.audio.soundExpressions.playAsync(i == 0 ? SAD_EXPRESSION : ZERO_EXPRESSION);
+            DMESG("parsed %s: %d us to start", compiledExpressions[i].name, (int)(system_timer_current_time_us() - start));
+            uBit.sleep(1500);
+        }
+    }
+}
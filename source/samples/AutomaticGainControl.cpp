@@ -0,0 +1,412 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "AutomaticGainControl.h"
+#include "RmsLevelDetector.h"
+#include "BufferPool.h"
+#include "nrf.h"
+
+// The gain of each SAADC gain setting, from 1/6 to 4, in Q16.
+static const int32_t agc_hardware_gain[AGC_HARDWARE_MAX_GAIN + 1] = {
+    10923, 13107, 16384, 21845, 32768, 65536, 131072, 262144
+};
+
+/**
+ * Converts a raw sample into a signed value in 16 bit units, centred on zero.
+ */
+static inline int agc_sample(int8_t s) { return (int)s << 8; }
+static inline int agc_sample(uint8_t s) { return ((int)s - 128) << 8; }
+static inline int agc_sample(int16_t s) { return s; }
+static inline int agc_sample(uint16_t s) { return (int)s - 32768; }
+
+/**
+ * Stores a value in 16 bit units as a raw sample, saturated to the range of the type.
+ */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+static inline void agc_store(int8_t *p, int v) { *p = (int8_t)__SSAT(v >> 8, 8); }
+static inline void agc_store(uint8_t *p, int v) { *p = (uint8_t)(__SSAT(v >> 8, 8) + 128); }
+static inline void agc_store(int16_t *p, int v) { *p = (int16_t)__SSAT(v, 16); }
+static inline void agc_store(uint16_t *p, int v) { *p = (uint16_t)(__SSAT(v, 16) + 32768); }
+#else
+static inline int agc_saturate(int v, int lo, int hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+static inline void agc_store(int8_t *p, int v) { *p = (int8_t)agc_saturate(v >> 8, -128, 127); }
+static inline void agc_store(uint8_t *p, int v) { *p = (uint8_t)(agc_saturate(v >> 8, -128, 127) + 128); }
+static inline void agc_store(int16_t *p, int v) { *p = (int16_t)agc_saturate(v, -32768, 32767); }
+static inline void agc_store(uint16_t *p, int v) { *p = (uint16_t)(agc_saturate(v, -32768, 32767) + 32768); }
+#endif
+
+/**
+ * Computes the per sample coefficient, in Q16, of a one pole smoother with the given time constant.
+ */
+static int32_t agc_coefficient(int ms, float sampleRate)
+{
+    int32_t c = (int32_t)(65536.0f * (1.0f - expf(-1000.0f / (ms * sampleRate))) + 0.5f);
+
+    // Very long time constants would otherwise round to a smoother that never moves.
+    return max(c, (int32_t)1);
+}
+
+/**
+ * Creates an AutomaticGainControl attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to process.
+ * @param adc the ADC channel feeding the source, whose gain is adjusted first, or NULL to use digital gain only.
+ * @param gain the initial SAADC gain setting, from AGC_HARDWARE_MIN_GAIN to AGC_HARDWARE_MAX_GAIN.
+ * @param bias the bias given to NRF52ADCChannel::setGain() with every gain.
+ * @param adcFullScale the full scale of the samples produced by the ADC, in 16 bit sample units.
+ */
+AutomaticGainControl::AutomaticGainControl(DataSource &source, NRF52ADCChannel *adc, int gain, int bias, int adcFullScale) : upstream(source)
+{
+    this->downstream = NULL;
+    this->adc = adc;
+    this->hardwareGain = min(max(gain, AGC_HARDWARE_MIN_GAIN), AGC_HARDWARE_MAX_GAIN);
+    this->bias = bias;
+    this->adcFullScale = max(adcFullScale, 1);
+    this->gain = 65536;
+    this->envelope = 0;
+    this->offset = 0;
+    this->offsetValid = false;
+    this->attackMs = AGC_DEFAULT_ATTACK_MS;
+    this->releaseMs = AGC_DEFAULT_RELEASE_MS;
+    this->rate = 0;
+    this->attack = 65536;               // Until the sample rate is known, the envelope follows the input.
+    this->release = 65536;
+    this->pendingScale = 0;
+    this->pendingBuffers = 0;
+    this->holdSamples = 0;
+
+    setTarget(AGC_DEFAULT_TARGET_DB);
+    setMaxGain(AGC_DEFAULT_MAX_GAIN_DB);
+
+    if (adc)
+        adc->setGain(hardwareGain, bias);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller, with the gain applied.
+ */
+ManagedBuffer
+AutomaticGainControl::pull()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return processBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return processBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return processBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return processBuffer<uint16_t>(buf);
+    }
+
+    return buf;
+}
+
+/**
+ * Processes the given buffer, interpreted as type T, into a new buffer of the same format.
+ * The input is never written, as other channels may share it.
+ */
+template <typename T> ManagedBuffer
+AutomaticGainControl::processBuffer(ManagedBuffer &buf)
+{
+    int n = buf.length() / sizeof(T);
+
+    if (n == 0)
+        return buf;
+
+    update();
+
+    // Once the ADC applies a step in hardware gain, rescale everything measured before it, so the output does not jump.
+    if (pendingScale)
+    {
+        if (pendingBuffers > 0)
+        {
+            pendingBuffers--;
+        }
+        else
+        {
+            envelope = (int32_t)(((int64_t)envelope * pendingScale) >> 16);
+            gain = (int32_t)(((int64_t)gain << 16) / pendingScale);
+            offsetValid = false;
+            pendingScale = 0;
+        }
+    }
+
+    T *in = (T *)&buf[0];
+    T *end = in + n;
+    T *p;
+    int64_t sum = 0;
+    int32_t env = envelope;
+    int32_t a, d;
+
+    if (!offsetValid)
+    {
+        for (p = in; p < end; p++)
+            sum += agc_sample(*p);
+
+        offset = (int32_t)((sum << 8) / n);
+        offsetValid = true;
+        sum = 0;
+    }
+
+    const int32_t off = offset;
+
+    // Track the peak envelope over the whole buffer, before deciding the gain.
+    for (p = in; p < end; p++)
+    {
+        a = agc_sample(*p);
+        sum += a;
+
+        a = abs((a << 8) - off);
+        d = a - env;
+        env += (int32_t)(((int64_t)d * (d > 0 ? attack : release)) >> 16);
+    }
+
+    envelope = env;
+
+    // The DC offset is smoothed over four buffers.
+    offset += ((int32_t)((sum << 8) / n) - offset) >> 2;
+
+    int32_t desired = env > 0 ? (int32_t)min(((int64_t)target << 24) / env, (int64_t)maxGain) : maxGain;
+    desired = max(desired, (int32_t)AGC_MIN_GAIN);
+
+    // A rise in gain is ramped across the buffer, to avoid a step. A fall applies from the start of the buffer,
+    // as it holds the sound that caused it, and the onset would otherwise clip.
+    ManagedBuffer out = buffer_pool_allocate(buf.length());
+    T *dst = (T *)&out[0];
+    int32_t g = min(gain, desired);
+    int32_t step = (desired - g) / n;
+
+    for (p = in; p < end; p++)
+    {
+        g += step;
+        agc_store(dst++, (int32_t)(((int64_t)((agc_sample(*p) << 8) - off) * g) >> 24));
+    }
+
+    gain = desired;
+
+    holdSamples = max(holdSamples - n, 0);
+    adjustHardware();
+
+    return out;
+}
+
+/**
+ * Recomputes the envelope coefficients if the sample rate has changed.
+ */
+void
+AutomaticGainControl::update()
+{
+    float r = upstream.getSampleRate();
+
+    if (r == rate || r <= 0)
+        return;
+
+    rate = r;
+    attack = agc_coefficient(attackMs, rate);
+    release = agc_coefficient(releaseMs, rate);
+}
+
+/**
+ * Adjusts the hardware gain, if the peak envelope of the input is outside the ADC's preferred range.
+ */
+void
+AutomaticGainControl::adjustHardware()
+{
+    if (adc == NULL || holdSamples > 0 || pendingScale)
+        return;
+
+    int next = hardwareGain;
+
+    // The peak of the raw input, as a fraction of the ADC's full scale, in Q16.
+    int64_t level = ((int64_t)envelope << 8) / adcFullScale;
+
+    // Lower the hardware gain as the peak nears full scale, so the ADC keeps its headroom.
+    if (level > AGC_HARDWARE_LOWER_LEVEL && hardwareGain > AGC_HARDWARE_MIN_GAIN)
+        next = hardwareGain - 1;
+
+    // Raise it if the peak would still be well below full scale afterwards, so quiet signals keep the ADC's resolution.
+    if (hardwareGain < AGC_HARDWARE_MAX_GAIN && level * agc_hardware_gain[hardwareGain + 1] / agc_hardware_gain[hardwareGain] < AGC_HARDWARE_RAISE_LEVEL)
+        next = hardwareGain + 1;
+
+    if (next == hardwareGain)
+        return;
+
+    pendingScale = (int32_t)(((int64_t)agc_hardware_gain[next] << 16) / agc_hardware_gain[hardwareGain]);
+    pendingBuffers = AGC_HARDWARE_LATENCY;
+    holdSamples = (int)(rate * AGC_HARDWARE_HOLD_MS / 1000);
+    hardwareGain = next;
+
+    adc->setGain(hardwareGain, bias);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+AutomaticGainControl::pullRequest()
+{
+    if (downstream)
+        return downstream->pullRequest();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+AutomaticGainControl::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+AutomaticGainControl::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+AutomaticGainControl::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+AutomaticGainControl::getFormat()
+{
+    return upstream.getFormat();
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+AutomaticGainControl::getSampleRate()
+{
+    return upstream.getSampleRate();
+}
+
+/**
+ * Requests a new sample rate from our upstream. The time constants follow any change.
+ */
+float
+AutomaticGainControl::requestSampleRate(float sampleRate)
+{
+    return upstream.requestSampleRate(sampleRate);
+}
+
+/**
+ * Sets the peak level the output is held at.
+ * @param dB the level relative to full scale, from -48 to 0.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the level is out of range.
+ */
+int
+AutomaticGainControl::setTarget(float dB)
+{
+    if (dB < -48.0f || dB > 0.0f)
+        return DEVICE_INVALID_PARAMETER;
+
+    target = (int32_t)(32767.0f * powf(10.0f, dB / 20.0f));
+
+    return DEVICE_OK;
+}
+
+/**
+ * Sets the largest digital gain applied, which limits how far background noise is raised in silence.
+ * @param dB the gain, from 0 to 48.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the gain is out of range.
+ */
+int
+AutomaticGainControl::setMaxGain(float dB)
+{
+    if (dB < 0.0f || dB > 48.0f)
+        return DEVICE_INVALID_PARAMETER;
+
+    maxGain = (int32_t)(65536.0f * powf(10.0f, dB / 20.0f));
+
+    return DEVICE_OK;
+}
+
+/**
+ * Sets the time taken for the gain to respond to a rise in level.
+ * @param ms the attack time constant, in milliseconds.
+ */
+void
+AutomaticGainControl::setAttack(int ms)
+{
+    attackMs = max(1, ms);
+    rate = 0;
+}
+
+/**
+ * Sets the time taken for the gain to recover after a fall in level.
+ * @param ms the release time constant, in milliseconds.
+ */
+void
+AutomaticGainControl::setRelease(int ms)
+{
+    releaseMs = max(1, ms);
+    rate = 0;
+}
+
+/**
+ * Determines the digital gain currently applied, in hundredths of a dB.
+ */
+int
+AutomaticGainControl::getGain()
+{
+    return rms_level_millibels((uint64_t)gain * gain) - rms_level_millibels((uint64_t)1 << 32);
+}
+
+/**
+ * Determines the current SAADC gain setting, from AGC_HARDWARE_MIN_GAIN to AGC_HARDWARE_MAX_GAIN.
+ */
+int
+AutomaticGainControl::getHardwareGain()
+{
+    return hardwareGain;
+}
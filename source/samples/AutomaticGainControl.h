@@ -0,0 +1,213 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef AUTOMATIC_GAIN_CONTROL_H
+#define AUTOMATIC_GAIN_CONTROL_H
+
+// SAADC gain settings, as given to NRF52ADCChannel::setGain(). 0 is a gain of 1/6, 7 a gain of 4.
+#define AGC_HARDWARE_MIN_GAIN       0
+#define AGC_HARDWARE_MAX_GAIN       7
+
+// Number of buffers already in flight when the hardware gain changes, which still carry the old gain.
+#define AGC_HARDWARE_LATENCY        1
+
+// Shortest time between changes of the hardware gain, so it does not hunt between two settings.
+#define AGC_HARDWARE_HOLD_MS        250
+
+// Peak input level, as a fraction of the ADC's full scale in Q16, above which the hardware gain is lowered
+// (-6dB), and below which the level must still be after a step up for the gain to be raised (-12dB). The gap
+// between the two is a hysteresis band, so a level near a step boundary does not toggle the gain.
+#define AGC_HARDWARE_LOWER_LEVEL    32768
+#define AGC_HARDWARE_RAISE_LEVEL    16384
+
+// Full scale of the samples produced by the SAADC for the microphone, in 16 bit sample units. Its
+// samples span about +/-2.5k, not the full 16 bit range.
+#define AGC_DEFAULT_ADC_FULL_SCALE  2560
+
+#define AGC_DEFAULT_TARGET_DB       -6.0f
+#define AGC_DEFAULT_MAX_GAIN_DB     24.0f
+#define AGC_DEFAULT_ATTACK_MS       5
+#define AGC_DEFAULT_RELEASE_MS      500
+
+// Smallest digital gain, in Q16 (-24dB), used once the hardware gain is at its minimum.
+#define AGC_MIN_GAIN                4096
+
+/**
+ * An automatic gain control stage, that holds the peak level of its output close to a target.
+ *
+ * The peak envelope of the input is tracked per sample, rising with the attack time and falling with the
+ * release time, and the gain for each buffer is the target divided by the envelope. The envelope is
+ * measured over the whole buffer before any gain is applied, so a sudden loud sound lowers the gain for
+ * the buffer that holds it, rather than the one after. Rises in gain are ramped across the buffer, to avoid
+ * steps. All of this is in integer arithmetic: floating point is only used when a time constant or the
+ * target is set.
+ *
+ * If given the ADC channel feeding the stream, the hardware gain is used first. The peak envelope of the
+ * input is compared with the ADC's own full scale: the SAADC gain is lowered when the peak rises above
+ * AGC_HARDWARE_LOWER_LEVEL, and raised when the peak would still be below AGC_HARDWARE_RAISE_LEVEL after
+ * the step, so the ADC keeps its headroom and quiet signals keep its resolution. Digital gain only makes
+ * up the difference, and the step in hardware gain is compensated digitally once the ADC applies it, so
+ * the output level does not jump. Without an ADC channel, the gain is digital only.
+ *
+ * Any DC offset is tracked and removed. The output has the format and sample rate of the input, and is
+ * saturated rather than wrapping.
+ */
+class AutomaticGainControl : public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    NRF52ADCChannel *adc;
+    int             hardwareGain;       // The current SAADC gain setting.
+    int             bias;
+    int32_t         adcFullScale;       // Full scale of the ADC's samples, in 16 bit sample units.
+    int32_t         gain;               // Digital gain in Q16, as applied at the end of the last buffer.
+    int32_t         maxGain;            // In Q16.
+    int32_t         target;             // Target peak level, in 16 bit sample units.
+    int32_t         envelope;           // Peak envelope, in 16 bit sample units in Q8.
+    int32_t         offset;             // DC offset, in 16 bit sample units in Q8.
+    bool            offsetValid;
+    int             attackMs;
+    int             releaseMs;
+    int32_t         attack;             // Per sample envelope coefficients, in Q16.
+    int32_t         release;
+    float           rate;               // The sample rate the coefficients were computed for.
+    int32_t         pendingScale;       // Change in level, in Q16, of a hardware gain step not yet applied by the ADC.
+    int             pendingBuffers;     // Buffers until the ADC applies that step.
+    int             holdSamples;        // Samples until the hardware gain may change again.
+
+    /**
+     * Processes the given buffer, interpreted as type T, into a new buffer of the same format.
+     */
+    template <typename T> ManagedBuffer processBuffer(ManagedBuffer &buf);
+
+    /**
+     * Recomputes the envelope coefficients if the sample rate has changed.
+     */
+    void update();
+
+    /**
+     * Adjusts the hardware gain, if the peak envelope of the input is outside the ADC's preferred range.
+     */
+    void adjustHardware();
+
+    public:
+    /**
+     * Creates an AutomaticGainControl attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to process.
+     * @param adc the ADC channel feeding the source, whose gain is adjusted first, or NULL to use digital gain only.
+     * @param gain the initial SAADC gain setting, from AGC_HARDWARE_MIN_GAIN to AGC_HARDWARE_MAX_GAIN.
+     * @param bias the bias given to NRF52ADCChannel::setGain() with every gain.
+     * @param adcFullScale the full scale of the samples produced by the ADC, in 16 bit sample units.
+     */
+    AutomaticGainControl(DataSource &source, NRF52ADCChannel *adc = NULL, int gain = AGC_HARDWARE_MAX_GAIN, int bias = 0, int adcFullScale = AGC_DEFAULT_ADC_FULL_SCALE);
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller, with the gain applied.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     *
+     * @sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     *
+     * @return true If a downstream is connected
+     * @return false If a downstream is not connected
+     */
+    virtual bool isConnected();
+
+    /**
+     *  Disconnect this source from a downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Requests a new sample rate from our upstream.
+     */
+    virtual float requestSampleRate(float sampleRate);
+
+    /**
+     * Sets the peak level the output is held at.
+     * @param dB the level relative to full scale, from -48 to 0.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the level is out of range.
+     */
+    int setTarget(float dB);
+
+    /**
+     * Sets the largest digital gain applied, which limits how far background noise is raised in silence.
+     * @param dB the gain, from 0 to 48.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the gain is out of range.
+     */
+    int setMaxGain(float dB);
+
+    /**
+     * Sets the time taken for the gain to respond to a rise in level.
+     * @param ms the attack time constant, in milliseconds.
+     */
+    void setAttack(int ms);
+
+    /**
+     * Sets the time taken for the gain to recover after a fall in level.
+     * @param ms the release time constant, in milliseconds.
+     */
+    void setRelease(int ms);
+
+    /**
+     * Determines the digital gain currently applied, in hundredths of a dB.
+     */
+    int getGain();
+
+    /**
+     * Determines the current SAADC gain setting, from AGC_HARDWARE_MIN_GAIN to AGC_HARDWARE_MAX_GAIN.
+     */
+    int getHardwareGain();
+};
+
+#endif
@@ -0,0 +1,551 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BiquadFilter.h"
+#include "BufferPool.h"
+#include "nrf.h"
+
+// Samples are filtered in blocks of this many, held on the stack, so no working buffer is allocated.
+#define BIQUAD_BLOCK_SIZE       32
+
+// The largest magnitude carried between stages, leaving headroom in the 64 bit state for any gain.
+#define BIQUAD_SAMPLE_LIMIT     (1 << 30)
+
+/**
+ * Converts a raw sample into a signed 16 bit value, centred on zero, with BIQUAD_GUARD_BITS of fraction.
+ */
+static inline int32_t biquad_sample(int8_t s) { return (int32_t)s << (8 + BIQUAD_GUARD_BITS); }
+static inline int32_t biquad_sample(uint8_t s) { return ((int32_t)s - 128) << (8 + BIQUAD_GUARD_BITS); }
+static inline int32_t biquad_sample(int16_t s) { return (int32_t)s << BIQUAD_GUARD_BITS; }
+static inline int32_t biquad_sample(uint16_t s) { return ((int32_t)s - 32768) << BIQUAD_GUARD_BITS; }
+
+/**
+ * Stores a filtered value as a raw sample, rounded and saturated to the range of the type.
+ */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+static inline void biquad_store(int8_t *p, int32_t v) { *p = (int8_t)__SSAT((v + (1 << (7 + BIQUAD_GUARD_BITS))) >> (8 + BIQUAD_GUARD_BITS), 8); }
+static inline void biquad_store(uint8_t *p, int32_t v) { *p = (uint8_t)(__SSAT((v + (1 << (7 + BIQUAD_GUARD_BITS))) >> (8 + BIQUAD_GUARD_BITS), 8) + 128); }
+static inline void biquad_store(int16_t *p, int32_t v) { *p = (int16_t)__SSAT((v + (1 << (BIQUAD_GUARD_BITS - 1))) >> BIQUAD_GUARD_BITS, 16); }
+static inline void biquad_store(uint16_t *p, int32_t v) { *p = (uint16_t)(__SSAT((v + (1 << (BIQUAD_GUARD_BITS - 1))) >> BIQUAD_GUARD_BITS, 16) + 32768); }
+#else
+static inline int biquad_saturate(int v, int lo, int hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+static inline void biquad_store(int8_t *p, int32_t v) { *p = (int8_t)biquad_saturate((v + (1 << (7 + BIQUAD_GUARD_BITS))) >> (8 + BIQUAD_GUARD_BITS), -128, 127); }
+static inline void biquad_store(uint8_t *p, int32_t v) { *p = (uint8_t)(biquad_saturate((v + (1 << (7 + BIQUAD_GUARD_BITS))) >> (8 + BIQUAD_GUARD_BITS), -128, 127) + 128); }
+static inline void biquad_store(int16_t *p, int32_t v) { *p = (int16_t)biquad_saturate((v + (1 << (BIQUAD_GUARD_BITS - 1))) >> BIQUAD_GUARD_BITS, -32768, 32767); }
+static inline void biquad_store(uint16_t *p, int32_t v) { *p = (uint16_t)(biquad_saturate((v + (1 << (BIQUAD_GUARD_BITS - 1))) >> BIQUAD_GUARD_BITS, -32768, 32767) + 32768); }
+#endif
+
+/**
+ * Converts a coefficient to Q(BIQUAD_COEFFICIENT_BITS).
+ * @return false if the coefficient is outside the representable range.
+ */
+static bool biquad_coefficient(float v, int32_t &out)
+{
+    float q = v * (float)(1 << BIQUAD_COEFFICIENT_BITS);
+
+    if (q >= 2147483520.0f || q <= -2147483520.0f)
+        return false;
+
+    out = (int32_t)(q < 0 ? q - 0.5f : q + 0.5f);
+    return true;
+}
+
+/**
+ * Sets a stage to pass its input unchanged.
+ */
+static void biquad_identity(BiquadStage &stage)
+{
+    stage.type = 0;
+    stage.bypass = false;
+    stage.b0 = 1 << BIQUAD_COEFFICIENT_BITS;
+    stage.b1 = stage.b2 = stage.a1 = stage.a2 = 0;
+}
+
+/**
+ * Filters n values in place through one stage, in direct form II transposed:
+ *
+ *   y = b0.x + s1,  s1' = b1.x - a1.y + s2,  s2' = b2.x - a2.y
+ *
+ * Each product is a single 32x32->64 bit multiply accumulate into the 64 bit state.
+ */
+static void biquad_run(const BiquadStage &stage, int64_t *state, int32_t *x, int n)
+{
+    const int32_t b0 = stage.b0, b1 = stage.b1, b2 = stage.b2;
+    const int32_t na1 = -stage.a1, na2 = -stage.a2;
+    int64_t s1 = state[0];
+    int64_t s2 = state[1];
+    int64_t acc;
+    int32_t in, y;
+
+    for (int i = 0; i < n; i++)
+    {
+        in = x[i];
+        acc = s1 + (int64_t)b0 * in;
+        acc >>= BIQUAD_COEFFICIENT_BITS;
+
+        // Only an unstable or extreme design can get here, but wrapping would be far worse than clipping.
+        y = acc > BIQUAD_SAMPLE_LIMIT ? BIQUAD_SAMPLE_LIMIT : acc < -BIQUAD_SAMPLE_LIMIT ? -BIQUAD_SAMPLE_LIMIT : (int32_t)acc;
+
+        s1 = s2 + (int64_t)b1 * in + (int64_t)na1 * y;
+        s2 = (int64_t)b2 * in + (int64_t)na2 * y;
+        x[i] = y;
+    }
+
+    state[0] = s1;
+    state[1] = s2;
+}
+
+/**
+ * Creates a BiquadFilter attached to the given source, with no stages, so it initially passes its input unchanged.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to filter.
+ */
+BiquadFilter::BiquadFilter(DataSource &source) : CodalComponent(DEVICE_ID_BIQUAD_FILTER, 0), upstream(source)
+{
+    this->downstream = NULL;
+    this->stageCount = 0;
+    this->pendingCount = 0;
+    this->updated = false;
+    this->clearState = false;
+
+    for (int i = 0; i < BIQUAD_FILTER_MAX_STAGES; i++)
+    {
+        biquad_identity(stages[i]);
+        biquad_identity(pending[i]);
+    }
+
+    memset(state, 0, sizeof(state));
+
+    // Follow changes of the upstream rate when idle.
+    status |= DEVICE_COMPONENT_STATUS_IDLE_TICK;
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Destructor.
+ */
+BiquadFilter::~BiquadFilter()
+{
+    status &= ~DEVICE_COMPONENT_STATUS_IDLE_TICK;
+}
+
+/**
+ * Redesigns the stages when the upstream sample rate has changed. Called by the scheduler when idle.
+ */
+void
+BiquadFilter::idleCallback()
+{
+    float rate = upstream.getSampleRate();
+    BiquadStage redesigned[BIQUAD_FILTER_MAX_STAGES];
+    bool changed = false;
+
+    // Unknown until the upstream is running: carry on with the coefficients in use.
+    if (rate <= 0)
+        return;
+
+    memcpy(redesigned, pending, sizeof(redesigned));
+
+    for (int s = 0; s < BIQUAD_FILTER_MAX_STAGES; s++)
+    {
+        BiquadStage &stage = redesigned[s];
+
+        if (stage.type == 0 || stage.rate == rate)
+            continue;
+
+        // A design that cannot be realised at the new rate is bypassed, rather than left tuned for the old one.
+        stage.bypass = !design(stage, rate);
+        stage.rate = rate;
+        changed = true;
+    }
+
+    if (!changed)
+        return;
+
+    // pull() may run from an interrupt at any point, so the pending set is marked stale while it changes.
+    updated = false;
+    memcpy(pending, redesigned, sizeof(pending));
+    updated = true;
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller, filtered.
+ */
+ManagedBuffer
+BiquadFilter::pull()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    update();
+
+    if (stageCount == 0)
+        return buf;
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return filterBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return filterBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return filterBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return filterBuffer<uint16_t>(buf);
+    }
+
+    return buf;
+}
+
+/**
+ * Filters the given buffer, interpreted as type T, into a new buffer of the same format.
+ * The input is never written, as other channels may share it.
+ */
+template <typename T> ManagedBuffer
+BiquadFilter::filterBuffer(ManagedBuffer &buf)
+{
+    int n = buf.length() / sizeof(T);
+    ManagedBuffer out = buffer_pool_allocate(buf.length());
+    T *in = (T *)&buf[0];
+    T *dst = (T *)&out[0];
+    int32_t block[BIQUAD_BLOCK_SIZE];
+    int len;
+
+    // Each stage runs over a whole block at a time, so its coefficients and state stay in registers.
+    for (int i = 0; i < n; i += len)
+    {
+        len = min(BIQUAD_BLOCK_SIZE, n - i);
+
+        for (int k = 0; k < len; k++)
+            block[k] = biquad_sample(in[k]);
+
+        for (int s = 0; s < stageCount; s++)
+            if (!stages[s].bypass)
+                biquad_run(stages[s], state[s], block, len);
+
+        for (int k = 0; k < len; k++)
+            biquad_store(&dst[k], block[k]);
+
+        in += len;
+        dst += len;
+    }
+
+    return out;
+}
+
+/**
+ * Brings the stages in use up to date with any new configuration, between buffers.
+ */
+void
+BiquadFilter::update()
+{
+    if (updated)
+    {
+        updated = false;
+
+        // A stage coming out of bypass starts from silence, not from the state of an older design.
+        for (int s = 0; s < BIQUAD_FILTER_MAX_STAGES; s++)
+            if (stages[s].bypass && !pending[s].bypass)
+                state[s][0] = state[s][1] = 0;
+
+        memcpy(stages, pending, sizeof(stages));
+        stageCount = pendingCount;
+    }
+
+    if (clearState)
+    {
+        clearState = false;
+        memset(state, 0, sizeof(state));
+    }
+}
+
+/**
+ * Computes the coefficients of the given stage from its design, at the given sample rate.
+ * @return true on success, or false if the design cannot be realised at that rate.
+ */
+bool
+BiquadFilter::design(BiquadStage &stage, float sampleRate)
+{
+    if (stage.frequency <= 0 || stage.frequency >= sampleRate / 2 || stage.q <= 0)
+        return false;
+
+    float w0 = 2.0f * (float)M_PI * stage.frequency / sampleRate;
+    float c = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * stage.q);
+    float a = powf(10.0f, stage.gain / 40.0f);
+    float beta = 2.0f * sqrtf(a) * alpha;
+    float b0, b1, b2, a0, a1, a2;
+
+    switch (stage.type)
+    {
+        case BIQUAD_LOW_PASS:
+            b0 = b2 = (1.0f - c) / 2.0f;
+            b1 = 1.0f - c;
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * c;
+            a2 = 1.0f - alpha;
+            break;
+
+        case BIQUAD_HIGH_PASS:
+            b0 = b2 = (1.0f + c) / 2.0f;
+            b1 = -(1.0f + c);
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * c;
+            a2 = 1.0f - alpha;
+            break;
+
+        case BIQUAD_BAND_PASS:
+            // Constant 0dB gain at the centre frequency.
+            b0 = alpha;
+            b1 = 0.0f;
+            b2 = -alpha;
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * c;
+            a2 = 1.0f - alpha;
+            break;
+
+        case BIQUAD_NOTCH:
+            b0 = b2 = 1.0f;
+            b1 = -2.0f * c;
+            a0 = 1.0f + alpha;
+            a1 = -2.0f * c;
+            a2 = 1.0f - alpha;
+            break;
+
+        case BIQUAD_PEAK:
+            b0 = 1.0f + alpha * a;
+            b1 = -2.0f * c;
+            b2 = 1.0f - alpha * a;
+            a0 = 1.0f + alpha / a;
+            a1 = -2.0f * c;
+            a2 = 1.0f - alpha / a;
+            break;
+
+        case BIQUAD_LOW_SHELF:
+            b0 = a * ((a + 1.0f) - (a - 1.0f) * c + beta);
+            b1 = 2.0f * a * ((a - 1.0f) - (a + 1.0f) * c);
+            b2 = a * ((a + 1.0f) - (a - 1.0f) * c - beta);
+            a0 = (a + 1.0f) + (a - 1.0f) * c + beta;
+            a1 = -2.0f * ((a - 1.0f) + (a + 1.0f) * c);
+            a2 = (a + 1.0f) + (a - 1.0f) * c - beta;
+            break;
+
+        case BIQUAD_HIGH_SHELF:
+            b0 = a * ((a + 1.0f) + (a - 1.0f) * c + beta);
+            b1 = -2.0f * a * ((a - 1.0f) + (a + 1.0f) * c);
+            b2 = a * ((a + 1.0f) + (a - 1.0f) * c - beta);
+            a0 = (a + 1.0f) - (a - 1.0f) * c + beta;
+            a1 = 2.0f * ((a - 1.0f) - (a + 1.0f) * c);
+            a2 = (a + 1.0f) - (a - 1.0f) * c - beta;
+            break;
+
+        default:
+            return false;
+    }
+
+    BiquadStage result = stage;
+
+    if (!biquad_coefficient(b0 / a0, result.b0) || !biquad_coefficient(b1 / a0, result.b1) || !biquad_coefficient(b2 / a0, result.b2) ||
+        !biquad_coefficient(a1 / a0, result.a1) || !biquad_coefficient(a2 / a0, result.a2))
+        return false;
+
+    result.rate = sampleRate;
+    stage = result;
+
+    return true;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+BiquadFilter::pullRequest()
+{
+    if (downstream)
+        return downstream->pullRequest();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+BiquadFilter::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+BiquadFilter::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+BiquadFilter::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+BiquadFilter::getFormat()
+{
+    return upstream.getFormat();
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+BiquadFilter::getSampleRate()
+{
+    return upstream.getSampleRate();
+}
+
+/**
+ * Requests a new sample rate from our upstream. The coefficients follow any change from the next idle callback.
+ */
+float
+BiquadFilter::requestSampleRate(float sampleRate)
+{
+    return upstream.requestSampleRate(sampleRate);
+}
+
+/**
+ * Configures one stage of the cascade, extending the cascade to include it if need be.
+ * Coefficients are computed here, and again by the idle callback only if the upstream sample rate changes.
+ *
+ * @param index the stage, from 0 to BIQUAD_FILTER_MAX_STAGES-1.
+ * @param type one of the BIQUAD_ filter types.
+ * @param frequency the cutoff, centre or shelf frequency, in Hz.
+ * @param q the quality factor. 0.7071 gives a maximally flat low or high pass; larger values are narrower.
+ * @param gain the gain, in dB, of a peak or shelf. Ignored by the other types.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the stage, type or parameters are invalid.
+ */
+int
+BiquadFilter::setStage(int index, int type, float frequency, float q, float gain)
+{
+    if (index < 0 || index >= BIQUAD_FILTER_MAX_STAGES)
+        return DEVICE_INVALID_PARAMETER;
+
+    BiquadStage stage;
+
+    stage.type = type;
+    stage.frequency = frequency;
+    stage.q = q;
+    stage.gain = gain;
+    stage.bypass = false;
+
+    if (!design(stage, upstream.getSampleRate()))
+        return DEVICE_INVALID_PARAMETER;
+
+    // pull() may run from an interrupt at any point, so the pending set is marked stale while it changes.
+    updated = false;
+    pending[index] = stage;
+    pendingCount = max(pendingCount, index + 1);
+    updated = true;
+
+    return DEVICE_OK;
+}
+
+/**
+ * Configures one stage of the cascade from coefficients computed elsewhere, normalised so that a0 is 1.
+ * Such stages do not follow changes of the sample rate.
+ *
+ * @param index the stage, from 0 to BIQUAD_FILTER_MAX_STAGES-1.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the stage is invalid or a coefficient is outside +/-8.
+ */
+int
+BiquadFilter::setStageCoefficients(int index, float b0, float b1, float b2, float a1, float a2)
+{
+    if (index < 0 || index >= BIQUAD_FILTER_MAX_STAGES)
+        return DEVICE_INVALID_PARAMETER;
+
+    BiquadStage stage;
+
+    biquad_identity(stage);
+
+    if (!biquad_coefficient(b0, stage.b0) || !biquad_coefficient(b1, stage.b1) || !biquad_coefficient(b2, stage.b2) ||
+        !biquad_coefficient(a1, stage.a1) || !biquad_coefficient(a2, stage.a2))
+        return DEVICE_INVALID_PARAMETER;
+
+    updated = false;
+    pending[index] = stage;
+    pendingCount = max(pendingCount, index + 1);
+    updated = true;
+
+    return DEVICE_OK;
+}
+
+/**
+ * Sets the number of stages in the cascade. Stages that have not been configured pass their input unchanged.
+ * @param count the number of stages, from 0 (no filtering) to BIQUAD_FILTER_MAX_STAGES.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the count is out of range.
+ */
+int
+BiquadFilter::setStageCount(int count)
+{
+    if (count < 0 || count > BIQUAD_FILTER_MAX_STAGES)
+        return DEVICE_INVALID_PARAMETER;
+
+    updated = false;
+    pendingCount = count;
+    updated = true;
+
+    return DEVICE_OK;
+}
+
+/**
+ * Determines the number of stages in the cascade.
+ */
+int
+BiquadFilter::getStageCount()
+{
+    return pendingCount;
+}
+
+/**
+ * Clears the state of every stage from the next buffer, as if the input had been silent.
+ */
+void
+BiquadFilter::reset()
+{
+    clearState = true;
+}
@@ -0,0 +1,218 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef BIQUAD_FILTER_H
+#define BIQUAD_FILTER_H
+
+#define DEVICE_ID_BIQUAD_FILTER         9018
+
+#define BIQUAD_FILTER_MAX_STAGES        6
+
+#define BIQUAD_LOW_PASS                 1
+#define BIQUAD_HIGH_PASS                2
+#define BIQUAD_BAND_PASS                3
+#define BIQUAD_NOTCH                    4
+#define BIQUAD_PEAK                     5
+#define BIQUAD_LOW_SHELF                6
+#define BIQUAD_HIGH_SHELF               7
+
+// Coefficients are held as Q31 words with a post shift, so they span +/-8 (shelves and peaks can exceed 2).
+#define BIQUAD_COEFFICIENT_SHIFT        3
+#define BIQUAD_COEFFICIENT_BITS         (31 - BIQUAD_COEFFICIENT_SHIFT)
+
+// Fractional bits carried below a 16 bit sample between stages, to keep requantisation noise out of the feedback.
+#define BIQUAD_GUARD_BITS               8
+
+/**
+ * The design and the fixed point coefficients of one second order section.
+ * b0, b1 and b2 are the feed forward coefficients, and a1 and a2 the feedback coefficients, normalised by a0.
+ */
+struct BiquadStage
+{
+    int             type;               // One of the BIQUAD_ types, or 0 if the coefficients were given directly.
+    float           frequency;          // Design parameters, kept so the coefficients can follow the sample rate.
+    float           q;
+    float           gain;
+    float           rate;               // The sample rate the coefficients were last designed for.
+    bool            bypass;             // True if the design cannot be realised at that rate, so the stage passes its input unchanged.
+    int32_t         b0, b1, b2, a1, a2; // In Q(BIQUAD_COEFFICIENT_BITS).
+};
+
+/**
+ * A cascade of up to BIQUAD_FILTER_MAX_STAGES second order IIR sections (biquads), in fixed point.
+ *
+ * Each stage is a low pass, high pass, band pass, notch, peak or shelving filter from the RBJ audio EQ
+ * cookbook, or a set of coefficients given directly. Every sample is processed with integer multiply
+ * accumulates into 64 bit state, in direct form II transposed, which GCC compiles to SMULL/SMLAL on the
+ * Cortex-M4. The state keeps every bit of each product, and samples carry BIQUAD_GUARD_BITS below 16 bits
+ * from stage to stage, so even the poles of a narrow mains hum notch, very close to the unit circle, add
+ * little noise.
+ *
+ * Floating point is only used to compute coefficients, so never on the audio path: when a stage is
+ * configured, and by the idle callback when the upstream sample rate changes. Until then, the previous
+ * coefficients carry on. A design that cannot be realised at the new rate is bypassed, but keeps its
+ * parameters, so it is redesigned when the rate next changes.
+ *
+ * Stages can be changed while streaming without any allocation: new coefficients are staged, and copied
+ * in at the start of the next buffer, so a buffer is never filtered with a mix of old and new ones.
+ *
+ * The output has the format and sample rate of the input. Results are saturated rather than wrapping.
+ */
+class BiquadFilter : public CodalComponent, public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    BiquadStage     stages[BIQUAD_FILTER_MAX_STAGES];       // The coefficients in use.
+    BiquadStage     pending[BIQUAD_FILTER_MAX_STAGES];      // Coefficients waiting to be copied into stages.
+    int64_t         state[BIQUAD_FILTER_MAX_STAGES][2];     // Direct form II transposed state, in Q(BIQUAD_COEFFICIENT_BITS + BIQUAD_GUARD_BITS).
+    int             stageCount;
+    int             pendingCount;
+    volatile bool   updated;            // True if pending holds coefficients not yet in use.
+    bool            clearState;
+
+    /**
+     * Filters the given buffer, interpreted as type T, into a new buffer of the same format.
+     */
+    template <typename T> ManagedBuffer filterBuffer(ManagedBuffer &buf);
+
+    /**
+     * Computes the coefficients of the given stage from its design, at the given sample rate.
+     * @return true on success, or false if the design cannot be realised at that rate.
+     */
+    bool design(BiquadStage &stage, float sampleRate);
+
+    /**
+     * Brings the stages in use up to date with any new configuration, between buffers.
+     */
+    void update();
+
+    public:
+    /**
+     * Creates a BiquadFilter attached to the given source, with no stages, so it initially passes its input unchanged.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to filter.
+     */
+    BiquadFilter(DataSource &source);
+
+    /**
+     * Destructor.
+     */
+    ~BiquadFilter();
+
+    /**
+     * Redesigns the stages when the upstream sample rate has changed. Called by the scheduler when idle.
+     */
+    virtual void idleCallback();
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller, filtered.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     *
+     * @sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     *
+     * @return true If a downstream is connected
+     * @return false If a downstream is not connected
+     */
+    virtual bool isConnected();
+
+    /**
+     *  Disconnect this source from a downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Requests a new sample rate from our upstream.
+     */
+    virtual float requestSampleRate(float sampleRate);
+
+    /**
+     * Configures one stage of the cascade, extending the cascade to include it if need be.
+     * Coefficients are computed here, and again by the idle callback only if the upstream sample rate changes.
+     *
+     * @param index the stage, from 0 to BIQUAD_FILTER_MAX_STAGES-1.
+     * @param type one of the BIQUAD_ filter types.
+     * @param frequency the cutoff, centre or shelf frequency, in Hz.
+     * @param q the quality factor. 0.7071 gives a maximally flat low or high pass; larger values are narrower.
+     * @param gain the gain, in dB, of a peak or shelf. Ignored by the other types.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the stage, type or parameters are invalid.
+     */
+    int setStage(int index, int type, float frequency, float q = 0.7071f, float gain = 0.0f);
+
+    /**
+     * Configures one stage of the cascade from coefficients computed elsewhere, normalised so that a0 is 1.
+     * Such stages do not follow changes of the sample rate.
+     *
+     * @param index the stage, from 0 to BIQUAD_FILTER_MAX_STAGES-1.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the stage is invalid or a coefficient is outside +/-8.
+     */
+    int setStageCoefficients(int index, float b0, float b1, float b2, float a1, float a2);
+
+    /**
+     * Sets the number of stages in the cascade. Stages that have not been configured pass their input unchanged.
+     * @param count the number of stages, from 0 (no filtering) to BIQUAD_FILTER_MAX_STAGES.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the count is out of range.
+     */
+    int setStageCount(int count);
+
+    /**
+     * Determines the number of stages in the cascade.
+     */
+    int getStageCount();
+
+    /**
+     * Clears the state of every stage from the next buffer, as if the input had been silent.
+     */
+    void reset();
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "MicroBit.h"
+#include "BiquadFilter.h"
+#include "RmsLevelDetector.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define BIQUAD_BENCHMARK_SAMPLES        512
+#define BIQUAD_BENCHMARK_ITERATIONS     20
+#define BIQUAD_BENCHMARK_RATE           11000
+
+/**
+ * A DataSource that hands out a buffer holding a tone of the given frequency on every pull, continuing the
+ * tone from one buffer to the next, so the filter can be driven synchronously.
+ */
+class BiquadBenchmarkSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+    float frequency;
+    float phase;
+
+    BiquadBenchmarkSource() : buffer(BIQUAD_BENCHMARK_SAMPLES * 2)
+    {
+        frequency = 0;
+        phase = 0;
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        ManagedBuffer b(BIQUAD_BENCHMARK_SAMPLES * 2);
+        int16_t *p = (int16_t *)&b[0];
+
+        for (int i = 0; i < BIQUAD_BENCHMARK_SAMPLES; i++)
+        {
+            p[i] = (int16_t)(16384.0f * sinf(phase));
+            phase += 2.0f * (float)M_PI * frequency / BIQUAD_BENCHMARK_RATE;
+        }
+
+        phase = fmodf(phase, 2.0f * (float)M_PI);
+        buffer = b;
+
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return DATASTREAM_FORMAT_16BIT_SIGNED;
+    }
+
+    virtual float getSampleRate()
+    {
+        return BIQUAD_BENCHMARK_RATE;
+    }
+};
+
+/**
+ * Determines the level of a buffer of 16 bit signed samples, in hundredths of a dB.
+ */
+static int
+biquad_benchmark_level(ManagedBuffer b)
+{
+    int16_t *p = (int16_t *)&b[0];
+    uint64_t sum = 0;
+
+    for (int i = 0; i < BIQUAD_BENCHMARK_SAMPLES; i++)
+        sum += p[i] * p[i];
+
+    return rms_level_millibels(sum / BIQUAD_BENCHMARK_SAMPLES);
+}
+
+/**
+ * Determines the gain of the filter at the given frequency, in hundredths of a dB, once it has settled.
+ */
+static int
+biquad_benchmark_gain(BiquadBenchmarkSource &source, BiquadFilter &filter, float frequency)
+{
+    source.frequency = frequency;
+    filter.reset();
+
+    for (int i = 0; i < 8; i++)
+        filter.pull();
+
+    return biquad_benchmark_level(filter.pull()) - biquad_benchmark_level(source.buffer);
+}
+
+/**
+ * Measures the cost of the cascade, from one stage up to BIQUAD_FILTER_MAX_STAGES, and the response of the
+ * mains hum notch and band limiting used ahead of level detection. Results are written to DMESG.
+ */
+void
+biquad_filter_benchmark()
+{
+    static const float frequencies[] = {50, 100, 150, 300, 1000, 3000, 4500};
+    BiquadBenchmarkSource source;
+    BiquadFilter filter(source);
+
+    cycle_counter_enable();
+
+    DMESG("BIQUAD_FILTER_BENCHMARK: %d samples at %d Hz (cycles per sample)", BIQUAD_BENCHMARK_SAMPLES, BIQUAD_BENCHMARK_RATE);
+
+    // The cost of generating the tone is measured separately and taken away.
+    source.frequency = 1000;
+    uint32_t start = cycle_counter_read();
+
+    for (int i = 0; i < BIQUAD_BENCHMARK_ITERATIONS; i++)
+        source.pull();
+
+    uint32_t overhead = cycle_counter_read() - start;
+
+    for (int stages = 1; stages <= BIQUAD_FILTER_MAX_STAGES; stages++)
+    {
+        for (int s = 0; s < stages; s++)
+            filter.setStage(s, BIQUAD_PEAK, 500.0f * (s + 1), 1.0f, 3.0f);
+
+        filter.setStageCount(stages);
+        filter.pull();
+
+        start = cycle_counter_read();
+
+        for (int i = 0; i < BIQUAD_BENCHMARK_ITERATIONS; i++)
+            filter.pull();
+
+        uint32_t cycles = cycle_counter_read() - start - overhead;
+
+        DMESG("   %d STAGES: %d", stages, (int)(cycles / (BIQUAD_BENCHMARK_ITERATIONS * BIQUAD_BENCHMARK_SAMPLES)));
+    }
+
+    // Notches at the mains frequency and its first harmonic, then band limiting to 150Hz - 4kHz.
+    filter.setStage(0, BIQUAD_NOTCH, 50.0f, 2.0f);
+    filter.setStage(1, BIQUAD_NOTCH, 100.0f, 2.0f);
+    filter.setStage(2, BIQUAD_HIGH_PASS, 150.0f);
+    filter.setStage(3, BIQUAD_LOW_PASS, 4000.0f);
+    filter.setStageCount(4);
+
+    DMESG("   HUM FILTER RESPONSE (hundredths of a dB):");
+
+    for (unsigned int i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++)
+        DMESG("   %d Hz: %d", (int)frequencies[i], biquad_benchmark_gain(source, filter, frequencies[i]));
+}
@@ -0,0 +1,211 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "BufferPool.h"
+
+static BufferPool *buffer_pool_default = NULL;
+
+/**
+ * Creates an empty BufferPool. Buffers are added with addClass().
+ */
+BufferPool::BufferPool()
+{
+    this->bufferCount = 0;
+    this->classCount = 0;
+
+    resetStatistics();
+}
+
+/**
+ * Allocates a class of buffers. Classes may be added in any order.
+ *
+ * @param capacity the size of each buffer, in bytes.
+ * @param count the number of buffers.
+ * @return DEVICE_OK, DEVICE_INVALID_PARAMETER if either value is not positive, or DEVICE_NO_RESOURCES
+ * if BUFFER_POOL_MAX_CLASSES or BUFFER_POOL_MAX_BUFFERS would be exceeded.
+ */
+int
+BufferPool::addClass(int capacity, int count)
+{
+    if (capacity <= 0 || count <= 0)
+        return DEVICE_INVALID_PARAMETER;
+
+    if (classCount == BUFFER_POOL_MAX_CLASSES || bufferCount + count > BUFFER_POOL_MAX_BUFFERS)
+        return DEVICE_NO_RESOURCES;
+
+    // Keep the classes in order of capacity, so the first fit is the best fit.
+    int c = classCount;
+
+    while (c > 0 && classes[c - 1].capacity > capacity)
+    {
+        classes[c] = classes[c - 1];
+        c--;
+    }
+
+    classes[c].capacity = capacity;
+    classes[c].first = bufferCount;
+    classes[c].count = count;
+    classes[c].highWater = 0;
+    classCount++;
+
+    // The pool keeps one reference to each buffer for as long as it exists.
+    for (int i = 0; i < count; i++)
+    {
+        ManagedBuffer b(capacity);
+
+        buffers[bufferCount] = b.leakData();
+        idleRefCount[bufferCount] = buffers[bufferCount]->refCount;
+        bufferCount++;
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Provides a buffer of the given length, from the pool if one is free, or from the heap otherwise.
+ * The contents of a pooled buffer are undefined.
+ *
+ * @param length the length of the buffer, in bytes.
+ */
+ManagedBuffer
+BufferPool::allocate(int length)
+{
+    if (length <= 0)
+        return ManagedBuffer();
+
+    for (int c = 0; c < classCount; c++)
+    {
+        BufferPoolClass &k = classes[c];
+
+        if (k.capacity < length)
+            continue;
+
+        int free = -1;
+        int inUse = 0;
+
+        for (int i = k.first; i < k.first + k.count; i++)
+        {
+            if (buffers[i]->refCount != idleRefCount[i])
+                inUse++;
+            else if (free < 0)
+                free = i;
+        }
+
+        if (free < 0)
+            continue;
+
+        k.highWater = max(k.highWater, inUse + 1);
+        hits++;
+
+        buffers[free]->length = length;
+        return ManagedBuffer(buffers[free]);
+    }
+
+    misses++;
+    return ManagedBuffer(length);
+}
+
+/**
+ * Determines the number of allocations served from the pool since the statistics were last reset.
+ */
+uint32_t
+BufferPool::getHitCount()
+{
+    return hits;
+}
+
+/**
+ * Determines the number of allocations that fell back to the heap since the statistics were last reset.
+ */
+uint32_t
+BufferPool::getMissCount()
+{
+    return misses;
+}
+
+/**
+ * Determines the most buffers of the given class in use at once since the statistics were last reset.
+ * @param capacity the capacity of the class, in bytes.
+ * @return the high water mark, or DEVICE_INVALID_PARAMETER if there is no such class.
+ */
+int
+BufferPool::getHighWater(int capacity)
+{
+    for (int c = 0; c < classCount; c++)
+        if (classes[c].capacity == capacity)
+            return classes[c].highWater;
+
+    return DEVICE_INVALID_PARAMETER;
+}
+
+/**
+ * Determines the number of pooled buffers currently in use.
+ */
+int
+BufferPool::getInUseCount()
+{
+    int inUse = 0;
+
+    for (int i = 0; i < bufferCount; i++)
+        if (buffers[i]->refCount != idleRefCount[i])
+            inUse++;
+
+    return inUse;
+}
+
+/**
+ * Clears the counters and high water marks.
+ */
+void
+BufferPool::resetStatistics()
+{
+    hits = 0;
+    misses = 0;
+
+    for (int c = 0; c < classCount; c++)
+        classes[c].highWater = 0;
+}
+
+/**
+ * Sets the pool used by buffer_pool_allocate().
+ * @param pool the pool, or NULL to allocate from the heap.
+ */
+void
+BufferPool::setDefault(BufferPool *pool)
+{
+    buffer_pool_default = pool;
+}
+
+/**
+ * Provides a buffer of the given length from the default pool, or from the heap if no default pool is set.
+ * The contents of the buffer are undefined.
+ */
+ManagedBuffer
+buffer_pool_allocate(int length)
+{
+    if (buffer_pool_default)
+        return buffer_pool_default->allocate(length);
+
+    return ManagedBuffer(length);
+}
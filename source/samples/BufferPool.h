@@ -0,0 +1,135 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "ManagedBuffer.h"
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#define BUFFER_POOL_MAX_CLASSES     4
+#define BUFFER_POOL_MAX_BUFFERS     24
+
+/**
+ * A set of preallocated buffers of the same capacity.
+ */
+struct BufferPoolClass
+{
+    int             capacity;           // Largest length, in bytes, the buffers can hold.
+    int             first;              // Index of the first buffer of the class in the pool.
+    int             count;
+    int             highWater;          // Most buffers of the class in use at once.
+};
+
+/**
+ * A fixed set of audio buffers, allocated once and reused, grouped into size classes.
+ *
+ * allocate() returns a ManagedBuffer backed by the smallest free buffer large enough, with its length
+ * set to the length asked for. The pool keeps its own reference to every buffer, so a buffer is never
+ * freed, and it becomes free again as soon as every other ManagedBuffer referring to it has gone. This
+ * means stages that keep buffers (recordings, the splitter fanning one buffer out to several channels)
+ * are safe: a buffer is only reused once nothing can see it.
+ *
+ * When no buffer is free, or the length is larger than every class, the buffer comes from the heap as
+ * usual and a miss is counted. Unlike a new ManagedBuffer, a pooled buffer is not cleared.
+ *
+ * Stages in this tree allocate their output through buffer_pool_allocate(), which uses the pool given to
+ * BufferPool::setDefault(), or the heap if there is none.
+ */
+class BufferPool
+{
+    BufferData      *buffers[BUFFER_POOL_MAX_BUFFERS];
+    uint16_t        idleRefCount[BUFFER_POOL_MAX_BUFFERS];  // Reference count of each buffer when only the pool holds it.
+    int             bufferCount;
+    BufferPoolClass classes[BUFFER_POOL_MAX_CLASSES];
+    int             classCount;
+    uint32_t        hits;
+    uint32_t        misses;
+
+    public:
+    /**
+     * Creates an empty BufferPool. Buffers are added with addClass().
+     */
+    BufferPool();
+
+    /**
+     * Allocates a class of buffers. Classes may be added in any order.
+     *
+     * @param capacity the size of each buffer, in bytes.
+     * @param count the number of buffers.
+     * @return DEVICE_OK, DEVICE_INVALID_PARAMETER if either value is not positive, or DEVICE_NO_RESOURCES
+     * if BUFFER_POOL_MAX_CLASSES or BUFFER_POOL_MAX_BUFFERS would be exceeded.
+     */
+    int addClass(int capacity, int count);
+
+    /**
+     * Provides a buffer of the given length, from the pool if one is free, or from the heap otherwise.
+     * The contents of a pooled buffer are undefined.
+     *
+     * @param length the length of the buffer, in bytes.
+     */
+    ManagedBuffer allocate(int length);
+
+    /**
+     * Determines the number of allocations served from the pool since the statistics were last reset.
+     */
+    uint32_t getHitCount();
+
+    /**
+     * Determines the number of allocations that fell back to the heap since the statistics were last reset.
+     */
+    uint32_t getMissCount();
+
+    /**
+     * Determines the most buffers of the given class in use at once since the statistics were last reset.
+     * @param capacity the capacity of the class, in bytes.
+     * @return the high water mark, or DEVICE_INVALID_PARAMETER if there is no such class.
+     */
+    int getHighWater(int capacity);
+
+    /**
+     * Determines the number of pooled buffers currently in use.
+     */
+    int getInUseCount();
+
+    /**
+     * Clears the counters and high water marks.
+     */
+    void resetStatistics();
+
+    /**
+     * Sets the pool used by buffer_pool_allocate().
+     * @param pool the pool, or NULL to allocate from the heap.
+     */
+    static void setDefault(BufferPool *pool);
+};
+
+/**
+ * Provides a buffer of the given length from the default pool, or from the heap if no default pool is set.
+ * The contents of the buffer are undefined.
+ */
+ManagedBuffer buffer_pool_allocate(int length);
+
+#endif
@@ -0,0 +1,53 @@
+#include "MicroBit.h"
+#include "BufferPool.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define BUFFER_POOL_BENCHMARK_ITERATIONS    200
+
+/**
+ * Measures the mean cost of allocating and releasing a buffer of the given length, in cycles.
+ * Each buffer is held while the next is allocated, as a stage's output is while its downstream reads it.
+ */
+static int
+buffer_pool_benchmark_cost(BufferPool *pool, int length)
+{
+    ManagedBuffer held;
+
+    uint32_t start = cycle_counter_read();
+
+    for (int i = 0; i < BUFFER_POOL_BENCHMARK_ITERATIONS; i++)
+        held = pool ? pool->allocate(length) : ManagedBuffer(length);
+
+    return (int)((cycle_counter_read() - start) / BUFFER_POOL_BENCHMARK_ITERATIONS);
+}
+
+/**
+ * Compares the cost of allocating the buffer sizes used by the audio pipeline from the heap and from a
+ * BufferPool, and reports the pool counters. Results are written to DMESG.
+ */
+void
+buffer_pool_benchmark()
+{
+    static const int lengths[] = {128, 256, 512, 1024};
+    BufferPool pool;
+
+    pool.addClass(256, 4);
+    pool.addClass(512, 4);
+    pool.addClass(1024, 2);
+
+    cycle_counter_enable();
+
+    DMESG("BUFFER_POOL_BENCHMARK: %d iterations (cycles per allocation)", BUFFER_POOL_BENCHMARK_ITERATIONS);
+
+    for (unsigned int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        int heap = buffer_pool_benchmark_cost(NULL, lengths[i]);
+        int pooled = buffer_pool_benchmark_cost(&pool, lengths[i]);
+
+        DMESG("   %d BYTES: HEAP %d POOL %d", lengths[i], heap, pooled);
+    }
+
+    DMESG("   HITS %d MISSES %d HIGH WATER 256:%d 512:%d 1024:%d", (int)pool.getHitCount(), (int)pool.getMissCount(),
+        pool.getHighWater(256), pool.getHighWater(512), pool.getHighWater(1024));
+}
@@ -0,0 +1,433 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "CompressedRecording.h"
+#include "BufferPool.h"
+
+/**
+ * Converts a raw sample into a 16 bit signed value, and back again.
+ */
+static inline int recording_sample(int8_t s) { return s << 8; }
+static inline int recording_sample(uint8_t s) { return ((int)s - 128) << 8; }
+static inline int recording_sample(int16_t s) { return s; }
+static inline int recording_sample(uint16_t s) { return (int)s - 32768; }
+
+static inline void recording_store(int8_t *p, int v) { *p = v >> 8; }
+static inline void recording_store(uint8_t *p, int v) { *p = (v >> 8) + 128; }
+static inline void recording_store(int16_t *p, int v) { *p = v; }
+static inline void recording_store(uint16_t *p, int v) { *p = v + 32768; }
+
+/**
+ * Creates a CompressedStreamRecording attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to record.
+ * @param length the maximum amount of memory to use for the recording, in bytes.
+ * @param encoding RECORDING_ENCODING_ADPCM (default) or RECORDING_ENCODING_PCM.
+ */
+CompressedStreamRecording::CompressedStreamRecording(DataSource &source, uint32_t length, int encoding) : upstream(source)
+{
+    this->downstream = NULL;
+    this->maxChunks = length / COMPRESSED_RECORDING_CHUNK_SIZE;
+    this->chunks = new ManagedBuffer[maxChunks];
+    this->chunkCount = 0;
+    this->chunkSamples = 0;
+    this->readChunk = 0;
+    this->samples = 0;
+    this->encoding = encoding;
+    this->format = source.getFormat();
+    this->sampleRate = source.getSampleRate();
+    this->state = COMPRESSED_RECORDING_STOPPED;
+
+    // Register with our upstream component. Nothing is wanted from it until recording starts.
+    source.connect(*this);
+    source.dataWanted(DATASTREAM_NOT_WANTED);
+}
+
+/**
+ * Destructor. Frees all recorded data.
+ */
+CompressedStreamRecording::~CompressedStreamRecording()
+{
+    delete[] chunks;
+}
+
+/**
+ * Provide the next block of the recording to our downstream caller, decoded to the format it was recorded in.
+ */
+ManagedBuffer
+CompressedStreamRecording::pull()
+{
+    if (state != COMPRESSED_RECORDING_PLAYING || readChunk >= chunkCount)
+    {
+        stop();
+        return ManagedBuffer();
+    }
+
+    int chunk = readChunk++;
+    int n = min((int)(samples - chunk * chunkSamples), chunkSamples);
+    ManagedBuffer out;
+
+    if (encoding == RECORDING_ENCODING_PCM)
+    {
+        out = n == chunkSamples ? chunks[chunk] : ManagedBuffer(&chunks[chunk][0], n * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format));
+    }
+    else
+    {
+        switch (format)
+        {
+            case DATASTREAM_FORMAT_8BIT_SIGNED:
+                out = decodeChunk<int8_t>(chunk, n);
+                break;
+
+            case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+                out = decodeChunk<uint8_t>(chunk, n);
+                break;
+
+            case DATASTREAM_FORMAT_16BIT_SIGNED:
+                out = decodeChunk<int16_t>(chunk, n);
+                break;
+
+            case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+                out = decodeChunk<uint16_t>(chunk, n);
+                break;
+        }
+    }
+
+    // Keep our downstream pulling. Once the recording is exhausted, the next (empty) pull stops playback.
+    if (downstream)
+        downstream->pullRequest();
+
+    return out;
+}
+
+/**
+ * Decodes the given chunk into a new buffer of type T samples.
+ */
+template <typename T> ManagedBuffer
+CompressedStreamRecording::decodeChunk(int chunk, int n)
+{
+    ManagedBuffer out = buffer_pool_allocate(n * sizeof(T));
+    uint8_t *in = &chunks[chunk][0];
+    T *p = (T *)&out[0];
+    T *end = p + n;
+
+    // Chunks are always played in order from the first, so the decoder state simply carries on from the previous one.
+    if (chunk == 0)
+        codec.reset();
+
+    while (p < end)
+    {
+        uint8_t b = *in++;
+
+        recording_store(p++, codec.decode(b & 0x0F));
+
+        if (p < end)
+            recording_store(p++, codec.decode(b >> 4));
+    }
+
+    return out;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+CompressedStreamRecording::pullRequest()
+{
+    if (state != COMPRESSED_RECORDING_RECORDING)
+        return DEVICE_BUSY;
+
+    ManagedBuffer buf = upstream.pull();
+
+    switch (format)
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            recordBuffer<int8_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            recordBuffer<uint8_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            recordBuffer<int16_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            recordBuffer<uint16_t>(buf);
+            break;
+
+        default:
+            stop();
+            return DEVICE_NOT_SUPPORTED;
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Appends the given buffer, interpreted as type T, to the recording.
+ */
+template <typename T> void
+CompressedStreamRecording::recordBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    int len = buf.length() / sizeof(T);
+
+    while (len > 0)
+    {
+        int offset = samples % chunkSamples;
+
+        if (offset == 0)
+        {
+            if (chunkCount == maxChunks)
+            {
+                stop();
+                return;
+            }
+
+            chunks[chunkCount++] = ManagedBuffer(COMPRESSED_RECORDING_CHUNK_SIZE);
+        }
+
+        int n = min(len, chunkSamples - offset);
+
+        if (encoding == RECORDING_ENCODING_PCM)
+        {
+            memcpy(&chunks[chunkCount - 1][offset * sizeof(T)], p, n * sizeof(T));
+            p += n;
+        }
+        else
+        {
+            uint8_t *out = &chunks[chunkCount - 1][offset >> 1];
+
+            for (int i = offset; i < offset + n; i++)
+            {
+                uint8_t code = codec.encode(recording_sample(*p++));
+
+                if (i & 1)
+                    *out++ |= code << 4;
+                else
+                    *out = code;
+            }
+        }
+
+        samples += n;
+        len -= n;
+    }
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+CompressedStreamRecording::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+CompressedStreamRecording::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+CompressedStreamRecording::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the recording, which is that of the upstream when it was recorded.
+ */
+int
+CompressedStreamRecording::getFormat()
+{
+    return format;
+}
+
+/**
+ * Determines the sample rate of the recording, which is that of the upstream when it was recorded.
+ */
+float
+CompressedStreamRecording::getSampleRate()
+{
+    return sampleRate;
+}
+
+/**
+ * Starts recording in the background, discarding any previous recording.
+ */
+void
+CompressedStreamRecording::recordAsync()
+{
+    erase();
+
+    format = upstream.getFormat();
+    sampleRate = upstream.getSampleRate();
+    chunkSamples = encoding == RECORDING_ENCODING_PCM ? COMPRESSED_RECORDING_CHUNK_SIZE / DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format) : COMPRESSED_RECORDING_CHUNK_SIZE * 2;
+    codec.reset();
+
+    state = COMPRESSED_RECORDING_RECORDING;
+    upstream.dataWanted(DATASTREAM_WANTED);
+}
+
+/**
+ * Records until the recording is full, or stop() is called from another fiber.
+ */
+void
+CompressedStreamRecording::record()
+{
+    recordAsync();
+
+    while (isRecording())
+        fiber_sleep(5);
+}
+
+/**
+ * Starts playing the recording in the background.
+ */
+void
+CompressedStreamRecording::playAsync()
+{
+    stop();
+
+    readChunk = 0;
+    state = COMPRESSED_RECORDING_PLAYING;
+
+    if (downstream)
+        downstream->pullRequest();
+}
+
+/**
+ * Plays the recording, returning when playback is complete or stop() is called from another fiber.
+ */
+void
+CompressedStreamRecording::play()
+{
+    playAsync();
+
+    while (isPlaying())
+        fiber_sleep(5);
+}
+
+/**
+ * Stops any recording or playback in progress. The recording is retained.
+ */
+void
+CompressedStreamRecording::stop()
+{
+    // As for StreamRecording, let the upstream go idle once we stop recording.
+    if (state == COMPRESSED_RECORDING_RECORDING)
+        upstream.dataWanted(DATASTREAM_NOT_WANTED);
+
+    state = COMPRESSED_RECORDING_STOPPED;
+}
+
+/**
+ * Stops any recording or playback in progress, and frees all recorded data.
+ */
+void
+CompressedStreamRecording::erase()
+{
+    stop();
+
+    for (int i = 0; i < chunkCount; i++)
+        chunks[i] = ManagedBuffer();
+
+    chunkCount = 0;
+    readChunk = 0;
+    samples = 0;
+}
+
+/**
+ * Determines if a recording is in progress.
+ */
+bool
+CompressedStreamRecording::isRecording()
+{
+    return state == COMPRESSED_RECORDING_RECORDING;
+}
+
+/**
+ * Determines if playback is in progress.
+ */
+bool
+CompressedStreamRecording::isPlaying()
+{
+    return state == COMPRESSED_RECORDING_PLAYING;
+}
+
+/**
+ * Determines if the component is neither recording nor playing.
+ */
+bool
+CompressedStreamRecording::isStopped()
+{
+    return state == COMPRESSED_RECORDING_STOPPED;
+}
+
+/**
+ * Determines if the storage budget has been used up.
+ */
+bool
+CompressedStreamRecording::isFull()
+{
+    return samples > 0 && chunkCount == maxChunks && samples % chunkSamples == 0;
+}
+
+/**
+ * Determines the length of the recording once decoded, in bytes.
+ */
+uint32_t
+CompressedStreamRecording::length()
+{
+    return samples * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format);
+}
+
+/**
+ * Determines the duration of the recording, in seconds.
+ */
+float
+CompressedStreamRecording::duration()
+{
+    return sampleRate > 0 ? samples / sampleRate : 0;
+}
+
+/**
+ * Determines the amount of memory holding the recording, in bytes.
+ */
+uint32_t
+CompressedStreamRecording::getMemoryUsage()
+{
+    return chunkCount * COMPRESSED_RECORDING_CHUNK_SIZE;
+}
@@ -0,0 +1,197 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+#include "ImaAdpcm.h"
+
+#ifndef COMPRESSED_RECORDING_H
+#define COMPRESSED_RECORDING_H
+
+// Storage encodings. PCM stores samples as received; ADPCM stores 4 bits per sample
+// (2x the length of 8 bit PCM, or 4x the length of 16 bit PCM, in the same RAM).
+#define RECORDING_ENCODING_PCM                  0
+#define RECORDING_ENCODING_ADPCM                1
+
+// Default storage budget in bytes, and the size of each block of storage allocated while recording.
+#define COMPRESSED_RECORDING_DEFAULT_LENGTH     50000
+#define COMPRESSED_RECORDING_CHUNK_SIZE         256
+
+#define COMPRESSED_RECORDING_STOPPED            0
+#define COMPRESSED_RECORDING_RECORDING          1
+#define COMPRESSED_RECORDING_PLAYING            2
+
+/**
+ * A drop in alternative to StreamRecording that can encode its input as it is recorded, and decodes
+ * it again on the fly as it is played back. Recording, playback and erase behave as for StreamRecording.
+ *
+ * Storage is allocated in COMPRESSED_RECORDING_CHUNK_SIZE blocks as the recording grows, up to the
+ * given length, and each pull during playback decodes a single block.
+ */
+class CompressedStreamRecording : public DataSource, public DataSink
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    ManagedBuffer   *chunks;
+    int             maxChunks;
+    int             chunkCount;         // Number of chunks allocated.
+    int             chunkSamples;       // Number of samples held by each chunk.
+    int             readChunk;          // The next chunk to be played.
+    uint32_t        samples;            // Number of samples recorded.
+    int             encoding;
+    int             format;             // Format of the upstream when recorded.
+    float           sampleRate;         // Sample rate of the upstream when recorded.
+    int             state;
+    ImaAdpcm        codec;
+
+    /**
+     * Appends the given buffer, interpreted as type T, to the recording.
+     */
+    template <typename T> void recordBuffer(ManagedBuffer &buf);
+
+    /**
+     * Decodes the given chunk into a new buffer of type T samples.
+     */
+    template <typename T> ManagedBuffer decodeChunk(int chunk, int n);
+
+    public:
+    /**
+     * Creates a CompressedStreamRecording attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to record.
+     * @param length the maximum amount of memory to use for the recording, in bytes.
+     * @param encoding RECORDING_ENCODING_ADPCM (default) or RECORDING_ENCODING_PCM.
+     */
+    CompressedStreamRecording(DataSource &source, uint32_t length = COMPRESSED_RECORDING_DEFAULT_LENGTH, int encoding = RECORDING_ENCODING_ADPCM);
+
+    /**
+     * Destructor. Frees all recorded data.
+     */
+    ~CompressedStreamRecording();
+
+    /**
+     * Provide the next block of the recording to our downstream caller, decoded to the format it was recorded in.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the recording, which is that of the upstream when it was recorded.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the recording, which is that of the upstream when it was recorded.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Starts recording in the background, discarding any previous recording.
+     */
+    void recordAsync();
+
+    /**
+     * Records until the recording is full, or stop() is called from another fiber.
+     */
+    void record();
+
+    /**
+     * Starts playing the recording in the background.
+     */
+    void playAsync();
+
+    /**
+     * Plays the recording, returning when playback is complete or stop() is called from another fiber.
+     */
+    void play();
+
+    /**
+     * Stops any recording or playback in progress. The recording is retained.
+     */
+    void stop();
+
+    /**
+     * Stops any recording or playback in progress, and frees all recorded data.
+     */
+    void erase();
+
+    /**
+     * Determines if a recording is in progress.
+     */
+    bool isRecording();
+
+    /**
+     * Determines if playback is in progress.
+     */
+    bool isPlaying();
+
+    /**
+     * Determines if the component is neither recording nor playing.
+     */
+    bool isStopped();
+
+    /**
+     * Determines if the storage budget has been used up.
+     */
+    bool isFull();
+
+    /**
+     * Determines the length of the recording once decoded, in bytes.
+     */
+    uint32_t length();
+
+    /**
+     * Determines the duration of the recording, in seconds.
+     */
+    float duration();
+
+    /**
+     * Determines the amount of memory holding the recording, in bytes.
+     */
+    uint32_t getMemoryUsage();
+};
+
+#endif
@@ -0,0 +1,53 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "nrf.h"
+
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+/**
+ * Minimal wrapper around the Cortex-M4 DWT cycle counter, used by the benchmark samples
+ * to measure the cost of audio kernels in CPU cycles (64 cycles per microsecond on the nRF52833).
+ */
+
+/**
+ * Enables the DWT cycle counter. Safe to call more than once.
+ */
+static inline void cycle_counter_enable()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * Reads the current value of the free running cycle counter.
+ * Differences between two readings are valid across a single 32 bit wrap (~67 seconds at 64MHz).
+ */
+static inline uint32_t cycle_counter_read()
+{
+    return DWT->CYCCNT;
+}
+
+#endif
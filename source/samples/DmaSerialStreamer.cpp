@@ -0,0 +1,247 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DmaSerialStreamer.h"
+
+/**
+ * Maps a baud rate onto the corresponding UARTE BAUDRATE register value.
+ */
+static uint32_t dma_serial_baud(int baud)
+{
+    switch (baud)
+    {
+        case 230400:
+            return UARTE_BAUDRATE_BAUDRATE_Baud230400;
+        case 460800:
+            return UARTE_BAUDRATE_BAUDRATE_Baud460800;
+        case 921600:
+            return UARTE_BAUDRATE_BAUDRATE_Baud921600;
+        case 1000000:
+            return UARTE_BAUDRATE_BAUDRATE_Baud1M;
+    }
+
+    return UARTE_BAUDRATE_BAUDRATE_Baud115200;
+}
+
+// Iterations to wait for a UARTE to acknowledge a stop task. Far longer than the few microseconds this takes.
+#define DMA_SERIAL_STOP_TIMEOUT     10000
+
+/**
+ * Changes the TX pin of a UARTE that may be in use by another driver.
+ *
+ * PSEL registers may only be written while the peripheral is disabled, and a UARTE must be stopped before
+ * it is disabled. So any transfers are stopped, the peripheral is disabled while the pin is changed, and it
+ * is then returned to its previous state, with reception restarted if it was running. The end events from
+ * stopping are left for the owning driver to handle, as they would be for any transfer it had stopped.
+ */
+static void dma_serial_set_txd(NRF_UARTE_Type *uarte, uint32_t txd)
+{
+    target_disable_irq();
+
+    uint32_t enable = uarte->ENABLE;
+    bool receiving = false;
+
+    if (enable != UARTE_ENABLE_ENABLE_Disabled)
+    {
+        uarte->EVENTS_TXSTOPPED = 0;
+        uarte->TASKS_STOPTX = 1;
+        for (int i = 0; i < DMA_SERIAL_STOP_TIMEOUT && !uarte->EVENTS_TXSTOPPED; i++);
+        uarte->EVENTS_TXSTOPPED = 0;
+
+        // RXTO only follows STOPRX if reception was running.
+        uarte->EVENTS_RXTO = 0;
+        uarte->TASKS_STOPRX = 1;
+        for (int i = 0; i < DMA_SERIAL_STOP_TIMEOUT && !uarte->EVENTS_RXTO; i++);
+        receiving = uarte->EVENTS_RXTO;
+        uarte->EVENTS_RXTO = 0;
+
+        uarte->ENABLE = UARTE_ENABLE_ENABLE_Disabled;
+    }
+
+    uarte->PSEL.TXD = txd;
+    uarte->ENABLE = enable;
+
+    if (receiving)
+        uarte->TASKS_STARTRX = 1;
+
+    target_enable_irq();
+}
+
+/**
+ * Creates a DmaSerialStreamer attached to the given source.
+ *
+ * @param source a DataSource to stream.
+ * @param tx the pin to transmit on.
+ * @param baud the baud rate to use: 115200, 230400, 460800, 921600 or 1000000.
+ * @param uarte the UARTE peripheral to use. This must not be the one used by uBit.serial.
+ */
+DmaSerialStreamer::DmaSerialStreamer(DataSource &source, Pin &tx, int baud, NRF_UARTE_Type *uarte) : CodalComponent(DEVICE_ID_DMA_SERIAL_STREAMER, 0), upstream(source)
+{
+    this->uarte = uarte;
+    this->busy = false;
+    this->bytesSent = 0;
+    this->dropped = 0;
+
+    // Detach any other UARTE (normally uBit.serial) from the pin, so the two don't contend.
+    static NRF_UARTE_Type * const uartes[] = {NRF_UARTE0, NRF_UARTE1};
+    this->serialUarte = NULL;
+
+    for (unsigned int i = 0; i < sizeof(uartes) / sizeof(uartes[0]); i++)
+    {
+        if (uartes[i] != uarte && uartes[i]->PSEL.TXD == (uint32_t) tx.name)
+        {
+            serialUarte = uartes[i];
+            dma_serial_set_txd(serialUarte, 0xFFFFFFFF);
+        }
+    }
+
+    // The TX line must idle high before the UARTE takes it over.
+    tx.setDigitalValue(1);
+
+    uarte->ENABLE = UARTE_ENABLE_ENABLE_Disabled;
+    this->txPin = tx.name;
+
+    uarte->PSEL.TXD = tx.name;
+    uarte->PSEL.RXD = 0xFFFFFFFF;
+    uarte->PSEL.RTS = 0xFFFFFFFF;
+    uarte->PSEL.CTS = 0xFFFFFFFF;
+    uarte->BAUDRATE = dma_serial_baud(baud);
+    uarte->CONFIG = 0;
+    uarte->INTENCLR = 0xFFFFFFFF;
+    uarte->EVENTS_ENDTX = 0;
+    uarte->ENABLE = UARTE_ENABLE_ENABLE_Enabled;
+
+    // Poll for completion on every scheduler tick.
+    status |= DEVICE_COMPONENT_STATUS_SYSTEM_TICK;
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Destructor. Stops streaming, and returns the TX pin to uBit.serial.
+ */
+DmaSerialStreamer::~DmaSerialStreamer()
+{
+    // Stop our upstream calling into a streamer that no longer exists.
+    upstream.disconnect();
+    status &= ~DEVICE_COMPONENT_STATUS_SYSTEM_TICK;
+
+    if (busy)
+    {
+        uarte->EVENTS_TXSTOPPED = 0;
+        uarte->TASKS_STOPTX = 1;
+        for (int i = 0; i < DMA_SERIAL_STOP_TIMEOUT && !uarte->EVENTS_TXSTOPPED; i++);
+        uarte->EVENTS_TXSTOPPED = 0;
+    }
+
+    uarte->ENABLE = UARTE_ENABLE_ENABLE_Disabled;
+    uarte->PSEL.TXD = 0xFFFFFFFF;
+
+    if (serialUarte)
+        dma_serial_set_txd(serialUarte, txPin);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+DmaSerialStreamer::pullRequest()
+{
+    ManagedBuffer buffer = upstream.pull();
+
+    target_disable_irq();
+
+    // Only one buffer can wait behind the transfer in progress. Keep the most recent.
+    if (pending.length() > 0)
+        dropped++;
+
+    pending = buffer;
+
+    target_enable_irq();
+
+    service();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Periodic callback from the scheduler, used to keep the UARTE busy between pulls.
+ */
+void
+DmaSerialStreamer::periodicCallback()
+{
+    service();
+}
+
+/**
+ * Retires a completed transfer, and starts the next one if a buffer is pending.
+ */
+void
+DmaSerialStreamer::service()
+{
+    // Called from both the pipeline and the system tick, so must be atomic.
+    target_disable_irq();
+
+    if (busy && uarte->EVENTS_ENDTX)
+    {
+        uarte->EVENTS_ENDTX = 0;
+        bytesSent += uarte->TXD.AMOUNT;
+
+        // EasyDMA is done with the buffer, so our reference can be released.
+        inflight = ManagedBuffer();
+        busy = false;
+    }
+
+    if (!busy && pending.length() > 0)
+    {
+        inflight = pending;
+        pending = ManagedBuffer();
+
+        uarte->TXD.PTR = (uint32_t) inflight.getBytes();
+        uarte->TXD.MAXCNT = inflight.length();
+        uarte->TASKS_STARTTX = 1;
+        busy = true;
+    }
+
+    target_enable_irq();
+}
+
+/**
+ * Determines the number of bytes transmitted so far.
+ */
+uint32_t
+DmaSerialStreamer::getBytesSent()
+{
+    return bytesSent;
+}
+
+/**
+ * Determines the number of buffers dropped because the UARTE could not keep up.
+ */
+uint32_t
+DmaSerialStreamer::getDroppedBuffers()
+{
+    return dropped;
+}
@@ -0,0 +1,100 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+#include "nrf.h"
+
+#ifndef DMA_SERIAL_STREAMER_H
+#define DMA_SERIAL_STREAMER_H
+
+#define DEVICE_ID_DMA_SERIAL_STREAMER 9011
+
+/**
+ * A DataSink that streams its upstream in binary over a dedicated UARTE, handing each pulled
+ * ManagedBuffer directly to EasyDMA rather than copying or formatting it.
+ *
+ * A reference to the buffer being transmitted is held until the transfer completes, and one further
+ * buffer may be queued behind it, so the next pull overlaps the current transmission. Completion is
+ * polled on each pull and on every system tick, so no interrupt handler is required.
+ *
+ * While active, the streamer takes over the given TX pin. When streaming on the USB serial pin,
+ * uBit.serial output is therefore suspended until the streamer is destroyed.
+ */
+class DmaSerialStreamer : public CodalComponent, public DataSink
+{
+    DataSource      &upstream;
+    NRF_UARTE_Type  *uarte;
+    NRF_UARTE_Type  *serialUarte;       // The UARTE that was driving the TX pin, which gets it back on destruction.
+    uint32_t        txPin;
+    ManagedBuffer   inflight;           // Buffer currently owned by EasyDMA.
+    ManagedBuffer   pending;            // Buffer queued behind it.
+    bool            busy;
+    uint32_t        bytesSent;
+    uint32_t        dropped;
+
+    /**
+     * Retires a completed transfer, and starts the next one if a buffer is pending.
+     */
+    void service();
+
+    public:
+    /**
+     * Creates a DmaSerialStreamer attached to the given source.
+     *
+     * @param source a DataSource to stream.
+     * @param tx the pin to transmit on.
+     * @param baud the baud rate to use: 115200, 230400, 460800, 921600 or 1000000.
+     * @param uarte the UARTE peripheral to use. This must not be the one used by uBit.serial.
+     */
+    DmaSerialStreamer(DataSource &source, Pin &tx, int baud = 115200, NRF_UARTE_Type *uarte = NRF_UARTE1);
+
+    /**
+     * Destructor. Stops streaming, and returns the TX pin to uBit.serial.
+     */
+    ~DmaSerialStreamer();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Periodic callback from the scheduler, used to keep the UARTE busy between pulls.
+     */
+    virtual void periodicCallback();
+
+    /**
+     * Determines the number of bytes transmitted so far.
+     */
+    uint32_t getBytesSent();
+
+    /**
+     * Determines the number of buffers dropped because the UARTE could not keep up.
+     */
+    uint32_t getDroppedBuffers();
+};
+
+#endif
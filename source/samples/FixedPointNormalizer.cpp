@@ -0,0 +1,380 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "FixedPointNormalizer.h"
+#include "BufferPool.h"
+#include "nrf.h"
+
+/**
+ * Converts a raw sample into a signed value, centred on zero, and gives the centre of each format.
+ */
+static inline int normalizer_sample(int8_t s) { return s; }
+static inline int normalizer_sample(uint8_t s) { return (int)s - 128; }
+static inline int normalizer_sample(int16_t s) { return s; }
+static inline int normalizer_sample(uint16_t s) { return (int)s - 32768; }
+
+static inline int normalizer_centre(int8_t) { return 0; }
+static inline int normalizer_centre(uint8_t) { return 128; }
+static inline int normalizer_centre(int16_t) { return 0; }
+static inline int normalizer_centre(uint16_t) { return 32768; }
+
+/**
+ * Stores a sample, saturated to the range of the output type and combined with the OR mask.
+ */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+static inline void normalizer_store(int8_t *p, int v, uint32_t mask) { *p = (int8_t)(__SSAT(v, 8) | mask); }
+static inline void normalizer_store(uint8_t *p, int v, uint32_t mask) { *p = (uint8_t)(__USAT(v, 8) | mask); }
+static inline void normalizer_store(int16_t *p, int v, uint32_t mask) { *p = (int16_t)(__SSAT(v, 16) | mask); }
+static inline void normalizer_store(uint16_t *p, int v, uint32_t mask) { *p = (uint16_t)(__USAT(v, 16) | mask); }
+
+/**
+ * Stores two adjacent samples. 16 bit samples are packed into a single word.
+ */
+static inline void normalizer_store_pair(int8_t *p, int a, int b, uint32_t mask) { normalizer_store(p, a, mask); normalizer_store(p + 1, b, mask); }
+static inline void normalizer_store_pair(uint8_t *p, int a, int b, uint32_t mask) { normalizer_store(p, a, mask); normalizer_store(p + 1, b, mask); }
+static inline void normalizer_store_pair(int16_t *p, int a, int b, uint32_t mask) { *(uint32_t *)p = __PKHBT(__SSAT(a, 16), __SSAT(b, 16), 16) | (mask & 0xFFFF) * 0x10001; }
+static inline void normalizer_store_pair(uint16_t *p, int a, int b, uint32_t mask) { *(uint32_t *)p = __PKHBT(__USAT(a, 16), __USAT(b, 16), 16) | (mask & 0xFFFF) * 0x10001; }
+
+/**
+ * The value that, XORed into a word of packed samples, converts them from the input type to signed.
+ */
+static inline uint32_t normalizer_flip(int8_t) { return 0; }
+static inline uint32_t normalizer_flip(uint8_t) { return 0x80808080; }
+static inline uint32_t normalizer_flip(int16_t) { return 0; }
+static inline uint32_t normalizer_flip(uint16_t) { return 0x80008000; }
+#else
+static inline int normalizer_saturate(int v, int lo, int hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+static inline void normalizer_store(int8_t *p, int v, uint32_t mask) { *p = (int8_t)(normalizer_saturate(v, -128, 127) | mask); }
+static inline void normalizer_store(uint8_t *p, int v, uint32_t mask) { *p = (uint8_t)(normalizer_saturate(v, 0, 255) | mask); }
+static inline void normalizer_store(int16_t *p, int v, uint32_t mask) { *p = (int16_t)(normalizer_saturate(v, -32768, 32767) | mask); }
+static inline void normalizer_store(uint16_t *p, int v, uint32_t mask) { *p = (uint16_t)(normalizer_saturate(v, 0, 65535) | mask); }
+#endif
+
+/**
+ * Creates a FixedPointNormalizer attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams, in any combination.
+ *
+ * @param source the DataSource to process.
+ * @param gain the gain to apply to each sample.
+ * @param normalize true to remove the zero offset of the input.
+ * @param format the output format, or DATASTREAM_FORMAT_UNKNOWN to match the input.
+ * @param stabilisation the number of buffers the zero offset is smoothed over.
+ */
+FixedPointNormalizer::FixedPointNormalizer(DataSource &source, float gain, bool normalize, int format, int stabilisation) : upstream(source), output(*this)
+{
+    this->normalize = normalize;
+    this->fixedAllowed = true;
+    this->outputFormat = format;
+    this->stabilisation = max(1, stabilisation);
+    this->orMask = 0;
+    this->offsetValid = false;
+    this->zeroOffset = 0;
+
+    setGain(gain);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller, processed into the output format.
+ */
+ManagedBuffer
+FixedPointNormalizer::pull()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return processBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return processBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return processBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return processBuffer<uint16_t>(buf);
+    }
+
+    return buf;
+}
+
+/**
+ * Processes the given buffer, interpreted as type I, into a new buffer of the output format.
+ */
+template <typename I> ManagedBuffer
+FixedPointNormalizer::processBuffer(ManagedBuffer &buf)
+{
+    int n = buf.length() / sizeof(I);
+    int format = getFormat();
+    I *in = (I *)&buf[0];
+
+    if (n == 0)
+        return ManagedBuffer();
+
+    if (normalize)
+    {
+        float mean = meanOf<I>(buf);
+
+        zeroOffset = offsetValid ? zeroOffset + (mean - zeroOffset) / stabilisation : mean;
+        offsetValid = true;
+    }
+
+    // The zero offset and the centre of an unsigned input format become a single bias, applied after the gain.
+    float bias = (normalizer_centre(I()) - (normalize ? zeroOffset : 0.0f)) * gain;
+
+    ManagedBuffer out = buffer_pool_allocate(n * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format));
+
+    switch (format)
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            convert(in, (int8_t *)&out[0], n, bias);
+            break;
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            convert(in, (uint8_t *)&out[0], n, bias);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            convert(in, (int16_t *)&out[0], n, bias);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            convert(in, (uint16_t *)&out[0], n, bias);
+            break;
+
+        default:
+            return buf;
+    }
+
+    return out;
+}
+
+/**
+ * Determines the mean of the given buffer, interpreted as type T.
+ */
+template <typename T> float
+FixedPointNormalizer::meanOf(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    T *end = p + buf.length() / sizeof(T);
+    int n = end - p;
+    int32_t sum = 0;
+
+    while (p < end)
+        sum += normalizer_sample(*p++);
+
+    return (float)sum / n + normalizer_centre(T());
+}
+
+/**
+ * Processes n samples of type I into samples of type O, on the fixed or floating point path.
+ * @param bias the value added to each sample after the gain, folding in the zero and format offsets.
+ */
+template <typename I, typename O> void
+FixedPointNormalizer::convert(I *in, O *out, int n, float bias)
+{
+    if (fixedGain)
+        processFixed(in, out, n, (int32_t)floorf(bias + 0.5f));
+    else
+        processFloat(in, out, n, bias);
+}
+
+/**
+ * Processes n samples of type I into samples of type O, using the fixed point gain.
+ */
+template <typename I, typename O> void
+FixedPointNormalizer::processFixed(I *in, O *out, int n, int32_t bias)
+{
+    int i = 0;
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    // A sample in the top half of a word, times the Q16 gain, leaves the product in the top word of
+    // the 64 bit result. So __SMMLA applies the gain and bias to a sample in a single instruction.
+    uint32_t flip = normalizer_flip(I());
+    uint32_t *w = (uint32_t *)in;
+    uint32_t x, even, odd;
+
+    if (sizeof(I) == 2)
+    {
+        for (; i + 2 <= n; i += 2)
+        {
+            x = *w++ ^ flip;
+
+            normalizer_store_pair(out + i, __SMMLA(x << 16, fixedGain, bias), __SMMLA(x & 0xFFFF0000, fixedGain, bias), orMask);
+        }
+    }
+    else
+    {
+        for (; i + 4 <= n; i += 4)
+        {
+            // Sign extend samples 0 and 2, then 1 and 3, into pairs of halfwords.
+            x = *w++ ^ flip;
+            even = __SXTB16(x);
+            odd = __SXTB16(__ROR(x, 8));
+
+            normalizer_store_pair(out + i, __SMMLA(even << 16, fixedGain, bias), __SMMLA(odd << 16, fixedGain, bias), orMask);
+            normalizer_store_pair(out + i + 2, __SMMLA(even & 0xFFFF0000, fixedGain, bias), __SMMLA(odd & 0xFFFF0000, fixedGain, bias), orMask);
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+        normalizer_store(out + i, (int32_t)(((int64_t)normalizer_sample(in[i]) * fixedGain) >> 16) + bias, orMask);
+}
+
+/**
+ * Processes n samples of type I into samples of type O, using the floating point gain.
+ */
+template <typename I, typename O> void
+FixedPointNormalizer::processFloat(I *in, O *out, int n, float bias)
+{
+    for (int i = 0; i < n; i++)
+        normalizer_store(out + i, (int)floorf(normalizer_sample(in[i]) * gain + bias), orMask);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+FixedPointNormalizer::pullRequest()
+{
+    return output.pullRequest();
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+FixedPointNormalizer::getFormat()
+{
+    return outputFormat == DATASTREAM_FORMAT_UNKNOWN ? upstream.getFormat() : outputFormat;
+}
+
+/**
+ * Defines the data format of the buffers streamed out of this component.
+ * @param format the format, or DATASTREAM_FORMAT_UNKNOWN to match the input.
+ */
+int
+FixedPointNormalizer::setFormat(int format)
+{
+    outputFormat = format;
+    return DEVICE_OK;
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+FixedPointNormalizer::getSampleRate()
+{
+    return upstream.getSampleRate();
+}
+
+/**
+ * Requests a new sample rate from our upstream.
+ */
+float
+FixedPointNormalizer::requestSampleRate(float sampleRate)
+{
+    return upstream.requestSampleRate(sampleRate);
+}
+
+/**
+ * Determines the gain applied to each sample.
+ */
+float
+FixedPointNormalizer::getGain()
+{
+    return gain;
+}
+
+/**
+ * Sets the gain applied to each sample, choosing the fixed point path if the gain is representable.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the gain is negative.
+ */
+int
+FixedPointNormalizer::setGain(float gain)
+{
+    if (gain < 0)
+        return DEVICE_INVALID_PARAMETER;
+
+    this->gain = gain;
+
+    float q16 = gain * 65536.0f + 0.5f;
+    fixedGain = (fixedAllowed && q16 >= FIXED_NORMALIZER_MIN_GAIN && q16 < 2147483520.0f) ? (int32_t)q16 : 0;
+
+    return DEVICE_OK;
+}
+
+/**
+ * Enables or disables removal of the zero offset.
+ */
+void
+FixedPointNormalizer::setNormalize(bool normalize)
+{
+    this->normalize = normalize;
+    offsetValid = false;
+}
+
+/**
+ * Determines if the zero offset is being removed.
+ */
+bool
+FixedPointNormalizer::getNormalize()
+{
+    return normalize;
+}
+
+/**
+ * Sets a mask that is ORed into every output sample.
+ */
+void
+FixedPointNormalizer::setOrMask(uint32_t mask)
+{
+    orMask = mask;
+}
+
+/**
+ * Allows or prevents use of the fixed point path. Mainly of use to compare the two.
+ */
+void
+FixedPointNormalizer::setFixedPoint(bool allowed)
+{
+    fixedAllowed = allowed;
+    setGain(gain);
+}
+
+/**
+ * Determines if buffers are currently processed in fixed point.
+ */
+bool
+FixedPointNormalizer::isFixedPoint()
+{
+    return fixedGain != 0;
+}
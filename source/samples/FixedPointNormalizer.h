@@ -0,0 +1,171 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef FIXED_POINT_NORMALIZER_H
+#define FIXED_POINT_NORMALIZER_H
+
+// The smallest fixed point gain (in Q16) used before falling back to floating point, so the
+// gain is always held to better than one part in 4096.
+#define FIXED_NORMALIZER_MIN_GAIN       2048
+
+/**
+ * A drop in alternative to StreamNormalizer, that applies gain, zero offset removal and format
+ * conversion in fixed point.
+ *
+ * Whenever the gain can be held accurately as a Q16 multiplier (from 1/32 to 32767), each sample costs
+ * a single __SMMLA, with the zero offset and any unsigned format offset folded into one bias per buffer.
+ * 16 bit input is read two samples per word and 8 bit input four per word, and 16 bit output is written
+ * two samples per word. Other gains use a floating point path. Results are saturated to the range of
+ * the output format rather than wrapping, and then combined with the OR mask, as for StreamNormalizer.
+ *
+ * When normalizing, the mean of each buffer is tracked as the zero offset, smoothed over the given
+ * number of buffers.
+ */
+class FixedPointNormalizer : public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    bool            normalize;
+    bool            fixedAllowed;
+    int             outputFormat;
+    int             stabilisation;
+    uint32_t        orMask;
+    float           gain;
+    int32_t         fixedGain;          // Gain in Q16, or 0 if the floating point path is in use.
+    bool            offsetValid;
+
+    /**
+     * Determines the mean of the given buffer, interpreted as type T.
+     */
+    template <typename T> float meanOf(ManagedBuffer &buf);
+
+    /**
+     * Processes the given buffer, interpreted as type I, into a new buffer of the output format.
+     */
+    template <typename I> ManagedBuffer processBuffer(ManagedBuffer &buf);
+
+    /**
+     * Processes n samples of type I into samples of type O, on the fixed or floating point path.
+     * @param bias the value added to each sample after the gain, folding in the zero and format offsets.
+     */
+    template <typename I, typename O> void convert(I *in, O *out, int n, float bias);
+
+    /**
+     * Processes n samples of type I into samples of type O, using the fixed point gain.
+     */
+    template <typename I, typename O> void processFixed(I *in, O *out, int n, int32_t bias);
+
+    /**
+     * Processes n samples of type I into samples of type O, using the floating point gain.
+     */
+    template <typename I, typename O> void processFloat(I *in, O *out, int n, float bias);
+
+    public:
+    DataStream      output;
+    float           zeroOffset;         // Current zero offset, in input sample units.
+
+    /**
+     * Creates a FixedPointNormalizer attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams, in any combination.
+     *
+     * @param source the DataSource to process.
+     * @param gain the gain to apply to each sample.
+     * @param normalize true to remove the zero offset of the input.
+     * @param format the output format, or DATASTREAM_FORMAT_UNKNOWN to match the input.
+     * @param stabilisation the number of buffers the zero offset is smoothed over.
+     */
+    FixedPointNormalizer(DataSource &source, float gain = 1.0f, bool normalize = false, int format = DATASTREAM_FORMAT_UNKNOWN, int stabilisation = 4);
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller, processed into the output format.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Defines the data format of the buffers streamed out of this component.
+     * @param format the format, or DATASTREAM_FORMAT_UNKNOWN to match the input.
+     */
+    virtual int setFormat(int format);
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Requests a new sample rate from our upstream.
+     */
+    virtual float requestSampleRate(float sampleRate);
+
+    /**
+     * Determines the gain applied to each sample.
+     */
+    float getGain();
+
+    /**
+     * Sets the gain applied to each sample, choosing the fixed point path if the gain is representable.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the gain is negative.
+     */
+    int setGain(float gain);
+
+    /**
+     * Enables or disables removal of the zero offset.
+     */
+    void setNormalize(bool normalize);
+
+    /**
+     * Determines if the zero offset is being removed.
+     */
+    bool getNormalize();
+
+    /**
+     * Sets a mask that is ORed into every output sample.
+     */
+    void setOrMask(uint32_t mask);
+
+    /**
+     * Allows or prevents use of the fixed point path. Mainly of use to compare the two.
+     */
+    void setFixedPoint(bool allowed);
+
+    /**
+     * Determines if buffers are currently processed in fixed point.
+     */
+    bool isFixedPoint();
+};
+
+#endif
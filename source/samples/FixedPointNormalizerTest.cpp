@@ -0,0 +1,225 @@
+#include "MicroBit.h"
+#include "StreamNormalizer.h"
+#include "FixedPointNormalizer.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define NORMALIZER_BENCHMARK_SAMPLES        512
+#define NORMALIZER_BENCHMARK_ITERATIONS     50
+
+/**
+ * A DataSource that hands out the same buffer of a given format on every pull, so the normalizers
+ * can be driven synchronously.
+ */
+class NormalizerBenchmarkSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+    int format;
+
+    NormalizerBenchmarkSource(int format) : buffer(NORMALIZER_BENCHMARK_SAMPLES * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format))
+    {
+        this->format = format;
+
+        // A full scale ramp, with a small offset and some noise.
+        for (int i = 0; i < NORMALIZER_BENCHMARK_SAMPLES; i++)
+        {
+            int v = (i * 65536 / NORMALIZER_BENCHMARK_SAMPLES) - 32768 + (int)uBit.random(256);
+
+            if (format == DATASTREAM_FORMAT_16BIT_SIGNED || format == DATASTREAM_FORMAT_16BIT_UNSIGNED)
+                ((uint16_t *)&buffer[0])[i] = (uint16_t)(format == DATASTREAM_FORMAT_16BIT_UNSIGNED ? v + 32768 : v);
+            else
+                buffer[i] = (uint8_t)(format == DATASTREAM_FORMAT_8BIT_UNSIGNED ? (v >> 8) + 128 : v >> 8);
+        }
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return format;
+    }
+};
+
+/**
+ * Measures the mean cost of pulling a buffer through the given source, in hundredths of a cycle per sample.
+ */
+static int
+normalizer_benchmark_cost(DataSource &source)
+{
+    uint32_t start = cycle_counter_read();
+
+    for (int i = 0; i < NORMALIZER_BENCHMARK_ITERATIONS; i++)
+        source.pull();
+
+    return (int)((uint64_t)(cycle_counter_read() - start) * 100 / (NORMALIZER_BENCHMARK_ITERATIONS * NORMALIZER_BENCHMARK_SAMPLES));
+}
+
+/**
+ * Determines the largest difference between two buffers of samples of the given format.
+ */
+static int
+normalizer_benchmark_difference(ManagedBuffer a, ManagedBuffer b, int format)
+{
+    int bytes = DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format);
+    int worst = 0;
+
+    for (int i = 0; i < a.length() / bytes; i++)
+    {
+        int x = bytes == 2 ? ((uint16_t *)&a[0])[i] : a[i];
+        int y = bytes == 2 ? ((uint16_t *)&b[0])[i] : b[i];
+
+        worst = max(worst, abs(x - y));
+    }
+
+    return worst;
+}
+
+/**
+ * Compares the cost of the StreamNormalizer against the floating point and fixed point paths of the
+ * FixedPointNormalizer, for the common format conversions. Results are written to DMESG in cycles per sample,
+ * with the largest difference of each path from the first buffer the StreamNormalizer produces. The ramp is
+ * full scale, so conversions with gain clip, and the difference there includes how each handles clipping.
+ */
+void
+fixed_point_normalizer_benchmark()
+{
+    static const int conversions[][3] = {
+        // Input format, output format, and gain * 1000.
+        {DATASTREAM_FORMAT_16BIT_SIGNED, DATASTREAM_FORMAT_8BIT_SIGNED, 50},
+        {DATASTREAM_FORMAT_16BIT_SIGNED, DATASTREAM_FORMAT_16BIT_SIGNED, 1000},
+        {DATASTREAM_FORMAT_16BIT_UNSIGNED, DATASTREAM_FORMAT_16BIT_UNSIGNED, 1000},
+        {DATASTREAM_FORMAT_8BIT_UNSIGNED, DATASTREAM_FORMAT_16BIT_UNSIGNED, 4000},
+        {DATASTREAM_FORMAT_8BIT_SIGNED, DATASTREAM_FORMAT_16BIT_SIGNED, 256000},
+    };
+
+    cycle_counter_enable();
+
+    DMESG("FIXED_POINT_NORMALIZER_BENCHMARK: %d samples x %d buffers (cycles/sample x 100)", NORMALIZER_BENCHMARK_SAMPLES, NORMALIZER_BENCHMARK_ITERATIONS);
+
+    for (unsigned int c = 0; c < sizeof(conversions) / sizeof(conversions[0]); c++)
+    {
+        float gain = conversions[c][2] / 1000.0f;
+
+        for (int normalize = 0; normalize < 2; normalize++)
+        {
+            // Each normalizer's first buffer is kept before timing, so all three start from the same zero offset.
+            NormalizerBenchmarkSource source(conversions[c][0]);
+            StreamNormalizer original(source, gain, normalize, conversions[c][1]);
+            ManagedBuffer reference = original.pull();
+            int originalCost = normalizer_benchmark_cost(original);
+
+            FixedPointNormalizer normalizer(source, gain, normalize, conversions[c][1]);
+            ManagedBuffer fixed = normalizer.pull();
+            int fixedCost = normalizer_benchmark_cost(normalizer);
+
+            FixedPointNormalizer floatNormalizer(source, gain, normalize, conversions[c][1]);
+            floatNormalizer.setFixedPoint(false);
+            ManagedBuffer floating = floatNormalizer.pull();
+            int floatCost = normalizer_benchmark_cost(floatNormalizer);
+
+            DMESG("   FORMAT %d -> %d GAIN %d/1000%s: STREAM_NORMALIZER %d FLOAT %d FIXED %d (MAX DIFFERENCE FROM STREAM_NORMALIZER: FLOAT %d FIXED %d)",
+                conversions[c][0], conversions[c][1], conversions[c][2], normalize ? " NORMALIZED" : "",
+                originalCost, floatCost, fixedCost,
+                normalizer_benchmark_difference(floating, reference, conversions[c][1]),
+                normalizer_benchmark_difference(fixed, reference, conversions[c][1]));
+        }
+    }
+}
+
+/**
+ * A DataSource that hands out the same triangle wave on every pull, of the given amplitude about the given
+ * centre, so the output never needs to clip.
+ */
+class NormalizerTestSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+    int format;
+
+    NormalizerTestSource(int format, int centre, int amplitude) : buffer(NORMALIZER_BENCHMARK_SAMPLES * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format))
+    {
+        this->format = format;
+
+        for (int i = 0; i < NORMALIZER_BENCHMARK_SAMPLES; i++)
+        {
+            int phase = i % 64;
+            int v = centre + amplitude * (phase < 32 ? phase - 16 : 48 - phase) / 16;
+
+            if (DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format) == 2)
+                ((uint16_t *)&buffer[0])[i] = (uint16_t)v;
+            else
+                buffer[i] = (uint8_t)v;
+        }
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return format;
+    }
+};
+
+/**
+ * Checks that both paths of the FixedPointNormalizer produce the same output as the StreamNormalizer, to
+ * within one LSB, for the configurations the microphone and speaker samples use, over several buffers so the
+ * zero offsets are compared as they settle. Results are written to DMESG.
+ */
+void
+fixed_point_normalizer_test()
+{
+    static const int configurations[][7] = {
+        // Input format, output format, gain * 1000, normalize, stabilisation, input centre and amplitude.
+        {DATASTREAM_FORMAT_16BIT_SIGNED, DATASTREAM_FORMAT_8BIT_SIGNED, 50, 1, 1, 300, 2000},                // mems_mic_test
+        {DATASTREAM_FORMAT_16BIT_SIGNED, DATASTREAM_FORMAT_UNKNOWN, 1000, 1, 10, 300, 8000},                 // mems_clap_test_spl
+        {DATASTREAM_FORMAT_16BIT_UNSIGNED, DATASTREAM_FORMAT_16BIT_UNSIGNED, 1000, 0, 1, 512, 400},          // synthesizer_test
+        {DATASTREAM_FORMAT_8BIT_UNSIGNED, DATASTREAM_FORMAT_16BIT_UNSIGNED, 4000, 0, 1, 128, 100},           // speaker_test
+    };
+    const int buffers = 8;
+    int failures = 0;
+
+    DMESG("FIXED_POINT_NORMALIZER_TEST: STARTING...");
+
+    for (unsigned int c = 0; c < sizeof(configurations) / sizeof(configurations[0]); c++)
+    {
+        const int *config = configurations[c];
+        float gain = config[2] / 1000.0f;
+        int outputFormat = config[1] == DATASTREAM_FORMAT_UNKNOWN ? config[0] : config[1];
+
+        NormalizerTestSource source(config[0], config[5], config[6]);
+        StreamNormalizer original(source, gain, config[3], config[1], config[4]);
+        FixedPointNormalizer fixed(source, gain, config[3], config[1], config[4]);
+        FixedPointNormalizer floating(source, gain, config[3], config[1], config[4]);
+
+        original.setOrMask(outputFormat == DATASTREAM_FORMAT_16BIT_UNSIGNED ? 0x8000 : 0);
+        fixed.setOrMask(outputFormat == DATASTREAM_FORMAT_16BIT_UNSIGNED ? 0x8000 : 0);
+        floating.setOrMask(outputFormat == DATASTREAM_FORMAT_16BIT_UNSIGNED ? 0x8000 : 0);
+        floating.setFixedPoint(false);
+
+        int worstFixed = 0;
+        int worstFloat = 0;
+
+        for (int b = 0; b < buffers; b++)
+        {
+            ManagedBuffer reference = original.pull();
+
+            worstFixed = max(worstFixed, normalizer_benchmark_difference(fixed.pull(), reference, outputFormat));
+            worstFloat = max(worstFloat, normalizer_benchmark_difference(floating.pull(), reference, outputFormat));
+        }
+
+        if (worstFixed > 1 || worstFloat > 1)
+            failures++;
+
+        DMESG("   FORMAT %d -> %d GAIN %d/1000%s: MAX DIFFERENCE FROM STREAM_NORMALIZER: FLOAT %d FIXED %d",
+            config[0], outputFormat, config[2], config[3] ? " NORMALIZED" : "", worstFloat, worstFixed);
+    }
+
+    DMESG("   RESULTS: %s", failures == 0 ? "PASS" : "FAIL");
+}
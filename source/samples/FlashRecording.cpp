@@ -0,0 +1,563 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "FlashRecording.h"
+#include "BufferPool.h"
+
+// A block never spans two pages, so every page also starts with a header.
+static_assert(FLASH_RECORDING_PAGE_SIZE % FLASH_RECORDING_BLOCK_SIZE == 0, "FLASH_RECORDING_BLOCK_SIZE must divide the page size");
+
+/**
+ * Converts a raw sample into a 16 bit signed value, and back again.
+ */
+static inline int flash_recording_sample(int8_t s) { return s << 8; }
+static inline int flash_recording_sample(uint8_t s) { return ((int)s - 128) << 8; }
+static inline int flash_recording_sample(int16_t s) { return s; }
+static inline int flash_recording_sample(uint16_t s) { return (int)s - 32768; }
+
+static inline void flash_recording_store(int8_t *p, int v) { *p = v >> 8; }
+static inline void flash_recording_store(uint8_t *p, int v) { *p = (v >> 8) + 128; }
+static inline void flash_recording_store(int16_t *p, int v) { *p = v; }
+static inline void flash_recording_store(uint16_t *p, int v) { *p = v + 32768; }
+
+/**
+ * Writes a single word to (erased) flash.
+ * Interrupts are held off for the duration, as the CPU cannot fetch from flash while the NVMC is busy anyway.
+ */
+static void flash_recording_write(uint32_t *address, uint32_t value)
+{
+    target_disable_irq();
+
+    NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Wen << NVMC_CONFIG_WEN_Pos);
+    *address = value;
+    while (NRF_NVMC->READY == NVMC_READY_READY_Busy);
+    NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos);
+
+    target_enable_irq();
+}
+
+/**
+ * Applies one partial erase slice of FLASH_RECORDING_ERASE_SLICE_MS to the given page.
+ * Interrupts are held off only for the slice, so any that fell due during it are serviced before the next.
+ */
+static void flash_recording_erase_slice(uint32_t address)
+{
+    target_disable_irq();
+
+    NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Een << NVMC_CONFIG_WEN_Pos);
+    NRF_NVMC->ERASEPAGEPARTIALCFG = FLASH_RECORDING_ERASE_SLICE_MS;
+    NRF_NVMC->ERASEPAGEPARTIAL = address;
+    while (NRF_NVMC->READY == NVMC_READY_READY_Busy);
+    NRF_NVMC->CONFIG = (NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos);
+
+    target_enable_irq();
+}
+
+/**
+ * Creates a FlashStreamRecording attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to record.
+ * @param address the start of the flash region to record into. Must be page aligned.
+ * @param pages the size of the flash region, in FLASH_RECORDING_PAGE_SIZE pages. At least FLASH_RECORDING_ERASE_AHEAD + 1.
+ * @param encoding RECORDING_ENCODING_ADPCM (default) or RECORDING_ENCODING_PCM.
+ * @param circular if true, record until stopped, keeping the most recent audio. Otherwise stop when the region is full.
+ */
+FlashStreamRecording::FlashStreamRecording(DataSource &source, uint32_t address, int pages, int encoding, bool circular) : CodalComponent(DEVICE_ID_FLASH_RECORDING, 0), upstream(source)
+{
+    this->downstream = NULL;
+    this->address = address;
+    this->encoding = encoding;
+    this->circular = circular;
+    this->format = source.getFormat();
+    this->sampleRate = source.getSampleRate();
+    this->state = COMPRESSED_RECORDING_STOPPED;
+
+    // A region that is misaligned or too small cannot be recorded into.
+    this->pages = (address % FLASH_RECORDING_PAGE_SIZE || pages <= FLASH_RECORDING_ERASE_AHEAD) ? 0 : pages;
+
+    erase();
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Determines the address in flash of the given position in the recording.
+ */
+uint32_t *
+FlashStreamRecording::flashAddress(uint32_t position)
+{
+    return (uint32_t *)(address + position % (pages * FLASH_RECORDING_PAGE_SIZE));
+}
+
+/**
+ * Determines the position of the oldest data still held in flash.
+ */
+uint32_t
+FlashStreamRecording::oldestPosition()
+{
+    // Erasing page n of the recording destroys page (n - pages), so a page is lost as soon as its erase starts.
+    uint32_t destroyed = erasedPages + (eraseElapsed ? 1 : 0);
+
+    return destroyed > (uint32_t)pages ? (destroyed - pages) * FLASH_RECORDING_PAGE_SIZE : 0;
+}
+
+/**
+ * Applies up to FLASH_RECORDING_ERASE_SLICES slices of erase to the next pages, as they are needed.
+ */
+void
+FlashStreamRecording::eraseAhead()
+{
+    for (int i = 0; i < FLASH_RECORDING_ERASE_SLICES; i++)
+    {
+        if (erasedPages * FLASH_RECORDING_PAGE_SIZE >= written + FLASH_RECORDING_ERASE_AHEAD * FLASH_RECORDING_PAGE_SIZE)
+            return;
+
+        if (!circular && erasedPages >= (uint32_t)pages)
+            return;
+
+        flash_recording_erase_slice((uint32_t)flashAddress(erasedPages * FLASH_RECORDING_PAGE_SIZE));
+        eraseElapsed += FLASH_RECORDING_ERASE_SLICE_MS;
+
+        if (eraseElapsed >= FLASH_RECORDING_ERASE_TIME_MS)
+        {
+            erasedPages++;
+            eraseElapsed = 0;
+        }
+    }
+}
+
+/**
+ * Appends a byte to the recording, writing a word to flash each time four bytes are ready.
+ * @return false if the byte was dropped because the next page is not yet erased.
+ */
+bool
+FlashStreamRecording::writeByte(uint8_t b)
+{
+    if (wordBytes == 0)
+        word = 0xFFFFFFFF;
+
+    word &= ~(0xFF << (wordBytes * 8));
+    word |= b << (wordBytes * 8);
+
+    if (++wordBytes < 4)
+        return true;
+
+    wordBytes = 0;
+
+    int space = written % FLASH_RECORDING_BLOCK_SIZE == 0 ? 8 : 4;
+
+    // Never wait for an erase: if it has fallen behind, drop the word. The decoder picks up again at the next block header.
+    if (written + space > erasedPages * FLASH_RECORDING_PAGE_SIZE)
+    {
+        dropped += 4;
+        return false;
+    }
+
+    if (space == 8)
+    {
+        flash_recording_write(flashAddress(written), wordState);
+        written += FLASH_RECORDING_HEADER_SIZE;
+    }
+
+    flash_recording_write(flashAddress(written), word);
+    written += 4;
+
+    if (!circular && written >= (uint32_t)pages * FLASH_RECORDING_PAGE_SIZE)
+        stop();
+
+    return true;
+}
+
+/**
+ * Provide the next block of the recording to our downstream caller, read back from flash.
+ */
+ManagedBuffer
+FlashStreamRecording::pull()
+{
+    if (state != COMPRESSED_RECORDING_PLAYING || readPosition >= recorded)
+    {
+        stop();
+        return ManagedBuffer();
+    }
+
+    if (readPosition % FLASH_RECORDING_BLOCK_SIZE == 0)
+    {
+        uint32_t header = *flashAddress(readPosition);
+        codec.reset((int16_t)(header & 0xFFFF), (header >> 16) & 0xFF);
+        readPosition += FLASH_RECORDING_HEADER_SIZE;
+    }
+
+    int len = min((int)(recorded - readPosition), FLASH_RECORDING_BLOCK_SIZE - (int)(readPosition % FLASH_RECORDING_BLOCK_SIZE));
+
+    const uint8_t *in = (const uint8_t *)flashAddress(readPosition);
+    ManagedBuffer out;
+
+    readPosition += len;
+
+    if (encoding == RECORDING_ENCODING_PCM)
+    {
+        out = ManagedBuffer((uint8_t *)in, len);
+    }
+    else
+    {
+        switch (format)
+        {
+            case DATASTREAM_FORMAT_8BIT_SIGNED:
+                out = decodeBlock<int8_t>(in, len);
+                break;
+
+            case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+                out = decodeBlock<uint8_t>(in, len);
+                break;
+
+            case DATASTREAM_FORMAT_16BIT_SIGNED:
+                out = decodeBlock<int16_t>(in, len);
+                break;
+
+            case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+                out = decodeBlock<uint16_t>(in, len);
+                break;
+        }
+    }
+
+    // Keep our downstream pulling. Once the recording is exhausted, the next (empty) pull stops playback.
+    if (downstream)
+        downstream->pullRequest();
+
+    return out;
+}
+
+/**
+ * Decodes the given stored bytes into a new buffer of type T samples.
+ */
+template <typename T> ManagedBuffer
+FlashStreamRecording::decodeBlock(const uint8_t *in, int len)
+{
+    ManagedBuffer out = buffer_pool_allocate(len * 2 * sizeof(T));
+    T *p = (T *)&out[0];
+    const uint8_t *end = in + len;
+
+    while (in < end)
+    {
+        uint8_t b = *in++;
+
+        flash_recording_store(p++, codec.decode(b & 0x0F));
+        flash_recording_store(p++, codec.decode(b >> 4));
+    }
+
+    return out;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+FlashStreamRecording::pullRequest()
+{
+    if (state != COMPRESSED_RECORDING_RECORDING)
+        return DEVICE_BUSY;
+
+    ManagedBuffer buf = upstream.pull();
+
+    switch (format)
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            recordBuffer<int8_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            recordBuffer<uint8_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            recordBuffer<int16_t>(buf);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            recordBuffer<uint16_t>(buf);
+            break;
+
+        default:
+            stop();
+            return DEVICE_NOT_SUPPORTED;
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Appends the given buffer, interpreted as type T, to the recording.
+ */
+template <typename T> void
+FlashStreamRecording::recordBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    T *end = p + buf.length() / sizeof(T);
+
+    samples += end - p;
+
+    if (encoding == RECORDING_ENCODING_PCM)
+    {
+        uint8_t *b = (uint8_t *)p;
+
+        while (b < (uint8_t *)end && state == COMPRESSED_RECORDING_RECORDING)
+            writeByte(*b++);
+
+        return;
+    }
+
+    // Samples are encoded in pairs, so the block header can always record the state before a whole byte.
+    while (p < end && state == COMPRESSED_RECORDING_RECORDING)
+    {
+        int s = flash_recording_sample(*p++);
+
+        if (!hasPending)
+        {
+            pending = s;
+            hasPending = true;
+            continue;
+        }
+
+        hasPending = false;
+
+        // Capture the state before the pair, in case this byte begins a new block.
+        if (wordBytes == 0)
+            wordState = (FLASH_RECORDING_HEADER_MARKER << 24) | (codec.index << 16) | (uint16_t)codec.predictor;
+
+        uint8_t lo = codec.encode(pending);
+        uint8_t hi = codec.encode(s);
+
+        writeByte(lo | (hi << 4));
+    }
+}
+
+/**
+ * Periodic callback from the scheduler, used to erase pages ahead of the write pointer.
+ */
+void
+FlashStreamRecording::periodicCallback()
+{
+    if (state == COMPRESSED_RECORDING_RECORDING)
+        eraseAhead();
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+FlashStreamRecording::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+FlashStreamRecording::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+FlashStreamRecording::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the recording, which is that of the upstream when it was recorded.
+ */
+int
+FlashStreamRecording::getFormat()
+{
+    return format;
+}
+
+/**
+ * Determines the sample rate of the recording, which is that of the upstream when it was recorded.
+ */
+float
+FlashStreamRecording::getSampleRate()
+{
+    return sampleRate;
+}
+
+/**
+ * Starts recording in the background, discarding any previous recording.
+ * The first page is erased before this returns.
+ */
+void
+FlashStreamRecording::recordAsync()
+{
+    erase();
+
+    if (pages == 0)
+        return;
+
+    format = upstream.getFormat();
+    sampleRate = upstream.getSampleRate();
+    wordState = FLASH_RECORDING_HEADER_MARKER << 24;
+    codec.reset();
+
+    while (erasedPages == 0)
+        eraseAhead();
+
+    state = COMPRESSED_RECORDING_RECORDING;
+    status |= DEVICE_COMPONENT_STATUS_SYSTEM_TICK;
+}
+
+/**
+ * Records until the region is full, or stop() is called from another fiber.
+ */
+void
+FlashStreamRecording::record()
+{
+    recordAsync();
+
+    while (isRecording())
+        fiber_sleep(5);
+}
+
+/**
+ * Starts playing the recording in the background, from the oldest audio held.
+ */
+void
+FlashStreamRecording::playAsync()
+{
+    stop();
+
+    readPosition = oldestPosition();
+    state = COMPRESSED_RECORDING_PLAYING;
+
+    if (downstream)
+        downstream->pullRequest();
+}
+
+/**
+ * Plays the recording, returning when playback is complete or stop() is called from another fiber.
+ */
+void
+FlashStreamRecording::play()
+{
+    playAsync();
+
+    while (isPlaying())
+        fiber_sleep(5);
+}
+
+/**
+ * Stops any recording or playback in progress. The recording is retained.
+ */
+void
+FlashStreamRecording::stop()
+{
+    if (state == COMPRESSED_RECORDING_RECORDING)
+    {
+        // Flush any partial word, padded with erased bytes, if there is room for it.
+        int valid = wordBytes;
+
+        if (wordBytes)
+        {
+            wordBytes = 3;
+            valid = writeByte(0xFF) ? valid : 0;
+        }
+
+        recorded = written - (valid ? 4 - valid : 0);
+        status &= ~DEVICE_COMPONENT_STATUS_SYSTEM_TICK;
+    }
+
+    state = COMPRESSED_RECORDING_STOPPED;
+}
+
+/**
+ * Stops any recording or playback in progress, and discards the recording.
+ * Flash is erased lazily, when the next recording starts.
+ */
+void
+FlashStreamRecording::erase()
+{
+    stop();
+
+    written = 0;
+    recorded = 0;
+    erasedPages = 0;
+    eraseElapsed = 0;
+    readPosition = 0;
+    wordBytes = 0;
+    hasPending = false;
+    samples = 0;
+    dropped = 0;
+}
+
+/**
+ * Determines if a recording is in progress.
+ */
+bool
+FlashStreamRecording::isRecording()
+{
+    return state == COMPRESSED_RECORDING_RECORDING;
+}
+
+/**
+ * Determines if playback is in progress.
+ */
+bool
+FlashStreamRecording::isPlaying()
+{
+    return state == COMPRESSED_RECORDING_PLAYING;
+}
+
+/**
+ * Determines if the component is neither recording nor playing.
+ */
+bool
+FlashStreamRecording::isStopped()
+{
+    return state == COMPRESSED_RECORDING_STOPPED;
+}
+
+/**
+ * Determines the number of samples recorded (including any since overwritten in circular mode).
+ */
+uint32_t
+FlashStreamRecording::getSampleCount()
+{
+    return samples;
+}
+
+/**
+ * Determines the number of input bytes dropped because the erase had not kept ahead of the recording.
+ */
+uint32_t
+FlashStreamRecording::getDroppedBytes()
+{
+    return dropped;
+}
@@ -0,0 +1,241 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+#include "ImaAdpcm.h"
+#include "CompressedRecording.h"
+#include "nrf.h"
+
+#ifndef FLASH_RECORDING_H
+#define FLASH_RECORDING_H
+
+#define DEVICE_ID_FLASH_RECORDING 9012
+
+#define FLASH_RECORDING_PAGE_SIZE           4096
+
+// Number of erased pages kept ready ahead of the write pointer.
+#define FLASH_RECORDING_ERASE_AHEAD         2
+
+// Pages are erased in slices of ERASEPAGEPARTIAL, a few per system tick. The slices for a page must add up to at
+// least the full page erase time.
+//
+// The CPU stalls for the whole of each slice, whatever the interrupt mask, as flash cannot be read while it is
+// being erased, so every interrupt is delayed by up to one slice. That includes the PWM and the microphone
+// refilling their DMA buffers. Both are double buffered, so each can ride out a stall shorter than one of its
+// buffers (5.8ms for 256 samples at 44.1kHz). Slices are kept to the 1ms minimum, with interrupts serviced
+// between them, so a stall is well within that. Two per tick erase as fast as one 2ms slice did.
+#define FLASH_RECORDING_ERASE_SLICE_MS      1
+#define FLASH_RECORDING_ERASE_SLICES        2
+#define FLASH_RECORDING_ERASE_TIME_MS       90
+
+// Every block of this many stored bytes begins with a header word holding the ADPCM state, so playback can
+// start from any block, and a word dropped while recording corrupts at most the rest of its block.
+// Each pull during playback decodes at most one block.
+#define FLASH_RECORDING_BLOCK_SIZE          128
+#define FLASH_RECORDING_HEADER_SIZE         4
+#define FLASH_RECORDING_HEADER_MARKER       0xA5
+
+/**
+ * A StreamRecording alternative that spills its input into a ring of internal flash pages as it records,
+ * for recordings far longer than the available heap. Only a few words of RAM are used for buffering.
+ *
+ * Pages are erased in the background ahead of the write pointer, using partial erases on each system tick,
+ * so capture never waits on an erase. If the erase falls behind, input is dropped and counted instead.
+ * In circular mode, recording continues indefinitely, and the oldest pages are overwritten.
+ *
+ * Flash is written directly through the NVMC, so this must not be used while the SoftDevice is enabled,
+ * and the region given must not overlap the program or any other flash storage.
+ */
+class FlashStreamRecording : public CodalComponent, public DataSource, public DataSink
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    uint32_t        address;            // Start of the flash region.
+    int             pages;              // Size of the flash region, in pages.
+    int             encoding;
+    bool            circular;
+    int             format;             // Format of the upstream when recorded.
+    float           sampleRate;         // Sample rate of the upstream when recorded.
+    int             state;
+
+    uint32_t        written;            // Bytes written since recording started (including block headers).
+    uint32_t        recorded;           // Bytes of valid data, once recording has stopped.
+    uint32_t        erasedPages;        // Pages erased since recording started.
+    int             eraseElapsed;       // Milliseconds of partial erase applied to the next page.
+    uint32_t        readPosition;       // Playback position, in the same units as written.
+    uint32_t        word;               // Bytes waiting to be written as a whole word.
+    int             wordBytes;
+    uint32_t        wordState;          // ADPCM state before the first byte of the word, for the block header.
+    int             pending;            // ADPCM sample waiting for its pair.
+    bool            hasPending;
+    uint32_t        samples;
+    uint32_t        dropped;
+    ImaAdpcm        codec;
+
+    /**
+     * Appends the given buffer, interpreted as type T, to the recording.
+     */
+    template <typename T> void recordBuffer(ManagedBuffer &buf);
+
+    /**
+     * Decodes the given stored bytes into a new buffer of type T samples.
+     */
+    template <typename T> ManagedBuffer decodeBlock(const uint8_t *in, int len);
+
+    /**
+     * Appends a byte to the recording, writing a word to flash each time four bytes are ready.
+     * @return false if the byte was dropped because the next page is not yet erased.
+     */
+    bool writeByte(uint8_t b);
+
+    /**
+     * Applies up to FLASH_RECORDING_ERASE_SLICES slices of erase to the next pages, as they are needed.
+     */
+    void eraseAhead();
+
+    /**
+     * Determines the address in flash of the given position in the recording.
+     */
+    uint32_t *flashAddress(uint32_t position);
+
+    /**
+     * Determines the position of the oldest data still held in flash.
+     */
+    uint32_t oldestPosition();
+
+    public:
+    /**
+     * Creates a FlashStreamRecording attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to record.
+     * @param address the start of the flash region to record into. Must be page aligned.
+     * @param pages the size of the flash region, in FLASH_RECORDING_PAGE_SIZE pages. At least FLASH_RECORDING_ERASE_AHEAD + 1.
+     * @param encoding RECORDING_ENCODING_ADPCM (default) or RECORDING_ENCODING_PCM.
+     * @param circular if true, record until stopped, keeping the most recent audio. Otherwise stop when the region is full.
+     */
+    FlashStreamRecording(DataSource &source, uint32_t address, int pages, int encoding = RECORDING_ENCODING_ADPCM, bool circular = false);
+
+    /**
+     * Provide the next block of the recording to our downstream caller, read back from flash.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Periodic callback from the scheduler, used to erase pages ahead of the write pointer.
+     */
+    virtual void periodicCallback();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the recording, which is that of the upstream when it was recorded.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the recording, which is that of the upstream when it was recorded.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Starts recording in the background, discarding any previous recording.
+     * The first page is erased before this returns.
+     */
+    void recordAsync();
+
+    /**
+     * Records until the region is full, or stop() is called from another fiber.
+     */
+    void record();
+
+    /**
+     * Starts playing the recording in the background, from the oldest audio held.
+     */
+    void playAsync();
+
+    /**
+     * Plays the recording, returning when playback is complete or stop() is called from another fiber.
+     */
+    void play();
+
+    /**
+     * Stops any recording or playback in progress. The recording is retained.
+     */
+    void stop();
+
+    /**
+     * Stops any recording or playback in progress, and discards the recording.
+     * Flash is erased lazily, when the next recording starts.
+     */
+    void erase();
+
+    /**
+     * Determines if a recording is in progress.
+     */
+    bool isRecording();
+
+    /**
+     * Determines if playback is in progress.
+     */
+    bool isPlaying();
+
+    /**
+     * Determines if the component is neither recording nor playing.
+     */
+    bool isStopped();
+
+    /**
+     * Determines the number of samples recorded (including any since overwritten in circular mode).
+     */
+    uint32_t getSampleCount();
+
+    /**
+     * Determines the number of input bytes dropped because the erase had not kept ahead of the recording.
+     */
+    uint32_t getDroppedBytes();
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+
+#ifndef IMA_ADPCM_H
+#define IMA_ADPCM_H
+
+#define IMA_ADPCM_MAX_INDEX 88
+
+extern const int16_t ima_adpcm_step_table[IMA_ADPCM_MAX_INDEX + 1];
+extern const int8_t ima_adpcm_index_table[16];
+
+/**
+ * State of a 4 bit IMA-ADPCM encoder or decoder, as defined by the IMA Digital Audio Focus
+ * and Technical Working Groups. Each 16 bit sample is coded as a 4 bit difference from a
+ * prediction, with an adaptive step size.
+ */
+class ImaAdpcm
+{
+    public:
+    int             predictor;          // The previous (decoded) sample.
+    int             index;              // Index into the step size table.
+
+    /**
+     * Creates a codec with the given initial state.
+     */
+    ImaAdpcm(int predictor = 0, int index = 0)
+    {
+        reset(predictor, index);
+    }
+
+    /**
+     * Resets the codec state, typically from a resync header.
+     */
+    void reset(int predictor = 0, int index = 0)
+    {
+        this->predictor = predictor;
+        this->index = index < 0 ? 0 : index > IMA_ADPCM_MAX_INDEX ? IMA_ADPCM_MAX_INDEX : index;
+    }
+
+    /**
+     * Encodes a single 16 bit signed sample.
+     * @return the 4 bit code for the sample.
+     */
+    inline uint8_t encode(int sample)
+    {
+        int step = ima_adpcm_step_table[index];
+        int diff = sample - predictor;
+        uint8_t code = 0;
+
+        if (diff < 0)
+        {
+            code = 8;
+            diff = -diff;
+        }
+
+        // Successive approximation of diff / step, mirroring the decoder exactly.
+        int delta = step >> 3;
+
+        if (diff >= step)
+        {
+            code |= 4;
+            diff -= step;
+            delta += step;
+        }
+        step >>= 1;
+        if (diff >= step)
+        {
+            code |= 2;
+            diff -= step;
+            delta += step;
+        }
+        step >>= 1;
+        if (diff >= step)
+        {
+            code |= 1;
+            delta += step;
+        }
+
+        update(code, delta);
+
+        return code;
+    }
+
+    /**
+     * Decodes a single 4 bit code.
+     * @return the 16 bit signed sample.
+     */
+    inline int decode(uint8_t code)
+    {
+        int step = ima_adpcm_step_table[index];
+        int delta = step >> 3;
+
+        if (code & 4)
+            delta += step;
+        if (code & 2)
+            delta += step >> 1;
+        if (code & 1)
+            delta += step >> 2;
+
+        update(code, delta);
+
+        return predictor;
+    }
+
+    private:
+    inline void update(uint8_t code, int delta)
+    {
+        predictor += (code & 8) ? -delta : delta;
+
+        if (predictor > 32767)
+            predictor = 32767;
+        else if (predictor < -32768)
+            predictor = -32768;
+
+        index += ima_adpcm_index_table[code & 0x0F];
+
+        if (index < 0)
+            index = 0;
+        else if (index > IMA_ADPCM_MAX_INDEX)
+            index = IMA_ADPCM_MAX_INDEX;
+    }
+};
+
+#endif
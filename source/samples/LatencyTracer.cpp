@@ -0,0 +1,317 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LatencyTracer.h"
+#include "nrf.h"
+#include "Tests.h"
+
+/**
+ * Creates a LatencyProbe attached to the given source.
+ * The output is the input, unchanged.
+ *
+ * @param source the DataSource to measure.
+ * @param tracer the tracer shared by the probes of the pipeline.
+ * @param name the name reported for this stage.
+ * @param origin true if this is the first probe of the pipeline, where buffers are timestamped.
+ */
+LatencyProbe::LatencyProbe(DataSource &source, LatencyTracer &tracer, const char *name, bool origin) : upstream(source), tracer(tracer)
+{
+    this->downstream = NULL;
+    this->name = name;
+    this->origin = origin;
+    this->samples = 0;
+
+    reset();
+
+    if (tracer.probeCount < LATENCY_TRACER_MAX_PROBES)
+        tracer.probes[tracer.probeCount++] = this;
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller.
+ */
+ManagedBuffer
+LatencyProbe::pull()
+{
+    uint32_t now = (uint32_t)system_timer_current_time_us();
+    ManagedBuffer buf = origin ? buffer : upstream.pull();
+    int bytesPerSample = DATASTREAM_FORMAT_BYTES_PER_SAMPLE(getFormat());
+    uint32_t rate = (uint32_t)getSampleRate();
+    uint32_t captured;
+
+    if (bytesPerSample <= 0 || rate == 0 || buf.length() == 0)
+        return buf;
+
+    // The position of the first sample of this buffer, in samples at the origin rate.
+    uint32_t position = (uint32_t)((uint64_t)samples * (uint32_t)tracer.originRate / rate);
+
+    if (tracer.lookup(position, captured))
+        record(now - captured);
+    else
+        untraced++;
+
+    samples += buf.length() / bytesPerSample;
+
+    return buf;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+LatencyProbe::pullRequest()
+{
+    if (origin)
+    {
+        uint32_t now = (uint32_t)system_timer_current_time_us();
+        int bytesPerSample = DATASTREAM_FORMAT_BYTES_PER_SAMPLE(getFormat());
+        float rate = getSampleRate();
+
+        buffer = upstream.pull();
+
+        // The stage below may not take every buffer, so the position of each is taken from the stamp, not counted.
+        samples = tracer.originSamples;
+
+        if (bytesPerSample > 0 && rate > 0)
+        {
+            int n = buffer.length() / bytesPerSample;
+            tracer.stamp(n, rate, now - (uint32_t)(n * 1000000.0f / rate));
+        }
+    }
+
+    if (downstream)
+        return downstream->pullRequest();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Indicates whether our downstream component wants data. The probe is transparent, so this is passed upstream.
+ * @param wanted DATASTREAM_WANTED, DATASTREAM_NOT_WANTED or DATASTREAM_DONT_CARE.
+ */
+void
+LatencyProbe::dataWanted(int wanted)
+{
+    DataSource::dataWanted(wanted);
+    upstream.dataWanted(wanted);
+}
+
+/**
+ * Records the latency of a buffer whose first sample passed the origin at the given time.
+ */
+void
+LatencyProbe::record(uint32_t latency)
+{
+    uint32_t ms = latency / 1000;
+    int bucket = ms ? min(32 - (int)__CLZ(ms), LATENCY_TRACER_BUCKETS - 1) : 0;
+
+    histogram[bucket]++;
+    count++;
+    total += latency;
+
+    if (latency < minimum)
+        minimum = latency;
+
+    if (latency > maximum)
+        maximum = latency;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+LatencyProbe::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+LatencyProbe::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+LatencyProbe::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+LatencyProbe::getFormat()
+{
+    return upstream.getFormat();
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+LatencyProbe::getSampleRate()
+{
+    return upstream.getSampleRate();
+}
+
+/**
+ * Determines the mean latency measured at this probe, in microseconds, or 0 if nothing has been measured.
+ */
+uint32_t
+LatencyProbe::getMeanLatency()
+{
+    return count ? (uint32_t)(total / count) : 0;
+}
+
+/**
+ * Determines the largest latency measured at this probe, in microseconds.
+ */
+uint32_t
+LatencyProbe::getMaxLatency()
+{
+    return maximum;
+}
+
+/**
+ * Clears the histogram and statistics of this probe.
+ */
+void
+LatencyProbe::reset()
+{
+    memset(histogram, 0, sizeof(histogram));
+    count = 0;
+    untraced = 0;
+    minimum = 0xFFFFFFFF;
+    maximum = 0;
+    total = 0;
+}
+
+/**
+ * Creates an empty LatencyTracer. Probes add themselves as they are created.
+ */
+LatencyTracer::LatencyTracer()
+{
+    historyNext = 0;
+    historyCount = 0;
+    originSamples = 0;
+    originRate = 0;
+    probeCount = 0;
+}
+
+/**
+ * Records the capture time of the next buffer at the origin.
+ */
+void
+LatencyTracer::stamp(int samples, float rate, uint32_t time)
+{
+    // Stages that produce output of their own, such as a mixer, may have run before the first buffer
+    // arrived, so every probe counts from here.
+    if (originSamples == 0)
+    {
+        for (int p = 0; p < probeCount; p++)
+            if (!probes[p]->origin)
+                probes[p]->samples = 0;
+    }
+
+    historySample[historyNext] = originSamples;
+    historyTime[historyNext] = time;
+    historyNext = (historyNext + 1) % LATENCY_TRACER_HISTORY;
+    historyCount = min(historyCount + 1, LATENCY_TRACER_HISTORY);
+
+    originSamples += samples;
+    originRate = rate;
+}
+
+/**
+ * Finds the capture time of the given origin sample.
+ * @return true if the sample is in the history.
+ */
+bool
+LatencyTracer::lookup(uint32_t sample, uint32_t &time)
+{
+    // Samples the origin has not yet seen cannot be traced.
+    if ((int32_t)(sample - originSamples) >= 0)
+        return false;
+
+    // Search from the newest buffer back, for the one holding the sample.
+    for (int i = 1; i <= historyCount; i++)
+    {
+        int h = (historyNext - i + LATENCY_TRACER_HISTORY) % LATENCY_TRACER_HISTORY;
+
+        if ((int32_t)(sample - historySample[h]) >= 0)
+        {
+            time = historyTime[h];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Writes one line per probe to the serial port: the number of buffers measured, the minimum, mean and
+ * maximum latency in microseconds, and the histogram, in milliseconds.
+ */
+void
+LatencyTracer::print()
+{
+    for (int p = 0; p < probeCount; p++)
+    {
+        LatencyProbe *probe = probes[p];
+
+        uBit.serial.printf("%s: %d buffers, %d untraced, min %d mean %d max %d us |", probe->name, (int)probe->count, (int)probe->untraced,
+            probe->count ? (int)probe->minimum : 0, (int)probe->getMeanLatency(), (int)probe->maximum);
+
+        for (int b = 0; b < LATENCY_TRACER_BUCKETS; b++)
+        {
+            if (b == LATENCY_TRACER_BUCKETS - 1)
+                uBit.serial.printf(" >=%d:%d", 1 << (b - 1), (int)probe->histogram[b]);
+            else
+                uBit.serial.printf(" <%d:%d", 1 << b, (int)probe->histogram[b]);
+        }
+
+        uBit.serial.printf("\n");
+    }
+}
+
+/**
+ * Clears the histograms and statistics of every probe.
+ */
+void
+LatencyTracer::reset()
+{
+    for (int p = 0; p < probeCount; p++)
+        probes[p]->reset();
+}
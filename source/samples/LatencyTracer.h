@@ -0,0 +1,195 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef LATENCY_TRACER_H
+#define LATENCY_TRACER_H
+
+#define LATENCY_TRACER_HISTORY      32      // Origin buffers remembered, so downstream probes can find their timestamps.
+#define LATENCY_TRACER_MAX_PROBES   8
+
+// Histogram buckets: bucket 0 holds latencies under 1ms, bucket k those from 2^(k-1) to 2^k ms,
+// and the last bucket everything longer.
+#define LATENCY_TRACER_BUCKETS      12
+
+class LatencyTracer;
+
+/**
+ * A transparent DataSource and DataSink that measures how long after capture the buffers passing through
+ * it are consumed by the stage below, and keeps a histogram of the latencies.
+ *
+ * Probes are inserted between the stages of a pipeline and share a LatencyTracer. The origin probe, at
+ * the head of the pipeline, timestamps each buffer as it arrives, backdated by the buffer duration to the
+ * time its first sample was captured. The other probes count the samples that pass them, scaled by the
+ * ratio of sample rates, and look up when those samples passed the origin. This follows the audio
+ * through stages that copy or convert buffers, as long as no stage drops samples. Below the origin,
+ * counting starts with the first buffer stamped, so a probe after a stage that runs on its own, such as
+ * a mixer feeding an output, is aligned to within one of that stage's buffers, and stays aligned as long
+ * as the stage never runs dry.
+ *
+ * Buffers are measured as the stage below pulls them, so a probe's latency includes any time the buffer
+ * waited to be consumed, not only the time it took to arrive.
+ */
+class LatencyProbe : public DataSink, public DataSource
+{
+    friend class LatencyTracer;
+
+    DataSource      &upstream;
+    DataSink        *downstream;
+    LatencyTracer   &tracer;
+    const char      *name;
+    bool            origin;
+    ManagedBuffer   buffer;             // Buffer to be handed downstream on the next pull, at the origin.
+    uint32_t        samples;            // Samples passed since the first buffer was stamped. At the origin, the position of the held buffer.
+    uint32_t        histogram[LATENCY_TRACER_BUCKETS];
+    uint32_t        count;
+    uint32_t        untraced;           // Buffers too old, or too new, to find in the origin history.
+    uint32_t        minimum;            // Latencies, in microseconds.
+    uint32_t        maximum;
+    uint64_t        total;
+
+    /**
+     * Records the latency of a buffer whose first sample passed the origin at the given time.
+     */
+    void record(uint32_t latency);
+
+    public:
+    /**
+     * Creates a LatencyProbe attached to the given source.
+     * The output is the input, unchanged.
+     *
+     * @param source the DataSource to measure.
+     * @param tracer the tracer shared by the probes of the pipeline.
+     * @param name the name reported for this stage.
+     * @param origin true if this is the first probe of the pipeline, where buffers are timestamped.
+     */
+    LatencyProbe(DataSource &source, LatencyTracer &tracer, const char *name, bool origin = false);
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Indicates whether our downstream component wants data. The probe is transparent, so this is passed upstream.
+     * @param wanted DATASTREAM_WANTED, DATASTREAM_NOT_WANTED or DATASTREAM_DONT_CARE.
+     */
+    virtual void dataWanted(int wanted);
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Determines the mean latency measured at this probe, in microseconds, or 0 if nothing has been measured.
+     */
+    uint32_t getMeanLatency();
+
+    /**
+     * Determines the largest latency measured at this probe, in microseconds.
+     */
+    uint32_t getMaxLatency();
+
+    /**
+     * Clears the histogram and statistics of this probe.
+     */
+    void reset();
+};
+
+/**
+ * The timestamps and probes of one pipeline. Produces a latency report for every probe over serial.
+ */
+class LatencyTracer
+{
+    friend class LatencyProbe;
+
+    uint32_t        historySample[LATENCY_TRACER_HISTORY];     // Origin sample index of the first sample of each buffer.
+    uint32_t        historyTime[LATENCY_TRACER_HISTORY];       // Time that sample was captured, in microseconds.
+    int             historyNext;
+    int             historyCount;
+    uint32_t        originSamples;      // Samples passed the origin.
+    float           originRate;
+    LatencyProbe    *probes[LATENCY_TRACER_MAX_PROBES];
+    int             probeCount;
+
+    /**
+     * Records the capture time of the next buffer at the origin.
+     */
+    void stamp(int samples, float rate, uint32_t time);
+
+    /**
+     * Finds the capture time of the given origin sample.
+     * @return true if the sample is in the history.
+     */
+    bool lookup(uint32_t sample, uint32_t &time);
+
+    public:
+    /**
+     * Creates an empty LatencyTracer. Probes add themselves as they are created.
+     */
+    LatencyTracer();
+
+    /**
+     * Writes one line per probe to the serial port: the number of buffers measured, the minimum, mean and
+     * maximum latency in microseconds, and the histogram, in milliseconds.
+     */
+    void print();
+
+    /**
+     * Clears the histograms and statistics of every probe.
+     */
+    void reset();
+};
+
+#endif
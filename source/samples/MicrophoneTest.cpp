@@ -1,15 +1,23 @@
 #include "MicroBit.h"
 #include "SerialStreamer.h"
+#include "AdpcmSerialStreamer.h"
 #include "StreamNormalizer.h"
+#include "FixedPointNormalizer.h"
 #include "LevelDetector.h"
 #include "LevelDetectorSPL.h"
+#include "RmsLevelDetector.h"
+#include "OnsetDetector.h"
+#include "SpectrumAnalyser.h"
+#include "ActivityGate.h"
+#include "BiquadFilter.h"
+#include "AutomaticGainControl.h"
 #include "Tests.h"
 #include <stdio.h>
 
 static NRF52ADCChannel *mic = NULL;
 static SerialStreamer *streamer = NULL;
 static StreamNormalizer *processor = NULL;
-static LevelDetector *level = NULL;
+static OnsetDetector *onset = NULL;
 static LevelDetectorSPL *levelSPL = NULL;
 static int claps = 0;
 static volatile int sample;
@@ -31,6 +39,17 @@ onQuiet(MicroBitEvent)
     DMESG("QUIET");
 }
 
+static void
+onClap(MicroBitEvent e)
+{
+    DMESG("CLAP: %d", (int)e.timestamp);
+    claps++;
+    if (claps >= 10)
+        claps = 0;
+
+    uBit.display.print(claps);
+}
+
 void mems_mic_drift_test()
 {
     uBit.io.runmic.setDigitalValue(1);
@@ -70,21 +89,77 @@ mems_mic_test()
         uBit.sleep(1000);
 }
 
+// As mems_mic_test, but with the gain and zero offset applied by a FixedPointNormalizer.
+void
+mems_mic_fixed_point_test()
+{
+    if (mic == NULL){
+        mic = uBit.adc.getChannel(uBit.io.microphone);
+        mic->setGain(7,0);          // Uncomment for v1.47.2
+        //mic->setGain(7,1);        // Uncomment for v1.46.2
+    }
+
+    static FixedPointNormalizer *fixedProcessor = new FixedPointNormalizer(mic->output, 0.05f, true, DATASTREAM_FORMAT_8BIT_SIGNED);
+    static SerialStreamer *fixedStreamer = new SerialStreamer(fixedProcessor->output, SERIAL_STREAM_MODE_BINARY);
+    (void) fixedStreamer;
+
+    uBit.io.runmic.setDigitalValue(1);
+    uBit.io.runmic.setHighDrive(true);
+
+    while(1)
+        uBit.sleep(1000);
+}
+
+// As mems_mic_test, but with the gain set by an AutomaticGainControl rather than tuned per board.
+// The hardware and digital gains are written to DMESG every second.
+void
+mems_mic_agc_test()
+{
+    if (mic == NULL)
+        mic = uBit.adc.getChannel(uBit.io.microphone);
+
+    // Use a bias of 1 for v1.46.2.
+    static AutomaticGainControl *agc = new AutomaticGainControl(mic->output, mic, AGC_HARDWARE_MAX_GAIN, 0);
+    static FixedPointNormalizer *agcProcessor = new FixedPointNormalizer(*agc, 1.0f / 256, false, DATASTREAM_FORMAT_8BIT_SIGNED);
+    static SerialStreamer *agcStreamer = new SerialStreamer(agcProcessor->output, SERIAL_STREAM_MODE_BINARY);
+    (void) agcStreamer;
+
+    uBit.io.runmic.setDigitalValue(1);
+    uBit.io.runmic.setHighDrive(true);
+
+    while(1)
+    {
+        DMESG("AGC: HARDWARE %d DIGITAL %d (hundredths of a dB)", agc->getHardwareGain(), agc->getGain());
+        uBit.sleep(1000);
+    }
+}
+
+// Streams the microphone as 4 bit IMA-ADPCM. Decode on the host with utils/audio/adpcm_decode.py
+void
+mems_mic_adpcm_test()
+{
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    static AdpcmSerialStreamer *adpcmStreamer = new AdpcmSerialStreamer(*splitterChannel);
+    (void) adpcmStreamer;
+
+    while(1)
+        uBit.sleep(1000);
+}
+
 // WARNING! For this test to run correctly floats for printf/sprintf/snprintf
 // have to be enabled by adding this flag to the linker (target.json):
 // -u _printf_float
 void
 mems_mic_zero_offset_test()
 {
-    LevelDetectorSPL* levelSPL = new LevelDetectorSPL(uBit.audio.processor->output, 85.0, 65.0, 16.0, 0, DEVICE_ID_SYSTEM_LEVEL_DETECTOR);
+    // A connected level detector keeps the pipeline flowing, so it no longer needs to be polled.
+    static RmsLevelDetector *level = new RmsLevelDetector(uBit.audio.processor->output, 85.0, 65.0);
+    (void) level;
     uBit.audio.activateMic();
 
     char float_str[20];
-    volatile auto value = 0;
 
     while (true) {
-        value = levelSPL->getValue();
-        (void) value;
         snprintf(float_str, 80, "%.4f", uBit.audio.processor->zeroOffset);
         uBit.serial.printf("%s\n", float_str);
         uBit.sleep(1);
@@ -101,23 +176,19 @@ mems_clap_test(int wait_for_clap)
         mic->setGain(7,0);
     }
 
-    if (processor == NULL)
-        processor = new StreamNormalizer(mic->output, 1.0f, true, DATASTREAM_FORMAT_UNKNOWN, 10);
-
-    if (level == NULL)
-        level = new LevelDetector(processor->output, 150, 75);
+    // The onset detector works on the raw ADC stream: it removes DC itself, and measures relative rather than absolute levels.
+    if (onset == NULL)
+        onset = new OnsetDetector(mic->output);
 
     uBit.io.runmic.setDigitalValue(1);
     uBit.io.runmic.setHighDrive(true);
 
-    uBit.messageBus.listen(DEVICE_ID_SYSTEM_LEVEL_DETECTOR, LEVEL_THRESHOLD_HIGH, onLoud);
-    uBit.messageBus.listen(DEVICE_ID_SYSTEM_LEVEL_DETECTOR, LEVEL_THRESHOLD_LOW, onQuiet);
+    uBit.messageBus.listen(DEVICE_ID_ONSET_DETECTOR, ONSET_EVT_CLAP, onClap);
 
     while(!wait_for_clap || (wait_for_clap && claps < 3))
         uBit.sleep(1000);
 
-    uBit.messageBus.ignore(DEVICE_ID_SYSTEM_LEVEL_DETECTOR, LEVEL_THRESHOLD_HIGH, onLoud);
-    uBit.messageBus.ignore(DEVICE_ID_SYSTEM_LEVEL_DETECTOR, LEVEL_THRESHOLD_LOW, onQuiet);
+    uBit.messageBus.ignore(DEVICE_ID_ONSET_DETECTOR, ONSET_EVT_CLAP, onClap);
 }
 
 void
@@ -149,6 +220,93 @@ mems_clap_test_spl(int wait_for_clap)
     uBit.messageBus.ignore(DEVICE_ID_MICROPHONE, LEVEL_THRESHOLD_LOW, onQuiet);
 }
 
+static SpectrumAnalyser *spectrum = NULL;
+
+static void
+onSpectrum(MicroBitEvent)
+{
+    uBit.serial.printf("%d:", (int)spectrum->getFrameCount());
+
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+        uBit.serial.printf(" %d", (int)spectrum->getBandEnergy(b));
+
+    uBit.serial.printf("\n");
+}
+
+void
+spectrum_analyser_test()
+{
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+
+    if (spectrum == NULL)
+        spectrum = new SpectrumAnalyser(*splitterChannel);
+
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+        DMESG("BAND %d: %d Hz", b, spectrum->getBandFrequency(b));
+
+    uBit.messageBus.listen(DEVICE_ID_SPECTRUM_ANALYSER, SPECTRUM_ANALYSER_EVT_UPDATED, onSpectrum);
+
+    while(1)
+        uBit.sleep(1000);
+}
+
+static void
+onActivity(MicroBitEvent e)
+{
+    DMESG(e.value == ACTIVITY_GATE_EVT_OPEN ? "ACTIVITY: OPEN" : "ACTIVITY: CLOSE");
+}
+
+/**
+ * Runs the spectrum analyser behind an activity gate, so it only does any work while there is sound.
+ * The gate state, levels and the number of buffers passed and dropped are reported every second.
+ */
+void
+activity_gate_test()
+{
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    static ActivityGate *gate = new ActivityGate(*splitterChannel);
+
+    if (spectrum == NULL)
+        spectrum = new SpectrumAnalyser(*gate);
+
+    uBit.messageBus.listen(DEVICE_ID_ACTIVITY_GATE, DEVICE_EVT_ANY, onActivity);
+
+    while(1)
+    {
+        DMESG("GATE: %s LEVEL: %d FLOOR: %d PASSED: %d DROPPED: %d FRAMES: %d", gate->isOpen() ? "OPEN" : "CLOSED",
+            gate->getLevel(), gate->getFloor(), (int)gate->getPassedCount(), (int)gate->getDroppedCount(), (int)spectrum->getFrameCount());
+
+        uBit.sleep(1000);
+    }
+}
+
+/**
+ * Measures the microphone level with and without mains hum notching and band limiting, and reports both every second.
+ * The difference shows how much of the measured level is hum and out of band noise.
+ */
+void
+biquad_filter_test()
+{
+    static SplitterChannel *rawChannel = uBit.audio.splitter->createChannel();
+    static SplitterChannel *filterChannel = uBit.audio.splitter->createChannel();
+    static BiquadFilter *filter = new BiquadFilter(*filterChannel);
+    static RmsLevelDetector *raw = new RmsLevelDetector(*rawChannel);
+    static RmsLevelDetector *filtered = new RmsLevelDetector(*filter);
+
+    filter->setStage(0, BIQUAD_NOTCH, 50.0f, 2.0f);
+    filter->setStage(1, BIQUAD_NOTCH, 100.0f, 2.0f);
+    filter->setStage(2, BIQUAD_HIGH_PASS, 150.0f);
+    filter->setStage(3, BIQUAD_LOW_PASS, 4000.0f);
+
+    uBit.audio.activateMic();
+
+    while(1)
+    {
+        DMESG("LEVEL: RAW %d FILTERED %d (dB)", raw->getValue(), filtered->getValue());
+        uBit.sleep(1000);
+    }
+}
+
 class MakeCodeMicrophoneTemplate {
   public:
     MIC_DEVICE microphone;
@@ -0,0 +1,161 @@
+#include "MicroBit.h"
+#include "Mixer2.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define MIXER_BENCHMARK_MAX_CHANNELS    16
+#define MIXER_BENCHMARK_ITERATIONS      10
+#define MIXER_BENCHMARK_BUFFER_SAMPLES  256
+
+// Rates used by the samples that feed the mixer, and 0 for a mix of all of them.
+static const int mixer_benchmark_rates[] = {44100, 16000, 11000, 8000, 0};
+
+/**
+ * A DataSource that behaves like a synthesizer: it announces data once when connected, then hands out a
+ * buffer of a sawtooth, in the unsigned 0..1023 format, at its own sample rate on every pull.
+ */
+class MixerBenchmarkSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+    float rate;
+
+    MixerBenchmarkSource(float rate, int period) : buffer(MIXER_BENCHMARK_BUFFER_SAMPLES * sizeof(uint16_t))
+    {
+        uint16_t *p = (uint16_t *)&buffer[0];
+
+        this->rate = rate;
+
+        for (int i = 0; i < MIXER_BENCHMARK_BUFFER_SAMPLES; i++)
+            p[i] = (uint16_t)((i % period) * CONFIG_MIXER_INTERNAL_RANGE / (period - 1));
+    }
+
+    virtual void connect(DataSink &sink)
+    {
+        sink.pullRequest();
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return DATASTREAM_FORMAT_16BIT_UNSIGNED;
+    }
+
+    virtual float getSampleRate()
+    {
+        return rate;
+    }
+};
+
+/**
+ * Measures the mean cost of one output buffer from the mixer, in cycles, and the number of samples in it.
+ */
+static uint32_t
+mixer_benchmark_cost(Mixer2 &mixer, int &samples)
+{
+    ManagedBuffer b = mixer.pull();
+    samples = b.length() / DATASTREAM_FORMAT_BYTES_PER_SAMPLE(mixer.getFormat());
+
+    uint32_t start = cycle_counter_read();
+    for (int i = 0; i < MIXER_BENCHMARK_ITERATIONS; i++)
+        mixer.pull();
+
+    return (cycle_counter_read() - start) / MIXER_BENCHMARK_ITERATIONS;
+}
+
+/**
+ * Measures the cost of the same channels, in the same mixer, with them all moved to the output rate so none
+ * is resampled, then restores their own rates. The difference from the cost at their own rates is the cost
+ * of resampling alone.
+ */
+static uint32_t
+mixer_benchmark_native_cost(Mixer2 &mixer, MixerChannel **channels, MixerBenchmarkSource **sources, int count)
+{
+    uint32_t cycles;
+    int samples;
+
+    for (int c = 0; c < count; c++)
+        channels[c]->setSampleRate(mixer.getSampleRate());
+
+    cycles = mixer_benchmark_cost(mixer, samples);
+
+    for (int c = 0; c < count; c++)
+        channels[c]->setSampleRate(sources[c]->rate);
+
+    return cycles;
+}
+
+/**
+ * Drives a Mixer2 with 1 to MIXER_BENCHMARK_MAX_CHANNELS synthetic channels, at each of the sample rates used
+ * by the samples and at a mix of them all. For each, reports the cycles per output buffer, the share of the
+ * time the buffer takes to play, and the cost of resampling: the same channels are measured again at the output
+ * rate, back to back, and the difference taken. Fewer source buffers are fetched at a lower rate, so where that
+ * saves more than resampling costs, the resampling cost is reported as zero.
+ * The underrun threshold is the number of channels at which a buffer costs more than it lasts. If it is not
+ * reached, it is extrapolated linearly from the cost of MIXER_BENCHMARK_MAX_CHANNELS, and reported as an estimate.
+ * Results are written to DMESG.
+ */
+void
+mixer2_scaling_benchmark()
+{
+    static const int rateCount = sizeof(mixer_benchmark_rates) / sizeof(mixer_benchmark_rates[0]);
+    MixerBenchmarkSource *sources[MIXER_BENCHMARK_MAX_CHANNELS];
+    MixerChannel *channels[MIXER_BENCHMARK_MAX_CHANNELS];
+    Mixer2 *mixer = new Mixer2();
+    int samples = 0;
+
+    cycle_counter_enable();
+
+    DMESG("MIXER2_SCALING_BENCHMARK: output %d Hz, %d buffers per measurement", (int)mixer->getSampleRate(), MIXER_BENCHMARK_ITERATIONS);
+
+    for (int r = 0; r < rateCount; r++)
+    {
+        int underrun = 0;
+        uint32_t cycles = 0;
+        uint32_t native = 0;
+        uint32_t deadline = 0;
+
+        if (mixer_benchmark_rates[r])
+            DMESG("   CHANNELS AT %d Hz:", mixer_benchmark_rates[r]);
+        else
+            DMESG("   CHANNELS AT MIXED RATES:");
+
+        for (int c = 0; c < MIXER_BENCHMARK_MAX_CHANNELS; c++)
+        {
+            // In the mixed case, channels take each of the other rates in turn.
+            int rate = mixer_benchmark_rates[r] ? mixer_benchmark_rates[r] : mixer_benchmark_rates[c % (rateCount - 1)];
+
+            sources[c] = new MixerBenchmarkSource(rate, 37 + 6 * c);
+            channels[c] = mixer->addChannel(*sources[c], rate);
+
+            cycles = mixer_benchmark_cost(*mixer, samples);
+            deadline = (uint32_t)((uint64_t)samples * SystemCoreClock / mixer->getSampleRate());
+
+            native = mixer_benchmark_native_cost(*mixer, channels, sources, c + 1);
+
+            if (!underrun && cycles > deadline)
+                underrun = c + 1;
+
+            DMESG("      %d: %d cycles/buffer of %d samples (%d%% of deadline), %d at the output rate, resampling %d cycles", c + 1,
+                (int)cycles, samples, deadline ? (int)((uint64_t)cycles * 100 / deadline) : 0, (int)native, cycles > native ? (int)(cycles - native) : 0);
+        }
+
+        if (underrun)
+            DMESG("      UNDERRUN THRESHOLD: %d channels", underrun);
+        else
+            DMESG("      UNDERRUN THRESHOLD: not reached at %d channels, ESTIMATED %d by linear extrapolation", MIXER_BENCHMARK_MAX_CHANNELS,
+                (int)((uint64_t)deadline * MIXER_BENCHMARK_MAX_CHANNELS / max(cycles, (uint32_t)1)));
+
+        for (int c = 0; c < MIXER_BENCHMARK_MAX_CHANNELS; c++)
+        {
+            mixer->removeChannel(channels[c]);
+            delete sources[c];
+        }
+    }
+
+    delete mixer;
+}
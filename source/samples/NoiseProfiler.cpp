@@ -23,14 +23,29 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include "NoiseProfiler.h"
+#include "nrf.h"
 #include "Tests.h"
 
 /**
-* Creates a simple component that generates a noise profile of an 8 bit data stream provided
+ * Converts a raw sample into a signed value centred on zero.
+ */
+static inline int noise_sample(int8_t s) { return s; }
+static inline int noise_sample(uint8_t s) { return (int)s - 128; }
+static inline int noise_sample(int16_t s) { return s; }
+static inline int noise_sample(uint16_t s) { return (int)s - 32768; }
+static inline int noise_sample(int32_t s) { return s; }
+static inline int noise_sample(uint32_t s) { return (int32_t)(s ^ 0x80000000); }
+
+/**
+* Creates a simple component that generates a noise profile of the data stream provided.
 * @param source a DataSource to measure.
 */
 NoiseProfiler::NoiseProfiler(DataSource &source) : upstream(source)
 {
+    windowLength = NOISE_PROFILE_TOTAL_SAMPLES;
+    continuous = false;
+    exportResults = false;
+
     reset();
 
     // Register with our upstream component
@@ -45,45 +60,272 @@ NoiseProfiler::pullRequest()
 {
     ManagedBuffer buf = upstream.pull();
 
-    int8_t *p = (int8_t *)&buf[0];
-    int8_t *end = (int8_t *)p + buf.length();
-    int s,s1;
-    bool first = true;
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return profileBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return profileBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return profileBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return profileBuffer<uint16_t>(buf);
+
+        case DATASTREAM_FORMAT_32BIT_SIGNED:
+            return profileBuffer<int32_t>(buf);
+
+        case DATASTREAM_FORMAT_32BIT_UNSIGNED:
+            return profileBuffer<uint32_t>(buf);
+    }
+
+    return DEVICE_NOT_SUPPORTED;
+}
+
+/**
+ * Profiles the given buffer, interpreted as type T, rolling over into the next window as required.
+ */
+template <typename T> int
+NoiseProfiler::profileBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    int len = buf.length() / sizeof(T);
+    int n;
+
+    if (len <= 0)
+        return DEVICE_OK;
+
+    // The first sample of each buffer has no predecessor, so is compared against itself.
+    int prev = noise_sample(p[0]);
+
+    while (len > 0)
+    {
+        n = windowLength - window->samples;
+
+        if (n <= 0)
+            break;
+
+        if (n > len)
+            n = len;
+
+        if (sizeof(T) == 1)
+            profileBlock(p, n, prev);
+        else
+            profileScalar(p, n, prev);
+
+        window->samples += n;
+        prev = noise_sample(p[n-1]);
+        p += n;
+        len -= n;
+
+        if (continuous && window->samples >= windowLength)
+            nextWindow();
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Scalar kernel, specialised at compile time for each sample type. Profiles len samples,
+ * given the (zero centred) sample that preceded them.
+ */
+template <typename T> void
+NoiseProfiler::profileScalar(const T *p, int len, int prev)
+{
+    // Wider samples are binned by their top byte, so every format shares the 8 bit histogram.
+    const int shift = 8 * (sizeof(T) - 1);
+    const T *end = p + len;
+    int *noiseProfile = window->noiseProfile;
+    int64_t variance = 0;
+    int64_t d;
+    int s, bin;
 
     while (p < end)
     {
-        if (samples < NOISE_PROFILE_TOTAL_SAMPLES)
-        {
-            s = *p;
+        s = noise_sample(*p++);
+        bin = (s >> shift) + NOISE_PROFILE_RANGE;
+
+        // A single unsigned compare covers both ends of the range.
+        if ((unsigned)bin < NOISE_PROFILE_SIZE)
+            noiseProfile[bin]++;
+
+        // 32 bit samples can differ by more than an int can hold.
+        d = (int64_t)s - prev;
+        variance += d < 0 ? -d : d;
+        prev = s;
+    }
+
+    window->variance += variance;
+}
+
+/**
+ * Block kernel for 8 bit samples. Profiles len samples four at a time using the Cortex-M4
+ * SIMD instructions, handing any remainder to the scalar kernel.
+ */
+template <typename T> void
+NoiseProfiler::profileBlock(const T *p, int len, int prev)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    // Work in offset binary, where a sample s is held as the unsigned value s+128. Unsigned samples
+    // are already in this form; signed samples just need their sign bit flipped. Differences are
+    // unchanged, so USADA8 yields the sum of absolute differences directly.
+    const uint32_t flip = (T)-1 < 0 ? 0x80808080 : 0;
+    uint32_t last = (uint32_t)(prev + 128);
+    uint32_t x, shifted, offset, outside;
+    uint32_t variance = 0;
+    int *noiseProfile = window->noiseProfile;
+
+    while (len >= 4)
+    {
+        memcpy(&x, p, 4);
+        x ^= flip;
 
-            if (s <= NOISE_PROFILE_RANGE && s >= -NOISE_PROFILE_RANGE)
-                noiseProfile[s+NOISE_PROFILE_RANGE]++;
+        // Pair each sample with its predecessor: {s0,s1,s2,s3} against {last,s0,s1,s2}.
+        shifted = (x << 8) | last;
+        variance = __USADA8(x, shifted, variance);
+        last = x >> 24;
 
-            if (first)
-                first = false;
-            else
-                variance += abs(s-s1);
-                         
-            s1 = s;
-            samples++;
+        // Lane-wise histogram index, and a byte mask of lanes that fall outside the profiled range.
+        offset = __USUB8(x, (128 - NOISE_PROFILE_RANGE) * 0x01010101);
+        __USUB8(offset, NOISE_PROFILE_SIZE * 0x01010101);
+        outside = __SEL(0xFFFFFFFF, 0);
 
+        if (outside != 0xFFFFFFFF)
+        {
+            if (!(outside & 0x000000FF))
+                noiseProfile[offset & 0xFF]++;
+            if (!(outside & 0x0000FF00))
+                noiseProfile[(offset >> 8) & 0xFF]++;
+            if (!(outside & 0x00FF0000))
+                noiseProfile[(offset >> 16) & 0xFF]++;
+            if (!(outside & 0xFF000000))
+                noiseProfile[offset >> 24]++;
         }
 
-        p++;
+        p += 4;
+        len -= 4;
     }
 
-    return DEVICE_OK;
+    window->variance += variance;
+    prev = (int)last - 128;
+#endif
+
+    profileScalar(p, len, prev);
+}
+
+/**
+ * Completes the current window, exporting it if requested, and starts the next one in the ring.
+ */
+void
+NoiseProfiler::nextWindow()
+{
+    if (exportResults)
+        sendWindow(*window, windowCount);
+
+    windowCount++;
+    window = &windows[windowCount % NOISE_PROFILE_WINDOWS];
+    memset(window, 0, sizeof(NoiseProfileWindow));
 }
 
 void 
 NoiseProfiler::reset()
 {
     // Reset our state
+    memset(windows, 0, sizeof(windows));
+
+    window = &windows[0];
+    windowCount = 0;
+    dropped = 0;
+}
+
+/**
+ * Switches the profiler into continuous mode.
+ *
+ * @param windowSamples the number of samples per window, or 0 for one second at the upstream sample rate.
+ * @param exportResults if true, each completed window is sent over serial as a NoiseProfileFrame.
+ */
+void
+NoiseProfiler::setContinuous(int windowSamples, bool exportResults)
+{
+    if (windowSamples <= 0)
+        windowSamples = (int) upstream.getSampleRate();
+
+    if (windowSamples <= 0)
+        windowSamples = NOISE_PROFILE_DEFAULT_WINDOW_SAMPLES;
+
+    // Ensure a whole frame can be queued in one go, so it never has to be sent synchronously.
+    // The transmit ring keeps one slot empty, so it holds one byte less than its size.
+    if (exportResults && uBit.serial.getTxBufferSize() - 1 < (int) sizeof(NoiseProfileFrame))
+        uBit.serial.setTxBufferSize(2 * sizeof(NoiseProfileFrame));
+
+    this->windowLength = windowSamples;
+    this->exportResults = exportResults;
+    this->continuous = true;
+
+    reset();
+}
+
+/**
+ * Returns a completed window from the ring.
+ * @param age the number of windows back in time, where 0 is the most recently completed window.
+ * @return the requested window, or NULL if it is not (or no longer) available.
+ */
+NoiseProfileWindow *
+NoiseProfiler::getWindow(int age)
+{
+    if (age < 0 || age >= windowCount || age >= NOISE_PROFILE_WINDOWS - 1)
+        return NULL;
+
+    return &windows[(windowCount - 1 - age) % NOISE_PROFILE_WINDOWS];
+}
+
+/**
+ * Sends the given window over serial as a NoiseProfileFrame, without blocking.
+ */
+int
+NoiseProfiler::sendWindow(NoiseProfileWindow &w, int sequence)
+{
+    NoiseProfileFrame frame;
+    uint8_t *b = (uint8_t *)&frame;
+    uint8_t checksum = 0;
+
+    if (uBit.serial.getTxBufferSize() - 1 - uBit.serial.txBufferedSize() < (int) sizeof(NoiseProfileFrame))
+    {
+        dropped++;
+        return DEVICE_BUSY;
+    }
+
+    frame.sync = NOISE_PROFILE_FRAME_SYNC;
+    frame.version = NOISE_PROFILE_FRAME_VERSION;
+    frame.bins = NOISE_PROFILE_SIZE;
+    frame.sequence = sequence;
+    frame.dropped = dropped;
+    frame.samples = w.samples;
+    frame.variance = w.variance > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)w.variance;
+
     for (int i=0; i<NOISE_PROFILE_SIZE; i++)
-        noiseProfile[i] = 0;
+        frame.noiseProfile[i] = w.noiseProfile[i] > 0xFFFF ? 0xFFFF : w.noiseProfile[i];
+
+    for (int i=0; i<(int) sizeof(NoiseProfileFrame) - 1; i++)
+        checksum += b[i];
+
+    frame.checksum = checksum;
+    dropped = 0;
 
-    samples = 0;
-    variance = 0;
+    uBit.serial.send(b, sizeof(NoiseProfileFrame), ASYNC);
+
+    return DEVICE_OK;
+}
+
+/**
+ * Sends the results gathered so far over serial as a single NoiseProfileFrame.
+ */
+int
+NoiseProfiler::sendResults()
+{
+    return sendWindow(*window, windowCount);
 }
 
 /**
@@ -93,12 +335,12 @@ void
 NoiseProfiler::printResults()
 {
     DMESG("NOISE_PROFILE:");
-    DMESG("   SAMPLES: %d", samples);
-    DMESG("   VARIANCE: %d", variance);
+    DMESG("   SAMPLES: %d", window->samples);
+    DMESG("   VARIANCE: %d", (int)min(window->variance, (int64_t)INT32_MAX));
 
 
     for (int i=0; i<NOISE_PROFILE_SIZE; i++)
-        DMESG("   LEVEL [%d]: %d", i-NOISE_PROFILE_RANGE, noiseProfile[i]);
+        DMESG("   LEVEL [%d]: %d", i-NOISE_PROFILE_RANGE, window->noiseProfile[i]);
 }
 
 /**
@@ -108,5 +350,5 @@ NoiseProfiler::printResults()
 bool 
 NoiseProfiler::isDone()
 {
-    return samples >= NOISE_PROFILE_TOTAL_SAMPLES;
-}
\ No newline at end of file
+    return !continuous && window->samples >= NOISE_PROFILE_TOTAL_SAMPLES;
+}
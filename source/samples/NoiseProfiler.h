@@ -33,23 +33,93 @@ DEALINGS IN THE SOFTWARE.
 #define NOISE_PROFILE_SIZE (2*NOISE_PROFILE_RANGE+1)
 #define NOISE_PROFILE_TOTAL_SAMPLES 110000
 
+// Continuous mode: number of windows held in the ring (including the one being filled),
+// and the window length used when the upstream sample rate is unknown.
+#define NOISE_PROFILE_WINDOWS 8
+#define NOISE_PROFILE_DEFAULT_WINDOW_SAMPLES 11000
 
-class NoiseProfiler : public DataSink
+#define NOISE_PROFILE_FRAME_SYNC 0x504E
+#define NOISE_PROFILE_FRAME_VERSION 1
+
+/**
+ * The results gathered over a single window.
+ */
+struct NoiseProfileWindow
 {
-    DataSource      &upstream;          
     int             noiseProfile[NOISE_PROFILE_SIZE];
-    int             variance;
+    int64_t         variance;           // Sum of absolute differences between samples, in input sample units.
     int             samples;
+};
+
+/**
+ * Binary frame used to export a window over serial. All fields are little endian.
+ * The checksum is the low byte of the sum of all preceding bytes in the frame.
+ * Histogram counts and the variance saturate at the range of their fields.
+ */
+struct NoiseProfileFrame
+{
+    uint16_t        sync;               // NOISE_PROFILE_FRAME_SYNC ("NP" on the wire)
+    uint8_t         version;            // NOISE_PROFILE_FRAME_VERSION
+    uint8_t         bins;               // NOISE_PROFILE_SIZE
+    uint16_t        sequence;           // Window sequence number
+    uint16_t        dropped;            // Frames dropped since the previous frame was sent
+    uint32_t        samples;
+    uint32_t        variance;
+    uint16_t        noiseProfile[NOISE_PROFILE_SIZE];
+    uint8_t         checksum;
+} __attribute__((packed));
+
+class NoiseProfiler : public DataSink
+{
+    DataSource      &upstream;          
+    NoiseProfileWindow windows[NOISE_PROFILE_WINDOWS];
+    NoiseProfileWindow *window;         // The window currently being filled.
+    int             windowCount;        // Number of windows completed so far.
+    int             windowLength;       // Samples per window.
+    bool            continuous;
+    bool            exportResults;
+    uint16_t        dropped;
+
+    /**
+     * Scalar kernel, specialised at compile time for each sample type. Profiles len samples,
+     * given the (zero centred) sample that preceded them.
+     */
+    template <typename T> void profileScalar(const T *p, int len, int prev);
+
+    /**
+     * Block kernel for 8 bit samples. Profiles len samples four at a time using the Cortex-M4
+     * SIMD instructions, handing any remainder to the scalar kernel.
+     */
+    template <typename T> void profileBlock(const T *p, int len, int prev);
+
+    /**
+     * Profiles the given buffer, interpreted as type T, rolling over into the next window as required.
+     */
+    template <typename T> int profileBuffer(ManagedBuffer &buf);
+
+    /**
+     * Completes the current window, exporting it if requested, and starts the next one in the ring.
+     */
+    void nextWindow();
+
+    /**
+     * Sends the given window over serial as a NoiseProfileFrame, without blocking.
+     */
+    int sendWindow(NoiseProfileWindow &w, int sequence);
 
     public:
     /**
-     * Creates a simple component that generates a noise profile of an 8 bit data stream provided
+     * Creates a simple component that generates a noise profile of the data stream provided.
+     * Samples are read in place in the upstream format (8, 16 or 32 bit, signed or unsigned),
+     * with unsigned samples measured relative to the midpoint of their range. The histogram is
+     * always in 8 bit units, so 16 and 32 bit samples are binned by their top byte.
      * @param source a DataSource to measure.
      */
     NoiseProfiler(DataSource &source);
 
     /**
      * Callback provided when data is ready.
+     * @return DEVICE_OK, or DEVICE_NOT_SUPPORTED if the upstream format cannot be profiled.
      */
     virtual int pullRequest();
 
@@ -58,6 +128,30 @@ class NoiseProfiler : public DataSink
     */
     void reset();
 
+    /**
+     * Switches the profiler into continuous mode. Rather than stopping after NOISE_PROFILE_TOTAL_SAMPLES,
+     * results are gathered into a ring of fixed length windows, so drift can be tracked over long periods.
+     *
+     * @param windowSamples the number of samples per window, or 0 for one second at the upstream sample rate.
+     * @param exportResults if true, each completed window is sent over serial as a NoiseProfileFrame.
+     */
+    void setContinuous(int windowSamples = 0, bool exportResults = true);
+
+    /**
+     * Returns a completed window from the ring.
+     * @param age the number of windows back in time, where 0 is the most recently completed window.
+     * @return the requested window, or NULL if it is not (or no longer) available.
+     */
+    NoiseProfileWindow *getWindow(int age = 0);
+
+    /**
+     * Sends the results gathered so far over serial as a single NoiseProfileFrame, rather than as text.
+     * The frame is queued asynchronously; if there is insufficient room in the serial transmit buffer
+     * it is dropped, and this is reported in the next frame sent.
+     * @return DEVICE_OK, or DEVICE_BUSY if the frame was dropped.
+     */
+    int sendResults();
+
     /**
     * Output the results gathered to the DMESG buffer
     */
@@ -65,7 +159,7 @@ class NoiseProfiler : public DataSink
 
     /**
     * Determines the state of the test
-    * @return true if the test is complete, fasle otherwise
+    * @return true if the test is complete, fasle otherwise. Always false in continuous mode.
     */
     bool isDone();
 };
@@ -0,0 +1,134 @@
+#include "MicroBit.h"
+#include "NoiseProfiler.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define NOISE_BENCHMARK_BUFFER_SIZE     512
+#define NOISE_BENCHMARK_ITERATIONS      100
+
+/**
+ * A DataSource that hands out the same buffer on every pull, so the profiler can be driven
+ * synchronously without the microphone pipeline.
+ */
+class NoiseBenchmarkSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+
+    NoiseBenchmarkSource() : buffer(NOISE_BENCHMARK_BUFFER_SIZE) {}
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return DATASTREAM_FORMAT_8BIT_SIGNED;
+    }
+};
+
+/**
+ * The original per-sample NoiseProfiler loop, retained as the baseline for the benchmark.
+ */
+static void
+noise_profile_reference(ManagedBuffer &buf, int *noiseProfile, int &variance, int &samples)
+{
+    int8_t *p = (int8_t *)&buf[0];
+    int8_t *end = (int8_t *)p + buf.length();
+    int s,s1 = 0;
+    bool first = true;
+
+    while (p < end)
+    {
+        if (samples < NOISE_PROFILE_TOTAL_SAMPLES)
+        {
+            s = *p;
+
+            if (s <= NOISE_PROFILE_RANGE && s >= -NOISE_PROFILE_RANGE)
+                noiseProfile[s+NOISE_PROFILE_RANGE]++;
+
+            if (first)
+                first = false;
+            else
+                variance += abs(s-s1);
+
+            s1 = s;
+            samples++;
+        }
+
+        p++;
+    }
+}
+
+/**
+ * Compares the cost of the original scalar loop against the SIMD block kernel in NoiseProfiler,
+ * on a buffer of synthetic low level noise, and checks that both produce the same histogram and variance.
+ * Results are written to DMESG in cycles per buffer.
+ */
+void
+noise_profiler_benchmark()
+{
+    NoiseBenchmarkSource source;
+    NoiseProfiler profiler(source);
+
+    // Gather every benchmark buffer into a single window, so it can be compared with the reference.
+    profiler.setContinuous(NOISE_BENCHMARK_BUFFER_SIZE * NOISE_BENCHMARK_ITERATIONS, false);
+
+    int noiseProfile[NOISE_PROFILE_SIZE] = {0};
+    int variance = 0;
+    int samples = 0;
+
+    // Mostly in-range noise, with the occasional excursion beyond NOISE_PROFILE_RANGE.
+    for (int i = 0; i < NOISE_BENCHMARK_BUFFER_SIZE; i++)
+        source.buffer[i] = (uint8_t)(int8_t)(uBit.random(2 * NOISE_PROFILE_RANGE + 9) - NOISE_PROFILE_RANGE - 4);
+
+    cycle_counter_enable();
+
+    uint32_t start = cycle_counter_read();
+    for (int i = 0; i < NOISE_BENCHMARK_ITERATIONS; i++)
+        noise_profile_reference(source.buffer, noiseProfile, variance, samples);
+    uint32_t scalarCycles = cycle_counter_read() - start;
+
+    start = cycle_counter_read();
+    for (int i = 0; i < NOISE_BENCHMARK_ITERATIONS; i++)
+        profiler.pullRequest();
+    uint32_t blockCycles = cycle_counter_read() - start;
+
+    DMESG("NOISE_PROFILER_BENCHMARK: %d samples x %d buffers", NOISE_BENCHMARK_BUFFER_SIZE, NOISE_BENCHMARK_ITERATIONS);
+    DMESG("   SCALAR: %d cycles/buffer", (int)(scalarCycles / NOISE_BENCHMARK_ITERATIONS));
+    DMESG("   BLOCK: %d cycles/buffer", (int)(blockCycles / NOISE_BENCHMARK_ITERATIONS));
+
+    // Both kernels saw the same buffers, so must agree exactly on the results.
+    NoiseProfileWindow *w = profiler.getWindow();
+    bool pass = w != NULL && w->samples == samples && w->variance == variance;
+
+    for (int i = 0; pass && i < NOISE_PROFILE_SIZE; i++)
+        pass = w->noiseProfile[i] == noiseProfile[i];
+
+    DMESG("   SCALAR VARIANCE: %d BLOCK VARIANCE: %d", variance, w ? (int)w->variance : -1);
+    DMESG("   RESULTS: %s", pass ? "PASS" : "FAIL");
+}
+
+/**
+ * Profiles the microphone continuously, exporting a binary NoiseProfileFrame over serial
+ * for every second of audio.
+ */
+void
+noise_profiler_continuous_test()
+{
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    static NoiseProfiler *profiler = new NoiseProfiler(*splitterChannel);
+
+    profiler->setContinuous();
+
+    while (true)
+    {
+        NoiseProfileWindow *w = profiler->getWindow();
+
+        if (w)
+            DMESG("NOISE_PROFILE: SAMPLES: %d VARIANCE: %d", w->samples, (int)min(w->variance, (int64_t)INT32_MAX));
+
+        uBit.sleep(1000);
+    }
+}
@@ -8,7 +8,10 @@
 #include "MicroBit.h"
 #include "Synthesizer.h"
 #include "StreamRecording.h"
+#include "RmsLevelDetector.h"
+#include "SharedSplitter.h"
 #include "LowPassFilter.h"
+#include "SoundExpressionCompiler.h"
 
 const char * const heart =
     "000,255,000,255,000\n"
@@ -213,11 +216,19 @@ static void onButtonAB(MicroBitEvent) {
     }
 }
 
+static RmsLevelDetector *audioLevel = NULL;
+
+static void onAudioLevel(MicroBitEvent) {
+    plotBarGraph(audioLevel->getValue(), 255);
+}
+
 static void onButtonLogo(MicroBitEvent) {
     DMESG("Button Logo");
 
     int sampleRate = 11000;
-    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    // The recording and the level meter share one splitter channel, and each buffer from it.
+    static SharedSplitter *shared = new SharedSplitter(*uBit.audio.splitter->createChannel());
+    static SharedSplitterChannel *splitterChannel = shared->createChannel();
     // FIXME: Update this to use the new requestSampleRate
     // splitterChannel->requestSampleRate( sampleRate );
 
@@ -235,18 +246,34 @@ static void onButtonLogo(MicroBitEvent) {
     channel->setVolume(75.0);
     uBit.audio.mixer.setVolume(1023);
 
+    // The level meter pushes a new reading every window, rather than being polled.
+    static SharedSplitterChannel *levelChannel = shared->createChannel();
+    static RmsLevelDetector *level = new RmsLevelDetector(*levelChannel, 75.0f, 60.0f, 0.0f, DEVICE_ID_RMS_LEVEL_DETECTOR, false);
+    level->setUnit(RMS_LEVEL_UNIT_8BIT);
+    audioLevel = level;
+
+    // Both channels are disconnected when the demo ends, so reconnect them for this run.
+    splitterChannel->connect(*recording);
+    levelChannel->connect(*level);
+
     uBit.display.clear();
-    uBit.audio.levelSPL->setUnit(LEVEL_DETECTOR_SPL_8BIT);
+
+    uBit.messageBus.listen(DEVICE_ID_RMS_LEVEL_DETECTOR, RMS_LEVEL_EVT_UPDATED, onAudioLevel);
+    level->setEventMode(true);
 
     recording->recordAsync();
     while (uBit.logo.isPressed() && recording->isRecording()) {
-        int audioLevel = (int)uBit.audio.levelSPL->getValue();
-        DMESG("Audio level: %d", audioLevel);
-        plotBarGraph(audioLevel, 255);
         uBit.sleep(5);
     }
     // At this point either the logo has been released or the recording is done
     recording->stop();
+
+    level->setEventMode(false);
+    uBit.messageBus.ignore(DEVICE_ID_RMS_LEVEL_DETECTOR, RMS_LEVEL_EVT_UPDATED, onAudioLevel);
+    // With no channel connected the shared splitter stops pulling and tells the audio splitter it is not
+    // wanted, so the microphone can time out while the recording plays back.
+    splitterChannel->disconnect();
+    levelChannel->disconnect();
     // Note: The CODAL_STREAM_IDLE_TIMEOUT_MS config has been set in the
     // codal.json file to reduce the time it takes for the microphone LED
     // to turn off after the recording is done.
@@ -265,6 +292,17 @@ static void onButtonLogo(MicroBitEvent) {
     recording->erase();
 }
 
+// The shake and screen down sounds, decoded at compile time.
+static constexpr SoundExpressionFrame shakeSound[] = {
+    sound_expression_compile("002373041050001000392300001023010802050005000000000000000000000000000000")
+};
+static constexpr SoundExpressionFrame screenDownSound[] = {
+    sound_expression_compile("010230849100001000000100000000012800000100240000000000000000000000000000")
+};
+static SoundExpressionPlayer *soundPlayer = NULL;
+static int shakeHandle;
+static int screenDownHandle;
+
 static void onShake(MicroBitEvent) {
     DMESG("Shake");
     uBit.display.print(SILENT);
@@ -280,7 +318,7 @@ static void onShake(MicroBitEvent) {
     //     fx=audio.SoundEffect.FX_WARBLE,
     //     shape=audio.SoundEffect.SHAPE_LINEAR,
     // )
-    uBit.audio.soundExpressions.playAsync("002373041050001000392300001023010802050005000000000000000000000000000000");
+    soundPlayer->playAsync(shakeHandle);
 
     uBit.display.print(SINGING);
     uBit.sleep(400);
@@ -300,7 +338,7 @@ static void onScreenDown(MicroBitEvent) {
     //     fx=audio.SoundEffect.FX_NONE,
     //     shape=audio.SoundEffect.SHAPE_LINEAR,
     // )
-    uBit.audio.soundExpressions.play("010230849100001000000100000000012800000100240000000000000000000000000000");
+    soundPlayer->play(screenDownHandle);
 
     uBit.display.print(ASLEEP);
 }
@@ -315,6 +353,10 @@ void out_of_box_experience() {
     uBit.messageBus.listen(MICROBIT_ID_BUTTON_B, MICROBIT_BUTTON_EVT_CLICK, onButtonB);
     uBit.messageBus.listen(MICROBIT_ID_BUTTON_AB, MICROBIT_BUTTON_EVT_CLICK, onButtonAB);
     uBit.messageBus.listen(MICROBIT_ID_LOGO, MICROBIT_BUTTON_EVT_DOWN, onButtonLogo);
+    soundPlayer = new SoundExpressionPlayer(uBit.audio.synth);
+    shakeHandle = soundPlayer->add(shakeSound, 1);
+    screenDownHandle = soundPlayer->add(screenDownSound, 1);
+
     uBit.messageBus.listen(MICROBIT_ID_GESTURE, MICROBIT_ACCELEROMETER_EVT_SHAKE, onShake);
     uBit.messageBus.listen(MICROBIT_ID_GESTURE, MICROBIT_ACCELEROMETER_EVT_FACE_DOWN, onScreenDown);
 
@@ -0,0 +1,271 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "OnsetDetector.h"
+#include "RmsLevelDetector.h"
+
+/**
+ * Converts a raw sample into a signed value, centred on zero.
+ */
+static inline int onset_sample(int8_t s) { return s; }
+static inline int onset_sample(uint8_t s) { return (int)s - 128; }
+static inline int onset_sample(int16_t s) { return s; }
+static inline int onset_sample(uint16_t s) { return (int)s - 32768; }
+
+/**
+ * Creates an OnsetDetector attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to analyse.
+ * @param id the ID used to raise ONSET_EVT_CLAP events.
+ */
+OnsetDetector::OnsetDetector(DataSource &source, uint16_t id) : upstream(source)
+{
+    this->id = id;
+    this->previous = 0;
+    this->fill = 0;
+    this->energy = 0;
+    this->background = -1;
+    this->peak = 0;
+    this->candidateFrames = -1;
+    this->refractoryFrames = 0;
+    this->position = 0;
+    this->candidatePosition = 0;
+    this->candidateTime = 0;
+    this->onsetPosition = 0;
+    this->claps = 0;
+
+    setThreshold(ONSET_DEFAULT_THRESHOLD_DB);
+    setMinimumLevel(ONSET_DEFAULT_MINIMUM_DB);
+    setDecay(ONSET_DEFAULT_DECAY_DB, ONSET_DEFAULT_MAX_DURATION_MS);
+    setRefractoryPeriod(ONSET_DEFAULT_REFRACTORY_MS);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+OnsetDetector::pullRequest()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return analyseBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return analyseBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return analyseBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return analyseBuffer<uint16_t>(buf);
+    }
+
+    return DEVICE_NOT_SUPPORTED;
+}
+
+/**
+ * Analyses the given buffer, interpreted as type T.
+ */
+template <typename T> int
+OnsetDetector::analyseBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    int len = buf.length() / sizeof(T);
+    T *end = p + len;
+
+    // 8 bit samples are squared in 8 bit units, then scaled to 16 bit units once per frame.
+    const int shift = sizeof(T) == 1 ? 16 : 0;
+
+    // The buffer is assumed to have just been captured, so sample i was taken (len - i) sample periods ago.
+    CODAL_TIMESTAMP now = system_timer_current_time_us();
+    float rate = upstream.getSampleRate();
+    int usPerSample = rate > 0 ? (int)(1000000.0f / rate) : 0;
+
+    while (p < end)
+    {
+        int n = min((int)(end - p), ONSET_FRAME_SIZE - fill);
+        T *frameEnd = p + n;
+        uint64_t sum = 0;
+        int s, d;
+
+        while (p < frameEnd)
+        {
+            s = onset_sample(*p++);
+            d = s - previous;
+            sum += (uint32_t)d * (uint32_t)d;
+            previous = s;
+        }
+
+        energy += sum << shift;
+        fill += n;
+
+        if (fill == ONSET_FRAME_SIZE)
+        {
+            int remaining = end - p;
+            analyseFrame(rms_level_millibels(energy / ONSET_FRAME_SIZE), now - (CODAL_TIMESTAMP)(remaining + ONSET_FRAME_SIZE) * usPerSample);
+
+            position += ONSET_FRAME_SIZE;
+            energy = 0;
+            fill = 0;
+        }
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Moves the background level towards the level of a frame.
+ */
+void
+OnsetDetector::updateBackground(int level)
+{
+    int shift = level > background ? ONSET_BACKGROUND_RISE_SHIFT : ONSET_BACKGROUND_FALL_SHIFT;
+
+    background += (level - background) >> shift;
+}
+
+/**
+ * Updates the detector with the level of a completed frame.
+ * @param time the time at which the frame started, in microseconds.
+ */
+void
+OnsetDetector::analyseFrame(int level, CODAL_TIMESTAMP time)
+{
+    float rate = upstream.getSampleRate();
+    int framesPerSecond = rate > 0 ? (int)rate / ONSET_FRAME_SIZE : 1;
+
+    if (background < 0)
+        background = level;
+
+    if (refractoryFrames > 0)
+    {
+        refractoryFrames--;
+        updateBackground(level);
+        return;
+    }
+
+    if (candidateFrames < 0)
+    {
+        // Look for a sharp rise above the background.
+        if (level - background >= threshold && level >= minimum)
+        {
+            candidateFrames = 0;
+            candidatePosition = position;
+            candidateTime = time;
+            peak = level;
+            return;
+        }
+
+        updateBackground(level);
+        return;
+    }
+
+    // A candidate is in progress: track its peak, and confirm it once it has decayed.
+    candidateFrames++;
+
+    if (level > peak)
+        peak = level;
+
+    if (peak - level >= decay)
+    {
+        candidateFrames = -1;
+        refractoryFrames = refractoryMs * framesPerSecond / 1000;
+        onsetPosition = candidatePosition;
+        claps++;
+
+        MicroBitEvent evt(id, ONSET_EVT_CLAP, CREATE_ONLY);
+        evt.timestamp = candidateTime;
+        evt.fire();
+        return;
+    }
+
+    // Too long to be a clap: a sustained sound, which the background now follows.
+    if (candidateFrames * 1000 >= maxDurationMs * framesPerSecond)
+    {
+        candidateFrames = -1;
+        background = level;
+    }
+}
+
+/**
+ * Sets the rise above the background level, in dB, that marks an onset.
+ */
+void
+OnsetDetector::setThreshold(int dB)
+{
+    threshold = dB * 100;
+}
+
+/**
+ * Sets the level, in dB, that an onset must reach to be considered.
+ */
+void
+OnsetDetector::setMinimumLevel(int dB)
+{
+    minimum = dB * 100;
+}
+
+/**
+ * Sets how far, in dB, the level must fall from its peak, and how quickly, for an onset to be reported as a clap.
+ */
+void
+OnsetDetector::setDecay(int dB, int maxDurationMs)
+{
+    this->decay = dB * 100;
+    this->maxDurationMs = maxDurationMs;
+}
+
+/**
+ * Sets the time after each clap during which further onsets are ignored.
+ */
+void
+OnsetDetector::setRefractoryPeriod(int ms)
+{
+    refractoryMs = ms;
+}
+
+/**
+ * Determines the number of claps detected since the detector was created.
+ */
+uint32_t
+OnsetDetector::getClapCount()
+{
+    return claps;
+}
+
+/**
+ * Determines the position of the most recent clap, in samples since the detector was created.
+ */
+uint32_t
+OnsetDetector::getOnsetPosition()
+{
+    return onsetPosition;
+}
@@ -0,0 +1,148 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef ONSET_DETECTOR_H
+#define ONSET_DETECTOR_H
+
+#define DEVICE_ID_ONSET_DETECTOR 9014
+#define ONSET_EVT_CLAP 1
+
+// Length of each analysis frame, in samples.
+#define ONSET_FRAME_SIZE                64
+
+// Default detection parameters. Levels are in dB, relative to an RMS of one 16 bit LSB.
+#define ONSET_DEFAULT_THRESHOLD_DB      10      // Rise above the background level that marks an onset.
+#define ONSET_DEFAULT_MINIMUM_DB        60      // Level an onset must reach, so small rises in near silence are ignored.
+#define ONSET_DEFAULT_DECAY_DB          10      // Fall from the peak that confirms the sound was a short, sharp one.
+#define ONSET_DEFAULT_MAX_DURATION_MS   80      // Time within which the decay must happen.
+#define ONSET_DEFAULT_REFRACTORY_MS     100     // Time after a clap during which onsets are ignored.
+
+// Background level smoothing, as right shifts. The background follows falls quickly but rises slowly,
+// so it tracks the noise floor rather than being pulled up by the start of an onset.
+#define ONSET_BACKGROUND_RISE_SHIFT     6
+#define ONSET_BACKGROUND_FALL_SHIFT     3
+
+/**
+ * A DataSink that detects claps and similar percussive sounds in its upstream.
+ *
+ * The stream is first differenced (a cheap high pass filter that removes any DC offset and emphasises
+ * the broadband energy of a transient), then the log energy of each ONSET_FRAME_SIZE frame is compared
+ * against a slowly moving background level in fixed point. An onset is a rise of at least the threshold
+ * above the background. It is only reported as a clap if the level then decays again within the maximum
+ * duration, so sustained loud sounds are rejected. Since only level differences are used, no gain
+ * normalisation is needed upstream.
+ *
+ * Each clap raises ONSET_EVT_CLAP, timestamped (in microseconds) with the start of the onset frame.
+ */
+class OnsetDetector : public DataSink
+{
+    DataSource      &upstream;
+    uint16_t        id;
+    int             previous;           // Last sample of the previous buffer, for differencing.
+    int             fill;               // Samples accumulated in the current frame.
+    uint64_t        energy;             // Energy of the current frame, in 16 bit units.
+    int             background;         // Background level, in hundredths of a dB. Negative until the first frame.
+    int             peak;               // Peak level of the current candidate, in hundredths of a dB.
+    int             candidateFrames;    // Frames since the current candidate onset, or -1 if there is none.
+    int             refractoryFrames;   // Frames remaining in the refractory period.
+    uint32_t        position;           // Samples analysed since the detector was created.
+    uint32_t        candidatePosition;
+    CODAL_TIMESTAMP candidateTime;
+    uint32_t        onsetPosition;
+    uint32_t        claps;
+
+    int             threshold;          // Parameters, in hundredths of a dB.
+    int             minimum;
+    int             decay;
+    int             maxDurationMs;
+    int             refractoryMs;
+
+    /**
+     * Analyses the given buffer, interpreted as type T.
+     */
+    template <typename T> int analyseBuffer(ManagedBuffer &buf);
+
+    /**
+     * Moves the background level towards the level of a frame.
+     */
+    void updateBackground(int level);
+
+    /**
+     * Updates the detector with the level of a completed frame.
+     * @param time the time at which the frame started, in microseconds.
+     */
+    void analyseFrame(int level, CODAL_TIMESTAMP time);
+
+    public:
+    /**
+     * Creates an OnsetDetector attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to analyse.
+     * @param id the ID used to raise ONSET_EVT_CLAP events.
+     */
+    OnsetDetector(DataSource &source, uint16_t id = DEVICE_ID_ONSET_DETECTOR);
+
+    /**
+     * Callback provided when data is ready.
+     * @return DEVICE_OK, or DEVICE_NOT_SUPPORTED if the upstream format cannot be analysed.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Sets the rise above the background level, in dB, that marks an onset.
+     */
+    void setThreshold(int dB);
+
+    /**
+     * Sets the level, in dB, that an onset must reach to be considered.
+     */
+    void setMinimumLevel(int dB);
+
+    /**
+     * Sets how far, in dB, the level must fall from its peak, and how quickly, for an onset to be reported as a clap.
+     */
+    void setDecay(int dB, int maxDurationMs);
+
+    /**
+     * Sets the time after each clap during which further onsets are ignored.
+     */
+    void setRefractoryPeriod(int ms);
+
+    /**
+     * Determines the number of claps detected since the detector was created.
+     */
+    uint32_t getClapCount();
+
+    /**
+     * Determines the position of the most recent clap, in samples since the detector was created.
+     */
+    uint32_t getOnsetPosition();
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "MicroBit.h"
+#include "OnsetDetector.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define ONSET_REPLAY_SAMPLE_RATE    11000
+#define ONSET_REPLAY_BUFFER_SIZE    256
+#define ONSET_REPLAY_DURATION_MS    12000
+#define ONSET_REPLAY_TOLERANCE_MS   20
+
+#define ONSET_REPLAY_CLAP           0       // A burst of noise with a fast exponential decay.
+#define ONSET_REPLAY_NOISE          1       // Sustained noise, with an abrupt start.
+#define ONSET_REPLAY_TONE           2       // A sustained 440Hz square wave, with an abrupt start.
+
+struct OnsetReplayEvent
+{
+    int startMs;
+    int durationMs;
+    int amplitude;                          // Peak amplitude, in 8 bit units.
+    int type;
+};
+
+/**
+ * The replayed scene: claps of several levels, a quick double clap, a clap over a tone, and sustained
+ * sounds with sharp onsets that must not be counted.
+ */
+static const OnsetReplayEvent onset_replay_script[] = {
+    {500, 60, 100, ONSET_REPLAY_CLAP},
+    {1500, 60, 60, ONSET_REPLAY_CLAP},
+    {2500, 60, 25, ONSET_REPLAY_CLAP},
+    {3500, 1000, 60, ONSET_REPLAY_NOISE},
+    {5000, 60, 100, ONSET_REPLAY_CLAP},
+    {5250, 60, 100, ONSET_REPLAY_CLAP},
+    {6000, 1500, 30, ONSET_REPLAY_TONE},
+    {6700, 60, 100, ONSET_REPLAY_CLAP},
+    {8500, 60, 80, ONSET_REPLAY_CLAP},
+    {9500, 1000, 90, ONSET_REPLAY_NOISE},
+    {11000, 60, 40, ONSET_REPLAY_CLAP}
+};
+
+#define ONSET_REPLAY_EVENTS (int)(sizeof(onset_replay_script) / sizeof(onset_replay_script[0]))
+
+/**
+ * A DataSource that replays a stream to the OnsetDetector, one buffer at a time. Each buffer is prepared
+ * ahead of its pull, so the cost of preparing it is not included in the benchmark.
+ */
+class OnsetReplaySource : public DataSource
+{
+    protected:
+    int format;
+
+    public:
+    ManagedBuffer buffer;
+    int position;
+
+    OnsetReplaySource(int format)
+    {
+        this->format = format;
+        this->position = 0;
+    }
+
+    /**
+     * Prepares the next buffer, and advances the position past it.
+     * @return false if the stream has ended.
+     */
+    virtual bool prepare() = 0;
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return format;
+    }
+};
+
+/**
+ * Synthesises the replay script, with a low level noise floor.
+ */
+class OnsetSyntheticSource : public OnsetReplaySource
+{
+    uint32_t seed;
+
+    int noise()
+    {
+        seed = seed * 1664525 + 1013904223;
+        return (int)(seed >> 16) - 32768;
+    }
+
+    public:
+    OnsetSyntheticSource(int format) : OnsetReplaySource(format)
+    {
+        this->seed = 1;
+    }
+
+    virtual bool prepare()
+    {
+        if (position >= ONSET_REPLAY_DURATION_MS * (ONSET_REPLAY_SAMPLE_RATE / 1000))
+            return false;
+
+        buffer = ManagedBuffer(ONSET_REPLAY_BUFFER_SIZE * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format));
+
+        for (int i = 0; i < ONSET_REPLAY_BUFFER_SIZE; i++, position++)
+        {
+            int ms = position / (ONSET_REPLAY_SAMPLE_RATE / 1000);
+
+            // Noise floor of about one 8 bit LSB, in 16 bit units.
+            int v = noise() >> 7;
+
+            for (int e = 0; e < ONSET_REPLAY_EVENTS; e++)
+            {
+                const OnsetReplayEvent &ev = onset_replay_script[e];
+
+                if (ms < ev.startMs || ms >= ev.startMs + ev.durationMs)
+                    continue;
+
+                int t = position - ev.startMs * (ONSET_REPLAY_SAMPLE_RATE / 1000);
+                int a = ev.amplitude << 8;
+
+                if (ev.type == ONSET_REPLAY_CLAP)
+                {
+                    // An 8ms time constant.
+                    a = (int)(a * expf(-(float)t / (0.008f * ONSET_REPLAY_SAMPLE_RATE)));
+                    v += (noise() * a) >> 15;
+                }
+                else if (ev.type == ONSET_REPLAY_NOISE)
+                {
+                    v += (noise() * a) >> 15;
+                }
+                else
+                {
+                    v += (t * 440 * 2 / ONSET_REPLAY_SAMPLE_RATE) & 1 ? a : -a;
+                }
+            }
+
+            v = v > 32767 ? 32767 : v < -32768 ? -32768 : v;
+
+            if (format == DATASTREAM_FORMAT_16BIT_SIGNED)
+                ((int16_t *)&buffer[0])[i] = v;
+            else
+                buffer[i] = (uint8_t)(int8_t)(v >> 8);
+        }
+
+        return true;
+    }
+
+    virtual float getSampleRate()
+    {
+        return ONSET_REPLAY_SAMPLE_RATE;
+    }
+};
+
+/**
+ * Replays the stream from the given source through an OnsetDetector, and reports detection accuracy
+ * against the given clap times (hits, misses, false detections and mean timing error), and the cost of
+ * the detector in cycles per buffer.
+ *
+ * @param source the stream to replay.
+ * @param claps the start time of each clap in the stream, in milliseconds.
+ * @param count the number of claps.
+ * @param name the name of the stream, for the report.
+ */
+static void
+onset_replay_score(OnsetReplaySource &source, const int *claps, int count, const char *name)
+{
+    OnsetDetector detector(source);
+    int samplesPerMs = (int)source.getSampleRate() / 1000;
+
+    bool *matched = new bool[count]();
+    int hits = 0, misses = 0, falseDetections = 0, timingError = 0;
+    uint32_t detected = 0, cycles = 0, worst = 0, buffers = 0;
+
+    while (source.prepare())
+    {
+        uint32_t start = cycle_counter_read();
+        detector.pullRequest();
+        uint32_t c = cycle_counter_read() - start;
+
+        cycles += c;
+        worst = max(worst, c);
+        buffers++;
+
+        if (detector.getClapCount() == detected)
+            continue;
+
+        detected = detector.getClapCount();
+
+        int ms = detector.getOnsetPosition() / samplesPerMs;
+        int best = -1;
+
+        for (int e = 0; e < count; e++)
+            if (!matched[e] && abs(ms - claps[e]) <= ONSET_REPLAY_TOLERANCE_MS)
+                best = e;
+
+        if (best < 0)
+        {
+            falseDetections++;
+            DMESG("   FALSE DETECTION AT %d ms", ms);
+            continue;
+        }
+
+        matched[best] = true;
+        hits++;
+        timingError += abs(ms - claps[best]);
+    }
+
+    for (int e = 0; e < count; e++)
+    {
+        if (!matched[e])
+        {
+            misses++;
+            DMESG("   MISSED CLAP AT %d ms", claps[e]);
+        }
+    }
+
+    delete[] matched;
+
+    DMESG("ONSET_DETECTOR_BENCHMARK: %s, %d buffers of up to %d samples", name, (int)buffers, ONSET_REPLAY_BUFFER_SIZE);
+    DMESG("   CLAPS: %d expected, %d hits, %d misses, %d false", count, hits, misses, falseDetections);
+    DMESG("   MEAN TIMING ERROR: %d ms", hits ? timingError / hits : 0);
+    DMESG("   CYCLES: %d/buffer mean, %d worst", (int)(cycles / max(buffers, (uint32_t)1)), (int)worst);
+}
+
+/**
+ * Replays a synthetic scene through the OnsetDetector, for 8 and 16 bit streams, and reports detection
+ * accuracy against the known clap times (hits, misses, false detections and mean timing error), and
+ * the cost of the detector in cycles per buffer.
+ */
+void
+onset_detector_benchmark()
+{
+    int claps[ONSET_REPLAY_EVENTS];
+    int count = 0;
+
+    for (int e = 0; e < ONSET_REPLAY_EVENTS; e++)
+        if (onset_replay_script[e].type == ONSET_REPLAY_CLAP)
+            claps[count++] = onset_replay_script[e].startMs;
+
+    cycle_counter_enable();
+
+    OnsetSyntheticSource source8(DATASTREAM_FORMAT_8BIT_SIGNED);
+    onset_replay_score(source8, claps, count, "SYNTHETIC 8 bit");
+
+    OnsetSyntheticSource source16(DATASTREAM_FORMAT_16BIT_SIGNED);
+    onset_replay_score(source16, claps, count, "SYNTHETIC 16 bit");
+}
+
+#if CONFIG_ENABLED(ONSET_REPLAY_RECORDING)
+#include "OnsetReplayRecording.h"
+
+/**
+ * Hands out a labelled recording compiled into flash, generated by utils/audio/onset_replay_gen.py.
+ */
+class OnsetRecordingSource : public OnsetReplaySource
+{
+    public:
+    OnsetRecordingSource() : OnsetReplaySource(ONSET_RECORDING_FORMAT)
+    {
+    }
+
+    virtual bool prepare()
+    {
+        int bytes = DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format);
+        int n = min(ONSET_REPLAY_BUFFER_SIZE, ONSET_RECORDING_SAMPLES - position);
+
+        if (n <= 0)
+            return false;
+
+        buffer = ManagedBuffer((uint8_t *)&onset_recording_pcm[position * bytes], n * bytes);
+        position += n;
+
+        return true;
+    }
+
+    virtual float getSampleRate()
+    {
+        return ONSET_RECORDING_SAMPLE_RATE;
+    }
+};
+#endif
+
+/**
+ * Replays a real capture (for example, a framed serial stream received with utils/audio/serial_receiver.py)
+ * through the OnsetDetector, and scores it against hand labelled clap times, as onset_detector_benchmark does.
+ * The capture is compiled in by utils/audio/onset_replay_gen.py, and included when ONSET_REPLAY_RECORDING
+ * is enabled in codal.json.
+ */
+void
+onset_detector_recording_benchmark()
+{
+#if CONFIG_ENABLED(ONSET_REPLAY_RECORDING)
+    cycle_counter_enable();
+
+    OnsetRecordingSource source;
+    onset_replay_score(source, onset_recording_claps, ONSET_RECORDING_CLAPS, "RECORDING");
+#else
+    DMESG("ONSET_DETECTOR_RECORDING_BENCHMARK: no recording. Generate one with utils/audio/onset_replay_gen.py, and enable ONSET_REPLAY_RECORDING.");
+#endif
+}
@@ -0,0 +1,339 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "OutputPrefetcher.h"
+
+/**
+ * Creates an OutputPrefetcher attached to the given source.
+ * The output has the same format and sample rate as the input.
+ *
+ * @param source the DataSource to prefetch from.
+ * @param depth the number of buffers to hold ready, from 1 to OUTPUT_PREFETCHER_MAX_DEPTH.
+ */
+OutputPrefetcher::OutputPrefetcher(DataSource &source, int depth) : CodalComponent(DEVICE_ID_OUTPUT_PREFETCHER, 0), upstream(source)
+{
+    this->downstream = NULL;
+    this->head = 0;
+    this->queued = 0;
+    this->pending = 0;
+    this->filling = false;
+    this->started = false;
+    this->held = false;
+    this->lastPullTime = 0;
+    this->lastDuration = 0;
+
+    setDepth(depth);
+    resetStatistics();
+
+    // Size the hold buffer when idle, once the length of the buffers being played is known.
+    status |= DEVICE_COMPONENT_STATUS_IDLE_TICK;
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Destructor.
+ */
+OutputPrefetcher::~OutputPrefetcher()
+{
+    status &= ~DEVICE_COMPONENT_STATUS_IDLE_TICK;
+}
+
+/**
+ * Resizes the hold buffer to the length of the buffers being played. Called by the scheduler when idle.
+ */
+void
+OutputPrefetcher::idleCallback()
+{
+    int length = last.length();
+
+    if (length == 0 || length == silence.length())
+        return;
+
+    ManagedBuffer b(length);
+
+    // Swap the new buffer in between pulls. The old one is released here, rather than on the audio path.
+    target_disable_irq();
+    ManagedBuffer old = silence;
+    silence = b;
+    target_enable_irq();
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller.
+ */
+ManagedBuffer
+OutputPrefetcher::pull()
+{
+    uint32_t now = (uint32_t)system_timer_current_time_us();
+    ManagedBuffer buf;
+
+    if (queued)
+    {
+        int slack = (int)(now - readyTime[head]);
+
+        if (slack < worstSlack)
+            worstSlack = slack;
+
+        buf = queue[head];
+        queue[head] = ManagedBuffer();
+        head = (head + 1) % OUTPUT_PREFETCHER_MAX_DEPTH;
+        queued--;
+    }
+    else
+    {
+        buf = hold();
+        underruns++;
+        held = true;
+    }
+
+    int bytesPerSample = DATASTREAM_FORMAT_BYTES_PER_SAMPLE(getFormat());
+    float rate = getSampleRate();
+
+    last = buf;
+    lastPullTime = now;
+    lastDuration = rate > 0 && bytesPerSample > 0 ? (uint32_t)((buf.length() / bytesPerSample) * 1000000.0f / rate) : 0;
+    started = true;
+    buffers++;
+
+    // Pull the next buffer while this one plays.
+    fill();
+
+    return buf;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+OutputPrefetcher::pullRequest()
+{
+    pending++;
+    fill();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Pulls announced buffers from our upstream until the queue is full.
+ */
+void
+OutputPrefetcher::fill()
+{
+    // The upstream may announce its next buffer from within pull(). The outer call picks it up.
+    if (filling)
+        return;
+
+    filling = true;
+
+    while (pending > 0 && queued < depth)
+    {
+        pending--;
+
+        ManagedBuffer buf = upstream.pull();
+
+        if (buf.length())
+            enqueue(buf);
+    }
+
+    filling = false;
+}
+
+/**
+ * Adds the given buffer to the queue, records its timing, and tells the output it is available.
+ */
+void
+OutputPrefetcher::enqueue(ManagedBuffer &buf)
+{
+    uint32_t now = (uint32_t)system_timer_current_time_us();
+
+    // With nothing queued, this buffer is all that stands between the output and silence.
+    if (started && queued == 0)
+    {
+        int remaining = (int)(lastPullTime + lastDuration - now);
+
+        if (remaining < 0)
+        {
+            // If the output has already taken a hold buffer for this gap, it was counted then.
+            if (!held)
+                underruns++;
+
+            if (remaining < worstSlack)
+                worstSlack = remaining;
+        }
+        else
+        {
+            latePulls++;
+        }
+    }
+
+    int tail = (head + queued) % OUTPUT_PREFETCHER_MAX_DEPTH;
+
+    queue[tail] = buf;
+    readyTime[tail] = now;
+    queued++;
+    held = false;
+
+    if (downstream)
+        downstream->pullRequest();
+}
+
+/**
+ * Fills the hold buffer with the final sample of the last buffer, and returns it.
+ */
+ManagedBuffer
+OutputPrefetcher::hold()
+{
+    int bytesPerSample = DATASTREAM_FORMAT_BYTES_PER_SAMPLE(getFormat());
+
+    // Not sized yet: the idle callback has not run since the first buffer was played.
+    if (silence.length() == 0)
+        return last;
+
+    if (bytesPerSample <= 0 || last.length() < bytesPerSample)
+        return silence;
+
+    // If the output is still playing the hold buffer, it holds this same sample, so it can be refilled in place.
+    uint8_t *sample = &last[0] + last.length() - bytesPerSample;
+
+    for (int i = 0; i + bytesPerSample <= silence.length(); i += bytesPerSample)
+        memmove(&silence[i], sample, bytesPerSample);
+
+    return silence;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+OutputPrefetcher::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+OutputPrefetcher::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+OutputPrefetcher::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+OutputPrefetcher::getFormat()
+{
+    return upstream.getFormat();
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+OutputPrefetcher::getSampleRate()
+{
+    return upstream.getSampleRate();
+}
+
+/**
+ * Sets the number of buffers to hold ready.
+ * @param depth the depth, from 1 to OUTPUT_PREFETCHER_MAX_DEPTH.
+ */
+void
+OutputPrefetcher::setDepth(int depth)
+{
+    this->depth = min(max(depth, 1), OUTPUT_PREFETCHER_MAX_DEPTH);
+}
+
+/**
+ * Determines the number of buffers currently queued ahead of the output.
+ */
+int
+OutputPrefetcher::getQueuedCount()
+{
+    return queued;
+}
+
+/**
+ * Determines the number of underruns since the statistics were last reset.
+ */
+uint32_t
+OutputPrefetcher::getUnderrunCount()
+{
+    return underruns;
+}
+
+/**
+ * Determines the number of late pulls since the statistics were last reset.
+ */
+uint32_t
+OutputPrefetcher::getLatePullCount()
+{
+    return latePulls;
+}
+
+/**
+ * Determines the number of buffers handed to the output since the statistics were last reset.
+ */
+uint32_t
+OutputPrefetcher::getBufferCount()
+{
+    return buffers;
+}
+
+/**
+ * Determines the worst case slack since the statistics were last reset, in microseconds.
+ * @return the smallest slack seen, negative if a buffer arrived after it was needed, or 0 if no buffers have been played.
+ */
+int
+OutputPrefetcher::getWorstSlack()
+{
+    return buffers ? worstSlack : 0;
+}
+
+/**
+ * Clears the counters and the worst case slack.
+ */
+void
+OutputPrefetcher::resetStatistics()
+{
+    underruns = 0;
+    latePulls = 0;
+    buffers = 0;
+    worstSlack = 0x7FFFFFFF;
+}
@@ -0,0 +1,191 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef OUTPUT_PREFETCHER_H
+#define OUTPUT_PREFETCHER_H
+
+#define DEVICE_ID_OUTPUT_PREFETCHER 9017
+
+// Number of buffers held ready ahead of the output. Two gives ping-pong buffering: one buffer playing,
+// and the next already pulled.
+#define OUTPUT_PREFETCHER_DEFAULT_DEPTH     2
+#define OUTPUT_PREFETCHER_MAX_DEPTH         4
+
+/**
+ * A DataSource and DataSink that sits directly in front of an output such as NRF52PWM, and keeps the
+ * next buffers pulled from its upstream ahead of time, so the output never waits on the upstream while
+ * its DMA sequence is playing.
+ *
+ * Buffers announced by the upstream are pulled as soon as there is a free slot, up to the configured
+ * depth, and each time the output takes a buffer the freed slot is refilled straight away, so the next
+ * buffer is computed while the current one plays. If the output asks for data with nothing queued, the
+ * last sample is held for one buffer rather than leaving a gap.
+ *
+ * The hold buffer is allocated ahead of time by the idle callback, at the length of the buffers being
+ * played, so nothing is allocated when the output runs dry. Until the first idle tick, the last buffer
+ * is repeated instead.
+ *
+ * Timing is recorded so buffer sizes and depths can be tuned:
+ *  - an underrun is a hold buffer, or a buffer that arrived after the output had finished the previous one
+ *    without a hold buffer having been played in its place. Each gap is counted once.
+ *  - a late pull is a buffer that arrived in time, but with nothing queued ahead of it.
+ *  - the slack of a buffer is the time from it arriving to the output taking it, or how late it was.
+ */
+class OutputPrefetcher : public CodalComponent, public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    ManagedBuffer   queue[OUTPUT_PREFETCHER_MAX_DEPTH];
+    uint32_t        readyTime[OUTPUT_PREFETCHER_MAX_DEPTH];     // Time each queued buffer arrived, in microseconds.
+    int             head;
+    int             queued;
+    int             depth;
+    int             pending;            // Buffers the upstream has announced, but that have not been pulled.
+    bool            filling;
+    bool            started;            // True once the output has taken its first buffer.
+    bool            held;               // True if the output was given a hold buffer since the last buffer arrived.
+    ManagedBuffer   last;               // Most recent buffer handed to the output.
+    ManagedBuffer   silence;            // Preallocated hold buffer, sized by the idle callback.
+    uint32_t        lastPullTime;       // Time the output took that buffer, in microseconds.
+    uint32_t        lastDuration;       // Playing time of that buffer, in microseconds.
+
+    uint32_t        underruns;
+    uint32_t        latePulls;
+    uint32_t        buffers;
+    int             worstSlack;         // Smallest slack seen, in microseconds. Negative if a buffer was late.
+
+    /**
+     * Pulls announced buffers from our upstream until the queue is full.
+     */
+    void fill();
+
+    /**
+     * Adds the given buffer to the queue, records its timing, and tells the output it is available.
+     */
+    void enqueue(ManagedBuffer &buf);
+
+    /**
+     * Fills the hold buffer with the final sample of the last buffer, and returns it.
+     */
+    ManagedBuffer hold();
+
+    public:
+    /**
+     * Creates an OutputPrefetcher attached to the given source.
+     * The output has the same format and sample rate as the input.
+     *
+     * @param source the DataSource to prefetch from.
+     * @param depth the number of buffers to hold ready, from 1 to OUTPUT_PREFETCHER_MAX_DEPTH.
+     */
+    OutputPrefetcher(DataSource &source, int depth = OUTPUT_PREFETCHER_DEFAULT_DEPTH);
+
+    /**
+     * Destructor.
+     */
+    ~OutputPrefetcher();
+
+    /**
+     * Resizes the hold buffer to the length of the buffers being played. Called by the scheduler when idle.
+     */
+    virtual void idleCallback();
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Sets the number of buffers to hold ready.
+     * @param depth the depth, from 1 to OUTPUT_PREFETCHER_MAX_DEPTH.
+     */
+    void setDepth(int depth);
+
+    /**
+     * Determines the number of buffers currently queued ahead of the output.
+     */
+    int getQueuedCount();
+
+    /**
+     * Determines the number of underruns since the statistics were last reset.
+     */
+    uint32_t getUnderrunCount();
+
+    /**
+     * Determines the number of late pulls since the statistics were last reset.
+     */
+    uint32_t getLatePullCount();
+
+    /**
+     * Determines the number of buffers handed to the output since the statistics were last reset.
+     */
+    uint32_t getBufferCount();
+
+    /**
+     * Determines the worst case slack since the statistics were last reset, in microseconds.
+     * @return the smallest slack seen, negative if a buffer arrived after it was needed, or 0 if no buffers have been played.
+     */
+    int getWorstSlack();
+
+    /**
+     * Clears the counters and the worst case slack.
+     */
+    void resetStatistics();
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "MicroBit.h"
+#include "OutputPrefetcher.h"
+#include "Tests.h"
+
+#define OUTPUT_PREFETCHER_TEST_RATE     8000
+#define OUTPUT_PREFETCHER_TEST_SAMPLES  256         // 32ms per buffer.
+#define OUTPUT_PREFETCHER_TEST_LATE_MS  80          // Long enough for a buffer to miss its slot.
+
+/**
+ * A DataSource that hands out a ramp on every pull, in 16 bit signed samples, so each buffer ends on a known sample.
+ */
+class OutputPrefetcherTestSource : public DataSource
+{
+    public:
+    int16_t next;
+
+    virtual ManagedBuffer pull()
+    {
+        ManagedBuffer b(OUTPUT_PREFETCHER_TEST_SAMPLES * sizeof(int16_t));
+        int16_t *p = (int16_t *)&b[0];
+
+        for (int i = 0; i < OUTPUT_PREFETCHER_TEST_SAMPLES; i++)
+            p[i] = next++;
+
+        return b;
+    }
+
+    virtual int getFormat()
+    {
+        return DATASTREAM_FORMAT_16BIT_SIGNED;
+    }
+
+    virtual float getSampleRate()
+    {
+        return OUTPUT_PREFETCHER_TEST_RATE;
+    }
+};
+
+static int output_prefetcher_test_errors;
+
+static void output_prefetcher_test_check(const char *step, OutputPrefetcher &prefetcher, uint32_t underruns)
+{
+    if (prefetcher.getUnderrunCount() != underruns)
+    {
+        output_prefetcher_test_errors++;
+        DMESG("   %s: %d UNDERRUNS, EXPECTED %d", step, prefetcher.getUnderrunCount(), underruns);
+    }
+}
+
+/**
+ * Checks that a hold buffer is the length of the last buffer, and holds its final sample.
+ */
+static void output_prefetcher_test_hold(ManagedBuffer &hold, int16_t sample)
+{
+    int16_t *p = (int16_t *)&hold[0];
+    bool ok = hold.length() == OUTPUT_PREFETCHER_TEST_SAMPLES * (int)sizeof(int16_t);
+
+    for (int i = 0; ok && i < OUTPUT_PREFETCHER_TEST_SAMPLES; i++)
+        ok = p[i] == sample;
+
+    if (!ok)
+    {
+        output_prefetcher_test_errors++;
+        DMESG("   HOLD: LENGTH %d, EXPECTED %d SAMPLES OF %d", hold.length(), OUTPUT_PREFETCHER_TEST_SAMPLES, sample);
+    }
+}
+
+/**
+ * Drives an OutputPrefetcher by hand through the ways an output can run dry, and checks that each gap is
+ * counted as exactly one underrun: a hold buffer, a late buffer after a hold buffer (not counted again), and
+ * a late buffer the output did not have to wait for. Also checks that the hold buffer sized by the idle
+ * callback holds the last sample. Results are written to DMESG.
+ */
+void
+output_prefetcher_test()
+{
+    OutputPrefetcherTestSource source;
+    source.next = 0;
+
+    OutputPrefetcher prefetcher(source);
+    ManagedBuffer b;
+
+    output_prefetcher_test_errors = 0;
+
+    DMESG("OUTPUT_PREFETCHER_TEST: STARTING...");
+
+    // A buffer in time.
+    prefetcher.pullRequest();
+    prefetcher.pull();
+    output_prefetcher_test_check("IN TIME", prefetcher, 0);
+
+    // The output runs dry before the idle callback has sized the hold buffer, so the last buffer is repeated.
+    b = prefetcher.pull();
+    output_prefetcher_test_check("HOLD", prefetcher, 1);
+
+    if (b.length() != OUTPUT_PREFETCHER_TEST_SAMPLES * (int)sizeof(int16_t) || ((int16_t *)&b[0])[0] != 0)
+    {
+        output_prefetcher_test_errors++;
+        DMESG("   HOLD: LAST BUFFER NOT REPEATED");
+    }
+
+    // The buffer for that gap arrives late. It was counted when the hold buffer was played.
+    uBit.sleep(OUTPUT_PREFETCHER_TEST_LATE_MS);
+    prefetcher.pullRequest();
+    output_prefetcher_test_check("LATE AFTER HOLD", prefetcher, 1);
+
+    // Size the hold buffer, then run dry again.
+    b = prefetcher.pull();
+    prefetcher.idleCallback();
+    b = prefetcher.pull();
+    output_prefetcher_test_check("SIZED HOLD", prefetcher, 2);
+    output_prefetcher_test_hold(b, source.next - 1);
+
+    // A second hold in a row refills the same buffer with the same sample.
+    b = prefetcher.pull();
+    output_prefetcher_test_check("SECOND HOLD", prefetcher, 3);
+    output_prefetcher_test_hold(b, source.next - 1);
+
+    // A buffer arrives late, but the output had not asked for data in the meantime.
+    prefetcher.pullRequest();
+    prefetcher.pull();
+    uBit.sleep(OUTPUT_PREFETCHER_TEST_LATE_MS);
+    prefetcher.pullRequest();
+    output_prefetcher_test_check("LATE", prefetcher, 4);
+
+    if (prefetcher.getWorstSlack() >= 0)
+    {
+        output_prefetcher_test_errors++;
+        DMESG("   WORST SLACK: %d us, EXPECTED < 0", prefetcher.getWorstSlack());
+    }
+
+    DMESG("   BUFFERS: %d, UNDERRUNS: %d, LATE PULLS: %d, WORST SLACK: %d us", prefetcher.getBufferCount(),
+        prefetcher.getUnderrunCount(), prefetcher.getLatePullCount(), prefetcher.getWorstSlack());
+    DMESG("   RESULTS: %s", output_prefetcher_test_errors == 0 ? "PASS" : "FAIL");
+}
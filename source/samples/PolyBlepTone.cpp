@@ -0,0 +1,148 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "PolyBlepTone.h"
+
+/**
+ * The phase increment of a voice, measured from the positions it is called with.
+ */
+struct PolyBlepTracker
+{
+    void    *voice;     // The arg the voice passes to the tone print.
+    bool    used;
+    int     last;       // The most recent position.
+    int     step;       // The mean phase increment per sample, in positions with POLYBLEP_STEP_BITS fractional bits.
+};
+
+/**
+ * The trackers of one tone print.
+ */
+struct PolyBlepTrackers
+{
+    PolyBlepTracker voices[POLYBLEP_MAX_VOICES];
+    int             next;       // The tracker a new voice takes over.
+};
+
+static PolyBlepTrackers polyblep_saw;
+static PolyBlepTrackers polyblep_square;
+
+/**
+ * Finds the tracker of the voice with the given arg, taking over the longest held tracker for a new voice.
+ */
+static inline PolyBlepTracker &polyblep_voice(PolyBlepTrackers &trackers, void *arg)
+{
+    for (int i = 0; i < POLYBLEP_MAX_VOICES; i++)
+        if (trackers.voices[i].used && trackers.voices[i].voice == arg)
+            return trackers.voices[i];
+
+    PolyBlepTracker &t = trackers.voices[trackers.next];
+    trackers.next = (trackers.next + 1) % POLYBLEP_MAX_VOICES;
+
+    t.voice = arg;
+    t.used = true;
+    t.last = 0;
+    t.step = 1 << POLYBLEP_STEP_BITS;
+
+    return t;
+}
+
+/**
+ * Updates a tracker with the next position, and returns the phase increment.
+ * Increments of half a cycle or more are taken to be a change of note, rather than a frequency, and ignored.
+ */
+static inline int polyblep_track(PolyBlepTracker &t, int position)
+{
+    int delta = (position - t.last) & (POLYBLEP_CYCLE - 1);
+
+    t.last = position;
+
+    if (delta < POLYBLEP_CYCLE / 2)
+        t.step += ((delta << POLYBLEP_STEP_BITS) - t.step) >> POLYBLEP_STEP_SHIFT;
+
+    return max(t.step, 1 << POLYBLEP_STEP_BITS);
+}
+
+/**
+ * Computes the PolyBLEP residual of a rising unit step at position 0, in Q15.
+ *
+ * @param t the position through the cycle, from 0 to POLYBLEP_CYCLE - 1.
+ * @param step the phase increment, with POLYBLEP_STEP_BITS fractional bits.
+ * @return the residual, from -32768 just after the step to 32768 just before it, or 0 away from it.
+ */
+static inline int polyblep_residual(int t, int step)
+{
+    int x;
+
+    t <<= POLYBLEP_STEP_BITS;
+
+    // Just after the step: x = t / dt, residual = 2x - x^2 - 1.
+    if (t < step)
+    {
+        x = (t << 15) / step;
+        return 2 * x - ((x * x) >> 15) - 32768;
+    }
+
+    // Just before the step: x = (t - 1) / dt, residual = x^2 + 2x + 1.
+    t -= POLYBLEP_CYCLE << POLYBLEP_STEP_BITS;
+
+    if (-t < step)
+    {
+        x = (t << 15) / step;
+        return ((x * x) >> 15) + 2 * x + 32768;
+    }
+
+    return 0;
+}
+
+/**
+ * Converts a Q15 value from -1 to 1 to the 0 to 1023 range of a tone print.
+ */
+static inline uint16_t polyblep_output(int v)
+{
+    v = 512 + ((v * 511) >> 15);
+
+    return (uint16_t)(v < 0 ? 0 : v > 1023 ? 1023 : v);
+}
+
+/**
+ * A rising sawtooth, falling at the start of each cycle.
+ */
+uint16_t PolyBlepTone::SawtoothTone(void *arg, int position)
+{
+    int step = polyblep_track(polyblep_voice(polyblep_saw, arg), position);
+    int naive = (position << (15 - POLYBLEP_POSITION_BITS + 1)) - 32768;
+
+    return polyblep_output(naive - polyblep_residual(position, step));
+}
+
+/**
+ * A square, high for the first half cycle.
+ */
+uint16_t PolyBlepTone::SquareWaveTone(void *arg, int position)
+{
+    int step = polyblep_track(polyblep_voice(polyblep_square, arg), position);
+    int naive = position < POLYBLEP_CYCLE / 2 ? 32767 : -32768;
+
+    return polyblep_output(naive + polyblep_residual(position, step) - polyblep_residual((position + POLYBLEP_CYCLE / 2) & (POLYBLEP_CYCLE - 1), step));
+}
@@ -0,0 +1,65 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+
+#ifndef POLYBLEP_TONE_H
+#define POLYBLEP_TONE_H
+
+// Tone prints are given a position from 0 to 2^POLYBLEP_POSITION_BITS - 1 through each cycle.
+#define POLYBLEP_POSITION_BITS      10
+#define POLYBLEP_CYCLE              (1 << POLYBLEP_POSITION_BITS)
+
+// The phase increment is tracked with POLYBLEP_STEP_BITS fractional bits, averaged with a shift of
+// POLYBLEP_STEP_SHIFT, so the quantisation of the position to whole steps averages out.
+#define POLYBLEP_STEP_BITS          4
+#define POLYBLEP_STEP_SHIFT         2
+
+// Number of voices of each tone print whose phase increments are tracked at once.
+#define POLYBLEP_MAX_VOICES         4
+
+/**
+ * Band limited square and sawtooth tone prints for Synthesizer and SoundEmojiSynthesizer, in fixed point.
+ *
+ * The naive waveforms jump between extremes in a single sample, and every harmonic above the Nyquist
+ * frequency folds back into the audible band. These tone prints subtract a two sample polynomial
+ * band limited step (PolyBLEP) at each discontinuity, which removes most of that aliasing for a few
+ * cycles per sample, so a 16kHz stream sounds cleaner than the naive waves at 44.1kHz.
+ *
+ * The residual depends on the phase increment per sample, which a tone print is not given, so it is
+ * measured from successive positions. Voices are told apart by the arg they pass to the tone print (for
+ * SoundEmojiSynthesizer, the parameters of the sound effect), which is used only as a key. Up to
+ * POLYBLEP_MAX_VOICES voices of each tone print are tracked at once, and a new voice takes over the
+ * longest held tracker. Voices that pass the same arg share a tracker. A change of note settles within
+ * a few samples. Every tone print returns a value from 0 to 1023.
+ */
+class PolyBlepTone
+{
+    public:
+    static uint16_t SawtoothTone(void *arg, int position);
+    static uint16_t SquareWaveTone(void *arg, int position);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "MicroBit.h"
+#include "Synthesizer.h"
+#include "PolyBlepTone.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define POLYBLEP_BENCHMARK_SAMPLES      4096
+
+typedef uint16_t (*PolyBlepBenchmarkTone)(void *arg, int position);
+
+/**
+ * Measures the mean cost of a tone print, called through a pointer as the synthesizers do, in hundredths of a cycle per sample.
+ * Positions advance by the given step, as they would for a tone at a fixed frequency.
+ */
+static int
+polyblep_benchmark_cost(PolyBlepBenchmarkTone tone, int step)
+{
+    volatile uint32_t sum = 0;
+
+    uint32_t start = cycle_counter_read();
+    for (int i = 0; i < POLYBLEP_BENCHMARK_SAMPLES; i++)
+        sum += tone(NULL, (i * step) & (POLYBLEP_CYCLE - 1));
+
+    return (int)((uint64_t)(cycle_counter_read() - start) * 100 / POLYBLEP_BENCHMARK_SAMPLES);
+}
+
+/**
+ * Compares the cost per sample of the naive Synthesizer square and sawtooth tone prints against their
+ * PolyBLEP equivalents, for a low and a high note at 16kHz, and reports the CPU time each would use to
+ * generate one voice at 16kHz and 44.1kHz. Results are written to DMESG.
+ */
+void
+polyblep_tone_benchmark()
+{
+    static const PolyBlepBenchmarkTone tones[][2] = {
+        {Synthesizer::SawtoothTone, PolyBlepTone::SawtoothTone},
+        {Synthesizer::SquareWaveTone, PolyBlepTone::SquareWaveTone},
+    };
+    static const char *names[] = {"SAWTOOTH", "SQUARE"};
+
+    // 440Hz and 3520Hz at 16kHz.
+    static const int steps[] = {28, 225};
+
+    cycle_counter_enable();
+
+    DMESG("POLYBLEP_TONE_BENCHMARK: %d samples (cycles/sample x 100, CPU %% x 100 at 16kHz and 44.1kHz)", POLYBLEP_BENCHMARK_SAMPLES);
+
+    for (unsigned int t = 0; t < sizeof(names) / sizeof(names[0]); t++)
+    {
+        for (unsigned int s = 0; s < sizeof(steps) / sizeof(steps[0]); s++)
+        {
+            int naive = polyblep_benchmark_cost(tones[t][0], steps[s]);
+            int polyblep = polyblep_benchmark_cost(tones[t][1], steps[s]);
+
+            DMESG("   %s STEP %d: NAIVE %d (%d @ 44.1kHz) POLYBLEP %d (%d @ 16kHz)", names[t], steps[s],
+                naive, (int)((uint64_t)naive * 44100 * 100 / SystemCoreClock),
+                polyblep, (int)((uint64_t)polyblep * 16000 * 100 / SystemCoreClock));
+        }
+    }
+}
@@ -0,0 +1,291 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "RmsLevelDetector.h"
+#include "nrf.h"
+
+// 10 * log10(1 + (i + 0.5) / 64) in hundredths of a dB, for the top 6 bits of the mantissa below the leading 1.
+static const uint16_t rms_level_db_table[64] = {
+    3, 10, 17, 23, 30, 36, 42, 48, 54, 60, 66, 72, 77, 83, 89, 94,
+    100, 105, 110, 116, 121, 126, 131, 136, 141, 146, 150, 155, 160, 165, 169, 174,
+    178, 183, 187, 192, 196, 200, 205, 209, 213, 217, 221, 225, 229, 233, 237, 241,
+    245, 249, 253, 256, 260, 264, 268, 271, 275, 278, 282, 285, 289, 292, 296, 299
+};
+
+// 10 * log10(2) in ten thousandths of a dB.
+#define RMS_LEVEL_DB_PER_OCTAVE 30103
+
+/**
+ * Converts a raw sample into a signed value, centred on zero.
+ */
+static inline int rms_level_sample(int8_t s) { return s; }
+static inline int rms_level_sample(uint8_t s) { return (int)s - 128; }
+static inline int rms_level_sample(int16_t s) { return s; }
+static inline int rms_level_sample(uint16_t s) { return (int)s - 32768; }
+
+/**
+ * Converts a power (such as a mean square) to hundredths of a dB, using integer arithmetic only.
+ * @return 10 * log10(power) * 100, or 0 if power is 0.
+ */
+int rms_level_millibels(uint64_t power)
+{
+    if (power == 0)
+        return 0;
+
+    uint32_t hi = (uint32_t)(power >> 32);
+    int exponent = hi ? 63 - __CLZ(hi) : 31 - __CLZ((uint32_t)power);
+
+    // The 6 bits below the leading 1.
+    int mantissa = exponent >= 6 ? (int)(power >> (exponent - 6)) & 0x3F : (int)(power << (6 - exponent)) & 0x3F;
+
+    return (exponent * RMS_LEVEL_DB_PER_OCTAVE) / 100 + rms_level_db_table[mantissa];
+}
+
+/**
+ * Creates an RmsLevelDetector attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to measure.
+ * @param highThreshold the level, in dB, above which a RMS_LEVEL_EVT_HIGH event is raised.
+ * @param lowThreshold the level, in dB, below which a RMS_LEVEL_EVT_LOW event is raised.
+ * @param gain a calibration gain, in dB, added to every level.
+ * @param id the ID used when raising events.
+ * @param activateImmediately true to measure continuously, false to measure only while read or in event mode.
+ */
+RmsLevelDetector::RmsLevelDetector(DataSource &source, float highThreshold, float lowThreshold, float gain, uint16_t id, bool activateImmediately) : upstream(source)
+{
+    this->id = id;
+    this->windowMs = RMS_LEVEL_DEFAULT_WINDOW_MS;
+    this->windowSamples = 0;
+    this->samples = 0;
+    this->sumSquares = 0;
+    this->gain = (int)(gain * 100);
+    this->level = 0;
+    this->high = false;
+    this->eventMode = false;
+    this->activated = activateImmediately;
+    this->lastRead = (uint32_t)system_timer_current_time();
+    this->unit = RMS_LEVEL_UNIT_DB;
+
+    setHighThreshold(highThreshold);
+    setLowThreshold(lowThreshold);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+RmsLevelDetector::pullRequest()
+{
+    // Nobody is reading us: stop pulling, and start a fresh window when we are read again.
+    if (!activated && !eventMode && (uint32_t)system_timer_current_time() - lastRead > CODAL_STREAM_IDLE_TIMEOUT_MS)
+    {
+        upstream.dataWanted(DATASTREAM_NOT_WANTED);
+        sumSquares = 0;
+        samples = 0;
+        windowSamples = 0;
+        return DEVICE_BUSY;
+    }
+
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return accumulateBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return accumulateBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return accumulateBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return accumulateBuffer<uint16_t>(buf);
+    }
+
+    return DEVICE_NOT_SUPPORTED;
+}
+
+/**
+ * Accumulates the given buffer, interpreted as type T, completing windows as they fill.
+ */
+template <typename T> int
+RmsLevelDetector::accumulateBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    T *end = p + buf.length() / sizeof(T);
+
+    // 8 bit samples are squared in 8 bit units, then scaled to 16 bit units once per run.
+    const int shift = sizeof(T) == 1 ? 16 : 0;
+
+    while (p < end)
+    {
+        if (windowSamples == 0)
+            windowSamples = max(1, (int)(windowMs * upstream.getSampleRate() / 1000));
+
+        int n = min((int)(end - p), windowSamples - samples);
+        T *runEnd = p + n;
+        uint64_t sum = 0;
+        int s;
+
+        while (p < runEnd)
+        {
+            s = rms_level_sample(*p++);
+            sum += (uint32_t)(s * s);
+        }
+
+        sumSquares += sum << shift;
+        samples += n;
+
+        if (samples == windowSamples)
+            completeWindow();
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Computes the level of the completed window, and raises any events.
+ */
+void
+RmsLevelDetector::completeWindow()
+{
+    level = rms_level_millibels(sumSquares / samples) + gain;
+
+    sumSquares = 0;
+    samples = 0;
+    windowSamples = 0;
+
+    if (!high && level > highThreshold)
+    {
+        high = true;
+        MicroBitEvent(id, RMS_LEVEL_EVT_HIGH);
+    }
+
+    if (high && level < lowThreshold)
+    {
+        high = false;
+        MicroBitEvent(id, RMS_LEVEL_EVT_LOW);
+    }
+
+    // An event carries only its code, so listeners read the level with getValue().
+    if (eventMode)
+        MicroBitEvent(id, RMS_LEVEL_EVT_UPDATED);
+}
+
+/**
+ * Converts a level in hundredths of a dB to the current unit.
+ */
+int
+RmsLevelDetector::toUnit(int millibels)
+{
+    if (unit == RMS_LEVEL_UNIT_8BIT)
+    {
+        int v = (millibels - RMS_LEVEL_8BIT_MIN_DB * 100) * 255 / ((RMS_LEVEL_8BIT_MAX_DB - RMS_LEVEL_8BIT_MIN_DB) * 100);
+        return v < 0 ? 0 : v > 255 ? 255 : v;
+    }
+
+    return millibels / 100;
+}
+
+/**
+ * Determines the level measured over the most recent complete window, in the current unit.
+ */
+int
+RmsLevelDetector::getValue()
+{
+    lastRead = (uint32_t)system_timer_current_time();
+
+    if (!activated && !eventMode)
+        upstream.dataWanted(DATASTREAM_WANTED);
+
+    return toUnit(level);
+}
+
+/**
+ * Sets the length of the measurement window. Takes effect from the next window.
+ * @param ms the window length, in milliseconds.
+ */
+void
+RmsLevelDetector::setWindow(int ms)
+{
+    windowMs = max(1, ms);
+}
+
+/**
+ * Enables or disables the RMS_LEVEL_EVT_UPDATED event at the end of every window.
+ */
+void
+RmsLevelDetector::setEventMode(bool enable)
+{
+    eventMode = enable;
+
+    if (enable)
+        upstream.dataWanted(DATASTREAM_WANTED);
+}
+
+/**
+ * Holds the detector active, so LOW and HIGH events are raised without it being read.
+ */
+void
+RmsLevelDetector::activateForEvents(bool enable)
+{
+    activated = enable;
+
+    if (enable)
+        upstream.dataWanted(DATASTREAM_WANTED);
+}
+
+/**
+ * Sets the unit used by getValue().
+ * @param unit RMS_LEVEL_UNIT_DB or RMS_LEVEL_UNIT_8BIT.
+ */
+void
+RmsLevelDetector::setUnit(int unit)
+{
+    if (unit == RMS_LEVEL_UNIT_DB || unit == RMS_LEVEL_UNIT_8BIT)
+        this->unit = unit;
+}
+
+/**
+ * Sets the level, in dB, above which a RMS_LEVEL_EVT_HIGH event is raised.
+ */
+void
+RmsLevelDetector::setHighThreshold(float dB)
+{
+    highThreshold = (int)(dB * 100);
+}
+
+/**
+ * Sets the level, in dB, below which a RMS_LEVEL_EVT_LOW event is raised.
+ */
+void
+RmsLevelDetector::setLowThreshold(float dB)
+{
+    lowThreshold = (int)(dB * 100);
+}
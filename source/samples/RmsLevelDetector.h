@@ -0,0 +1,160 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef RMS_LEVEL_DETECTOR_H
+#define RMS_LEVEL_DETECTOR_H
+
+#define DEVICE_ID_RMS_LEVEL_DETECTOR 9013
+
+// LOW and HIGH share their values with LEVEL_THRESHOLD_LOW and LEVEL_THRESHOLD_HIGH.
+#define RMS_LEVEL_EVT_LOW           1
+#define RMS_LEVEL_EVT_HIGH          2
+#define RMS_LEVEL_EVT_UPDATED       3
+
+#define RMS_LEVEL_UNIT_DB           1
+#define RMS_LEVEL_UNIT_8BIT         2
+
+// Range of levels mapped onto 0..255 by RMS_LEVEL_UNIT_8BIT, in dB.
+#define RMS_LEVEL_8BIT_MIN_DB       52
+#define RMS_LEVEL_8BIT_MAX_DB       100
+
+#define RMS_LEVEL_DEFAULT_WINDOW_MS 20
+
+/**
+ * A DataSink that measures the RMS level of its upstream over fixed windows, in integer arithmetic.
+ *
+ * Levels are reported in dB relative to an RMS of one 16 bit LSB (8 bit samples are treated as the top
+ * byte of a 16 bit sample), plus the gain given. The logarithm is taken with __CLZ and a 64 entry table,
+ * accurate to 0.05dB, so no floating point is used per window.
+ *
+ * LOW and HIGH events are raised as the level crosses the thresholds. In event mode, an UPDATED event is
+ * also raised at the end of every window, so consumers can react to each measurement rather than polling.
+ * The value of every event is its event code, so listeners read the new level with getValue().
+ *
+ * Like LevelDetectorSPL, a detector that is not activated for events, and not in event mode, stops pulling
+ * CODAL_STREAM_IDLE_TIMEOUT_MS after the last getValue(), and tells its upstream DATASTREAM_NOT_WANTED, so
+ * the source behind it can go idle. The next getValue() wants data again, and returns the last level measured.
+ */
+class RmsLevelDetector : public DataSink
+{
+    DataSource      &upstream;
+    uint16_t        id;
+    int             windowMs;
+    int             windowSamples;      // Length of the current window, in samples.
+    int             samples;            // Samples accumulated in the current window.
+    uint64_t        sumSquares;         // Sum of squares in the current window, in 16 bit units.
+    int             gain;               // Gain, in hundredths of a dB.
+    int             level;              // Most recent level, in hundredths of a dB.
+    int             highThreshold;      // Thresholds, in hundredths of a dB.
+    int             lowThreshold;
+    bool            high;
+    bool            eventMode;
+    bool            activated;          // True if held active for LOW and HIGH events.
+    uint32_t        lastRead;           // Time of the last getValue(), in milliseconds.
+    int             unit;
+
+    /**
+     * Accumulates the given buffer, interpreted as type T, completing windows as they fill.
+     */
+    template <typename T> int accumulateBuffer(ManagedBuffer &buf);
+
+    /**
+     * Computes the level of the completed window, and raises any events.
+     */
+    void completeWindow();
+
+    /**
+     * Converts a level in hundredths of a dB to the current unit.
+     */
+    int toUnit(int millibels);
+
+    public:
+    /**
+     * Creates an RmsLevelDetector attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to measure.
+     * @param highThreshold the level, in dB, above which a RMS_LEVEL_EVT_HIGH event is raised.
+     * @param lowThreshold the level, in dB, below which a RMS_LEVEL_EVT_LOW event is raised.
+     * @param gain a calibration gain, in dB, added to every level.
+     * @param id the ID used when raising events.
+     * @param activateImmediately true to measure continuously, false to measure only while read or in event mode.
+     */
+    RmsLevelDetector(DataSource &source, float highThreshold = 75.0f, float lowThreshold = 60.0f, float gain = 0.0f, uint16_t id = DEVICE_ID_RMS_LEVEL_DETECTOR, bool activateImmediately = true);
+
+    /**
+     * Callback provided when data is ready.
+     * @return DEVICE_OK, DEVICE_BUSY if the detector is idle, or DEVICE_NOT_SUPPORTED if the upstream format cannot be measured.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Determines the level measured over the most recent complete window, in the current unit.
+     */
+    int getValue();
+
+    /**
+     * Sets the length of the measurement window. Takes effect from the next window.
+     * @param ms the window length, in milliseconds.
+     */
+    void setWindow(int ms);
+
+    /**
+     * Enables or disables the RMS_LEVEL_EVT_UPDATED event at the end of every window.
+     */
+    void setEventMode(bool enable);
+
+    /**
+     * Holds the detector active, so LOW and HIGH events are raised without it being read.
+     */
+    void activateForEvents(bool enable);
+
+    /**
+     * Sets the unit used by getValue().
+     * @param unit RMS_LEVEL_UNIT_DB or RMS_LEVEL_UNIT_8BIT.
+     */
+    void setUnit(int unit);
+
+    /**
+     * Sets the level, in dB, above which a RMS_LEVEL_EVT_HIGH event is raised.
+     */
+    void setHighThreshold(float dB);
+
+    /**
+     * Sets the level, in dB, below which a RMS_LEVEL_EVT_LOW event is raised.
+     */
+    void setLowThreshold(float dB);
+};
+
+/**
+ * Converts a power (such as a mean square) to hundredths of a dB, using integer arithmetic only.
+ * @return 10 * log10(power) * 100, or 0 if power is 0.
+ */
+int rms_level_millibels(uint64_t power);
+
+#endif
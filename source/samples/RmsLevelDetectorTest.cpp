@@ -0,0 +1,97 @@
+#include "MicroBit.h"
+#include "RmsLevelDetector.h"
+#include "Tests.h"
+
+#define RMS_LEVEL_TEST_RATE         11000
+#define RMS_LEVEL_TEST_SAMPLES      220         // One 20ms window per buffer.
+
+/**
+ * A DataSource that hands out a square wave of the given amplitude on every pull, in 16 bit signed samples,
+ * so its RMS level is exactly 20 * log10(amplitude) dB.
+ */
+class RmsLevelTestSource : public DataSource
+{
+    public:
+    int amplitude;
+
+    virtual ManagedBuffer pull()
+    {
+        ManagedBuffer b(RMS_LEVEL_TEST_SAMPLES * sizeof(int16_t));
+        int16_t *p = (int16_t *)&b[0];
+
+        for (int i = 0; i < RMS_LEVEL_TEST_SAMPLES; i++)
+            p[i] = i & 1 ? amplitude : -amplitude;
+
+        return b;
+    }
+
+    virtual int getFormat()
+    {
+        return DATASTREAM_FORMAT_16BIT_SIGNED;
+    }
+
+    virtual float getSampleRate()
+    {
+        return RMS_LEVEL_TEST_RATE;
+    }
+};
+
+static RmsLevelDetector *rms_level_test_detector;
+static int rms_level_test_expected;
+static int rms_level_test_events;
+static int rms_level_test_errors;
+
+static void rms_level_test_updated(MicroBitEvent e)
+{
+    int value = rms_level_test_detector->getValue();
+
+    rms_level_test_events++;
+
+    if (e.value != RMS_LEVEL_EVT_UPDATED || abs(value - rms_level_test_expected) > 1)
+    {
+        rms_level_test_errors++;
+        DMESG("   EVENT %d: LEVEL %d, EXPECTED %d", e.value, value, rms_level_test_expected);
+    }
+}
+
+/**
+ * Drives an RmsLevelDetector in event mode with square waves of known level, and checks that every
+ * RMS_LEVEL_EVT_UPDATED event is raised with the new level available from getValue(). The listener runs
+ * immediately, so it sees the level of the window that raised the event. Results are written to DMESG.
+ */
+void
+rms_level_detector_event_test()
+{
+    static const int amplitudes[] = {100, 1000, 10000};
+    const int windows = 5;
+
+    RmsLevelTestSource source;
+    RmsLevelDetector detector(source);
+
+    rms_level_test_detector = &detector;
+    rms_level_test_events = 0;
+    rms_level_test_errors = 0;
+
+    detector.setWindow(RMS_LEVEL_TEST_SAMPLES * 1000 / RMS_LEVEL_TEST_RATE);
+    detector.setEventMode(true);
+    uBit.messageBus.listen(DEVICE_ID_RMS_LEVEL_DETECTOR, RMS_LEVEL_EVT_UPDATED, rms_level_test_updated, MESSAGE_BUS_LISTENER_IMMEDIATE);
+
+    DMESG("RMS_LEVEL_DETECTOR_EVENT_TEST: STARTING...");
+
+    for (unsigned int a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++)
+    {
+        source.amplitude = amplitudes[a];
+        rms_level_test_expected = (int)(20.0f * log10f((float)amplitudes[a]));
+
+        for (int w = 0; w < windows; w++)
+            detector.pullRequest();
+    }
+
+    uBit.messageBus.ignore(DEVICE_ID_RMS_LEVEL_DETECTOR, RMS_LEVEL_EVT_UPDATED, rms_level_test_updated);
+
+    int expected = windows * (int)(sizeof(amplitudes) / sizeof(amplitudes[0]));
+    bool pass = rms_level_test_events == expected && rms_level_test_errors == 0;
+
+    DMESG("   EVENTS: %d of %d, ERRORS: %d", rms_level_test_events, expected, rms_level_test_errors);
+    DMESG("   RESULTS: %s", pass ? "PASS" : "FAIL");
+}
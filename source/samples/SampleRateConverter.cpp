@@ -0,0 +1,361 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SampleRateConverter.h"
+#include "BufferPool.h"
+#include "nrf.h"
+
+/**
+ * Converts a raw sample into a 16 bit signed value, and back again.
+ */
+static inline int src_sample(int8_t s) { return s << 8; }
+static inline int src_sample(uint8_t s) { return ((int)s - 128) << 8; }
+static inline int src_sample(int16_t s) { return s; }
+static inline int src_sample(uint16_t s) { return (int)s - 32768; }
+
+static inline void src_store(int8_t *p, int v) { *p = v >> 8; }
+static inline void src_store(uint8_t *p, int v) { *p = (v >> 8) + 128; }
+static inline void src_store(int16_t *p, int v) { *p = v; }
+static inline void src_store(uint16_t *p, int v) { *p = v + 32768; }
+
+/**
+ * Computes the dot product of n samples with a phase of the filter, returning a Q15 result.
+ */
+static inline int src_dot(const int16_t *x, const int16_t *h, int n)
+{
+    int32_t acc = 1 << 14;
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    // Two 16 bit multiply accumulates per instruction. Samples start at any offset, so pairs are read with
+    // memcpy, which compiles to a single LDR (the M4 permits unaligned LDR, but not LDRD or LDM).
+    uint32_t x2, h2;
+
+    for (int i = 0; i < n; i += 2)
+    {
+        memcpy(&x2, x + i, 4);
+        memcpy(&h2, h + i, 4);
+        acc = __SMLAD(x2, h2, acc);
+    }
+#else
+    for (int i = 0; i < n; i++)
+        acc += x[i] * h[i];
+#endif
+
+    acc >>= 15;
+
+    return acc > 32767 ? 32767 : acc < -32768 ? -32768 : acc;
+}
+
+/**
+ * Computes the value of a Blackman windowed sinc with the given cutoff (in cycles per input sample) and
+ * half length, at a distance d input samples from its centre.
+ */
+static float src_tap(float d, float fc, int half)
+{
+    float x = 2.0f * (float)M_PI * fc * d;
+    float w = 0.42f + 0.5f * cosf((float)M_PI * d / half) + 0.08f * cosf(2.0f * (float)M_PI * d / half);
+
+    return (d == 0 ? 1.0f : sinf(x) / x) * w;
+}
+
+/**
+ * Creates a SampleRateConverter attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams. The output has the same format as the input.
+ *
+ * @param source the DataSource to resample.
+ * @param sampleRate the output sample rate, in Hz.
+ */
+SampleRateConverter::SampleRateConverter(DataSource &source, float sampleRate) : CodalComponent(DEVICE_ID_SAMPLE_RATE_CONVERTER, 0), upstream(source)
+{
+    this->downstream = NULL;
+    this->outputRate = sampleRate;
+    this->inputRate = 0;
+    this->step = 0;
+    this->stepFraction = 0;
+    this->fraction = 0;
+    this->position = 0;
+    this->taps = 0;
+    this->coefficients = NULL;
+
+    for (int b = 0; b < 2; b++)
+    {
+        banks[b] = NULL;
+        bankTaps[b] = 0;
+    }
+
+    // Design the first filter now, if the upstream rate is already known, and watch for changes when idle.
+    design(upstream.getSampleRate());
+    status |= DEVICE_COMPONENT_STATUS_IDLE_TICK;
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Destructor. Frees the filter.
+ */
+SampleRateConverter::~SampleRateConverter()
+{
+    status &= ~DEVICE_COMPONENT_STATUS_IDLE_TICK;
+
+    delete[] banks[0];
+    delete[] banks[1];
+}
+
+/**
+ * Designs the step and filter for the given upstream rate into the spare bank, then swaps them in.
+ * Uses floating point, so must not be called on the audio path.
+ */
+void
+SampleRateConverter::design(float rate)
+{
+    if (rate <= 0 || outputRate <= 0)
+        return;
+
+    uint64_t step32 = (uint64_t)(4294967296.0 * rate / outputRate);
+
+    // When downsampling, the filter must span a fixed number of output samples to be band limited to the
+    // output rate, so it grows with the ratio. A change of length restarts the stream.
+    float ratio = rate / outputRate;
+    int n = ratio > 1.0f ? 2 * (int)ceilf(SRC_TAPS * ratio / 2) : SRC_TAPS;
+    n = min(n, SRC_MAX_TAPS);
+
+    // The bank not in use is only ever touched here, so it can be (re)allocated and filled while the audio
+    // path carries on with the other.
+    int spare = coefficients == banks[0] ? 1 : 0;
+
+    if (bankTaps[spare] < n)
+    {
+        delete[] banks[spare];
+        banks[spare] = new int16_t[SRC_PHASES * n];
+        bankTaps[spare] = n;
+    }
+
+    // Windowed sinc, cut off below the lower of the two Nyquist frequencies (in cycles per input sample).
+    float fc = 0.5f * SRC_CUTOFF * (ratio > 1.0f ? 1.0f / ratio : 1.0f);
+    int half = n / 2;
+
+    for (int p = 0; p < SRC_PHASES; p++)
+    {
+        int16_t *h = &banks[spare][p * n];
+        float sum = 0;
+
+        // Distance from the output sample time to the input sample each tap is applied to.
+        for (int m = 0; m < n; m++)
+            sum += src_tap((float)p / SRC_PHASES + half - 1 - m, fc, half);
+
+        // Normalise each phase to unity gain at DC.
+        for (int m = 0; m < n; m++)
+            h[m] = (int16_t)(32767.0f * src_tap((float)p / SRC_PHASES + half - 1 - m, fc, half) / sum);
+    }
+
+    // Swap the new filter in between buffers.
+    target_disable_irq();
+
+    if (n != taps)
+    {
+        taps = n;
+        position = 0;
+        fraction = 0;
+        memset(history, 0, (taps - 1) * sizeof(int16_t));
+    }
+
+    coefficients = banks[spare];
+    step = (int32_t)(step32 >> 16);
+    stepFraction = (uint16_t)step32;
+    inputRate = rate;
+
+    target_enable_irq();
+}
+
+/**
+ * Redesigns the filter when the upstream rate has changed. Called by the scheduler when idle.
+ */
+void
+SampleRateConverter::idleCallback()
+{
+    float rate = upstream.getSampleRate();
+
+    if (rate != inputRate)
+        design(rate);
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller, resampled to the output rate.
+ */
+ManagedBuffer
+SampleRateConverter::pull()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    // No filter yet: the upstream rate was unknown until now, and the idle callback will design one.
+    if (taps == 0)
+        return ManagedBuffer();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return resampleBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return resampleBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return resampleBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return resampleBuffer<uint16_t>(buf);
+    }
+
+    return buf;
+}
+
+/**
+ * Resamples the given buffer, interpreted as type T.
+ */
+template <typename T> ManagedBuffer
+SampleRateConverter::resampleBuffer(ManagedBuffer &buf)
+{
+    int n = buf.length() / sizeof(T);
+    int len = taps - 1 + n;
+
+    if (n == 0 || step <= 0)
+        return ManagedBuffer();
+
+    // Join the history to the new samples, as 16 bit values.
+    ManagedBuffer work = buffer_pool_allocate(len * sizeof(int16_t));
+    int16_t *x = (int16_t *)&work[0];
+    T *in = (T *)&buf[0];
+
+    memcpy(x, history, (taps - 1) * sizeof(int16_t));
+
+    for (int i = taps - 1; i < len; i++)
+        x[i] = src_sample(*in++);
+
+    // Output times are rounded to the nearest phase, and a carry into the integer part moves on to the next
+    // input sample. Every output whose (rounded) filter lies entirely within the available input is produced now.
+    int32_t half = 1 << (15 - SRC_PHASE_BITS);
+    int32_t limit = n << 16;
+    int32_t start = position + half;
+    int count = start < limit ? (limit - start) / step + 1 : 0;
+
+    ManagedBuffer out = buffer_pool_allocate(count * sizeof(T));
+    T *p = (T *)&out[0];
+    T *end = p + count;
+
+    while (p < end && position + half < limit)
+    {
+        int32_t rounded = position + half;
+        int phase = (rounded >> (16 - SRC_PHASE_BITS)) & (SRC_PHASES - 1);
+
+        src_store(p++, src_dot(&x[rounded >> 16], &coefficients[phase * taps], taps));
+
+        fraction += stepFraction;
+        position += step + (fraction >> 16);
+        fraction &= 0xFFFF;
+    }
+
+    // The fractional part of the step can occasionally make one less output than the estimate.
+    out.truncate((p - (T *)&out[0]) * sizeof(T));
+
+    // Keep the last taps - 1 samples, and make the position relative to them.
+    memcpy(history, &x[n], (taps - 1) * sizeof(int16_t));
+    position -= n << 16;
+
+    return out;
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+SampleRateConverter::pullRequest()
+{
+    if (downstream)
+        return downstream->pullRequest();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+SampleRateConverter::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+SampleRateConverter::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+SampleRateConverter::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+SampleRateConverter::getFormat()
+{
+    return upstream.getFormat();
+}
+
+/**
+ * Determines the output sample rate.
+ */
+float
+SampleRateConverter::getSampleRate()
+{
+    return outputRate;
+}
+
+/**
+ * Requests a new output sample rate. Any rate is accepted, and the upstream is not affected.
+ * @return the new output sample rate.
+ */
+float
+SampleRateConverter::requestSampleRate(float sampleRate)
+{
+    if (sampleRate > 0)
+    {
+        outputRate = sampleRate;
+        design(upstream.getSampleRate());
+    }
+
+    return outputRate;
+}
@@ -0,0 +1,160 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef SAMPLE_RATE_CONVERTER_H
+#define SAMPLE_RATE_CONVERTER_H
+
+#define DEVICE_ID_SAMPLE_RATE_CONVERTER 9016
+
+// Number of filter phases (the resolution of output sample timing, as a fraction of an input sample).
+// Must be a power of two.
+#define SRC_PHASES          32
+#define SRC_PHASE_BITS      5
+
+// Number of taps per phase when upsampling. When downsampling, the filter spans this many output sample
+// periods instead, so it grows with the ratio. Must be even. The length is limited to SRC_MAX_TAPS, which
+// is reached at a ratio of about 2.7 (such as 44.1kHz to 16kHz); beyond that the filter stops growing, and
+// its transition band widens in proportion.
+#define SRC_TAPS            24
+#define SRC_MAX_TAPS        64
+
+// Cutoff (the -6dB point) of the filter, as a fraction of the lower of the input and output Nyquist frequencies.
+#define SRC_CUTOFF          0.8f
+
+/**
+ * A DataSource and DataSink that converts its upstream to an arbitrary output sample rate, using a
+ * fixed point (Q15) polyphase windowed sinc FIR filter. This lets a consumer run at the rate it needs
+ * without changing the rate of the hardware upstream, and follows any change in the upstream rate.
+ *
+ * Output sample times are tracked in Q32 input samples, and rounded to the nearest of SRC_PHASES filter
+ * phases. The filter is designed for the current ratio. When downsampling, its length scales with the
+ * ratio, so it is band limited to the output rate: the passband is flat (within 1dB) to 70% of the lower
+ * Nyquist frequency, and everything above the output Nyquist frequency is attenuated by at least 55dB.
+ * This costs SRC_TAPS * ratio multiply accumulates per output sample, and 64 * SRC_TAPS * ratio bytes of
+ * coefficients. Beyond a ratio of about 2.7 the length is capped at SRC_MAX_TAPS, so the transition band
+ * widens: from 44.1kHz to 8kHz, 55dB of rejection is reached at 4.9kHz rather than 4kHz. The output has
+ * a latency of half the filter length.
+ *
+ * Filters are designed in floating point, so never on the audio path. The first is designed when the
+ * converter is created (or its output rate is changed), and a change in the upstream rate is picked up
+ * by the idle callback, which designs the new filter into a second bank and swaps it in. Until then, the
+ * previous filter carries on. Each bank is allocated at the longest filter it has held, so the two cost
+ * at most 4 * SRC_PHASES * SRC_MAX_TAPS bytes (8KB), and a new bank is never allocated on the audio path.
+ */
+class SampleRateConverter : public CodalComponent, public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    float           outputRate;
+    float           inputRate;          // Upstream rate the filter and step in use were designed for.
+    int32_t         step;               // Input samples per output sample, in Q16.
+    uint16_t        stepFraction;       // A further 16 bits of step, so the output rate does not drift.
+    uint32_t        fraction;
+    int32_t         position;           // Position of the next output sample, in Q16 relative to the start of the history.
+    int             taps;               // Length of each phase of the filter in use, or 0 if none has been designed.
+    int16_t         history[SRC_MAX_TAPS - 1];  // The last taps - 1 input samples.
+    int16_t         *coefficients;      // The filter in use: SRC_PHASES phases of taps coefficients each, in Q15.
+    int16_t         *banks[2];          // The filter in use, and the one the next design is made in.
+    int             bankTaps[2];        // The longest filter each bank can hold.
+
+    /**
+     * Designs the step and filter for the given upstream rate into the spare bank, then swaps them in.
+     * Uses floating point, so must not be called on the audio path.
+     */
+    void design(float rate);
+
+    /**
+     * Resamples the given buffer, interpreted as type T.
+     */
+    template <typename T> ManagedBuffer resampleBuffer(ManagedBuffer &buf);
+
+    public:
+    /**
+     * Creates a SampleRateConverter attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams. The output has the same format as the input.
+     *
+     * @param source the DataSource to resample.
+     * @param sampleRate the output sample rate, in Hz.
+     */
+    SampleRateConverter(DataSource &source, float sampleRate);
+
+    /**
+     * Destructor. Frees the filter.
+     */
+    ~SampleRateConverter();
+
+    /**
+     * Redesigns the filter when the upstream rate has changed. Called by the scheduler when idle.
+     */
+    virtual void idleCallback();
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller, resampled to the output rate.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the output sample rate.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Requests a new output sample rate. Any rate is accepted, and the upstream is not affected.
+     * The filter is redesigned before this returns.
+     * @return the new output sample rate.
+     */
+    virtual float requestSampleRate(float sampleRate);
+};
+
+#endif
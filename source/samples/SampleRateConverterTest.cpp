@@ -0,0 +1,116 @@
+#include "MicroBit.h"
+#include "SampleRateConverter.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define SRC_BENCHMARK_BUFFER_SIZE       256
+#define SRC_BENCHMARK_ITERATIONS        50
+
+/**
+ * A DataSource that hands out the same buffer of a synthetic tone on every pull,
+ * at a configurable sample rate and format.
+ */
+class SrcBenchmarkSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+    float sampleRate;
+    int format;
+
+    SrcBenchmarkSource(int format) : buffer(SRC_BENCHMARK_BUFFER_SIZE * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format))
+    {
+        this->sampleRate = 11000;
+        this->format = format;
+
+        for (int i = 0; i < SRC_BENCHMARK_BUFFER_SIZE; i++)
+        {
+            int v = (int)(16000.0f * sinf(2.0f * (float)M_PI * i / 32));
+
+            if (format == DATASTREAM_FORMAT_16BIT_SIGNED)
+                ((int16_t *)&buffer[0])[i] = v;
+            else
+                buffer[i] = (uint8_t)(int8_t)(v >> 8);
+        }
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return format;
+    }
+
+    virtual float getSampleRate()
+    {
+        return sampleRate;
+    }
+};
+
+/**
+ * Measures the cost of the SampleRateConverter for a range of common rate pairs, for 8 and 16 bit
+ * streams. Results are written to DMESG in cycles per output sample, including the buffer allocation
+ * and format conversion in each pull.
+ */
+void
+sample_rate_converter_benchmark()
+{
+    static const int rates[][2] = {
+        {11000, 18000},
+        {11000, 11025},
+        {16000, 11025},
+        {44100, 8000},
+        {8000, 44100}
+    };
+
+    cycle_counter_enable();
+
+    for (int f = 0; f < 2; f++)
+    {
+        int format = f ? DATASTREAM_FORMAT_16BIT_SIGNED : DATASTREAM_FORMAT_8BIT_SIGNED;
+
+        for (int r = 0; r < (int)(sizeof(rates) / sizeof(rates[0])); r++)
+        {
+            SrcBenchmarkSource source(format);
+            source.sampleRate = rates[r][0];
+
+            SampleRateConverter converter(source, rates[r][1]);
+            int outputs = 0;
+
+            // The filter is designed when the converter is created. The first pull fills its history, so is excluded.
+            converter.pull();
+
+            uint32_t start = cycle_counter_read();
+            for (int i = 0; i < SRC_BENCHMARK_ITERATIONS; i++)
+                outputs += converter.pull().length() / DATASTREAM_FORMAT_BYTES_PER_SAMPLE(format);
+            uint32_t cycles = cycle_counter_read() - start;
+
+            DMESG("SRC_BENCHMARK: %d bit %d -> %d Hz: %d outputs, %d.%d cycles/sample", f ? 16 : 8, rates[r][0], rates[r][1],
+                outputs, (int)(cycles / outputs), (int)((cycles % outputs) * 10 / outputs));
+        }
+    }
+}
+
+/**
+ * Plays the microphone through the speaker at 16kHz, via a SampleRateConverter, while the microphone
+ * rate is swept with the accelerometer. The playback rate is unaffected.
+ */
+void
+sample_rate_converter_test()
+{
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    static SampleRateConverter *converter = new SampleRateConverter(*splitterChannel, 16000);
+    static MixerChannel *channel = uBit.audio.mixer.addChannel(*converter, 16000);
+
+    uBit.audio.requestActivation();
+    channel->setVolume(CONFIG_MIXER_INTERNAL_RANGE * 0.2); // 20% volume, to limit feedback
+
+    while (true)
+    {
+        uBit.audio.mic->setSampleRate(8000 + abs(uBit.accelerometer.getX()) * 8);
+        DMESG("SRC: %d -> %d Hz", (int)splitterChannel->getSampleRate(), (int)converter->getSampleRate());
+        uBit.sleep(500);
+    }
+}
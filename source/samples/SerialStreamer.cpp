@@ -23,6 +23,10 @@ DEALINGS IN THE SOFTWARE.
 */
 #include "MicroBit.h"
 #include "SerialStreamer.h"
+#include "DmaSerialStreamer.h"
+#include "StreamFramer.h"
+#include "SharedSplitter.h"
+#include "RmsLevelDetector.h"
 #include "Tests.h"
 
 void streamer_serial_test() {
@@ -33,3 +37,42 @@ void streamer_serial_test() {
         uBit.sleep(1000);
     }
 }
+
+void streamer_serial_shared_test() {
+    // One splitter channel fans out to the serial streamer and a level detector, which share each raw
+    // buffer, and to an 8 bit, 5.5kHz channel, which is converted once however many read it.
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    static SharedSplitter *shared = new SharedSplitter(*splitterChannel);
+    SerialStreamer *streamer = new SerialStreamer(*shared->createChannel(), SERIAL_STREAM_MODE_DECIMAL);
+    RmsLevelDetector *level = new RmsLevelDetector(*shared->createChannel());
+    RmsLevelDetector *lowRateLevel = new RmsLevelDetector(*shared->createChannel(DATASTREAM_FORMAT_8BIT_SIGNED, 5500));
+    (void) streamer;
+
+    while (true) {
+        uBit.sleep(1000);
+        DMESG("SHARED SPLITTER: %d groups, %d copies/s, %d bytes/s, levels %d %d", shared->getGroupCount(),
+            (int)shared->getCopiesPerSecond(), (int)shared->getBytesCopiedPerSecond(), level->getValue(), lowRateLevel->getValue());
+    }
+}
+
+void streamer_serial_dma_test() {
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    DmaSerialStreamer *streamer = new DmaSerialStreamer(*splitterChannel, uBit.io.usbTx, 115200);
+
+    while (true) {
+        uBit.sleep(1000);
+        DMESG("DMA STREAMER: %d bytes, %d dropped", (int)streamer->getBytesSent(), (int)streamer->getDroppedBuffers());
+    }
+}
+
+void streamer_serial_framed_test() {
+    static SplitterChannel *splitterChannel = uBit.audio.splitter->createChannel();
+    StreamFramer *framer = new StreamFramer(*splitterChannel);
+    DmaSerialStreamer *streamer = new DmaSerialStreamer(*framer, uBit.io.usbTx, 115200);
+
+    // Frames can be checked on the host with utils/audio/serial_receiver.py
+    while (true) {
+        uBit.sleep(1000);
+        DMESG("FRAMED STREAMER: %d frames, %d bytes, %d dropped", (int)framer->getSequence(), (int)streamer->getBytesSent(), (int)streamer->getDroppedBuffers());
+    }
+}
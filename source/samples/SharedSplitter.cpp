@@ -0,0 +1,465 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SharedSplitter.h"
+#include "BufferPool.h"
+
+/**
+ * Converts a raw sample into a signed 16 bit value, and back.
+ */
+static inline int shared_splitter_sample(int8_t s) { return s << 8; }
+static inline int shared_splitter_sample(uint8_t s) { return ((int)s - 128) << 8; }
+static inline int shared_splitter_sample(int16_t s) { return s; }
+static inline int shared_splitter_sample(uint16_t s) { return (int)s - 32768; }
+
+static inline void shared_splitter_store(int8_t *p, int v) { *p = (int8_t)(v >> 8); }
+static inline void shared_splitter_store(uint8_t *p, int v) { *p = (uint8_t)((v >> 8) + 128); }
+static inline void shared_splitter_store(int16_t *p, int v) { *p = (int16_t)v; }
+static inline void shared_splitter_store(uint16_t *p, int v) { *p = (uint16_t)(v + 32768); }
+
+/**
+ * Creates a SharedSplitterChannel. Channels are created with SharedSplitter::createChannel().
+ */
+SharedSplitterChannel::SharedSplitterChannel(SharedSplitter &parent, int group) : parent(parent)
+{
+    this->downstream = NULL;
+    this->group = group;
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller.
+ */
+ManagedBuffer
+SharedSplitterChannel::pull()
+{
+    return parent.getBuffer(group);
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+SharedSplitterChannel::connect(DataSink &sink)
+{
+    downstream = &sink;
+    parent.updateWanted();
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+SharedSplitterChannel::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+SharedSplitterChannel::disconnect()
+{
+    downstream = NULL;
+    parent.updateWanted();
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+SharedSplitterChannel::getFormat()
+{
+    return parent.groups[group].format;
+}
+
+/**
+ * Indicates whether our downstream component wants data. The splitter pulls from its upstream only while
+ * a connected channel wants data.
+ * @param wanted DATASTREAM_WANTED, DATASTREAM_NOT_WANTED or DATASTREAM_DONT_CARE.
+ */
+void
+SharedSplitterChannel::dataWanted(int wanted)
+{
+    DataSource::dataWanted(wanted);
+    parent.updateWanted();
+}
+
+/**
+ * Changes the format of this channel. The channel moves to the group with the new format and rate.
+ * @param format the format, or DATASTREAM_FORMAT_UNKNOWN for the upstream format.
+ * @return DEVICE_OK, or DEVICE_NO_RESOURCES if a new group would exceed SHARED_SPLITTER_MAX_GROUPS.
+ */
+int
+SharedSplitterChannel::setFormat(int format)
+{
+    int g = parent.findGroup(format, parent.groups[group].sampleRate);
+
+    if (g < 0)
+        return DEVICE_NO_RESOURCES;
+
+    parent.moveChannel(this, g);
+
+    return DEVICE_OK;
+}
+
+/**
+ * Determines the sample rate of the buffers streamed out of this component.
+ */
+float
+SharedSplitterChannel::getSampleRate()
+{
+    return parent.groups[group].sampleRate;
+}
+
+/**
+ * Changes the sample rate of this channel. The channel moves to the group with the new format and rate.
+ * @param sampleRate the rate, or 0 for the upstream rate.
+ * @return the new rate.
+ */
+float
+SharedSplitterChannel::requestSampleRate(float sampleRate)
+{
+    int g = parent.findGroup(parent.groups[group].format, sampleRate);
+
+    if (g >= 0)
+        parent.moveChannel(this, g);
+
+    return getSampleRate();
+}
+
+/**
+ * Creates a SharedSplitter attached to the given source.
+ * Supports 8 and 16 bit, signed and unsigned, streams.
+ *
+ * @param source the DataSource to fan out.
+ */
+SharedSplitter::SharedSplitter(DataSource &source) : upstream(source)
+{
+    this->channelCount = 0;
+    this->copies = 0;
+    this->bytesCopied = 0;
+    this->windowStart = (uint32_t)system_timer_current_time();
+    this->windowCopies = 0;
+    this->windowBytes = 0;
+    this->copiesPerSecond = 0;
+    this->bytesPerSecond = 0;
+
+    for (int g = 0; g < SHARED_SPLITTER_MAX_GROUPS; g++)
+        groups[g].channels = 0;
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+SharedSplitter::pullRequest()
+{
+    uint32_t now = (uint32_t)system_timer_current_time();
+
+    // Conversions are made lazily, as each group is first pulled.
+    for (int g = 0; g < SHARED_SPLITTER_MAX_GROUPS; g++)
+    {
+        groups[g].valid = false;
+        groups[g].buffer = ManagedBuffer();
+    }
+
+    // Nobody is listening: leave the buffer upstream, so an idle source can stop.
+    if (!anyChannelWanted())
+    {
+        upstream.dataWanted(DATASTREAM_NOT_WANTED);
+        buffer = ManagedBuffer();
+        return DEVICE_BUSY;
+    }
+
+    buffer = upstream.pull();
+
+    if (now - windowStart >= 1000)
+    {
+        copiesPerSecond = windowCopies * 1000 / (now - windowStart);
+        bytesPerSecond = (uint32_t)((uint64_t)windowBytes * 1000 / (now - windowStart));
+        windowCopies = 0;
+        windowBytes = 0;
+        windowStart = now;
+    }
+
+    for (int i = 0; i < channelCount; i++)
+        if (channels[i]->downstream && channels[i]->isWanted() != DATASTREAM_NOT_WANTED)
+            channels[i]->downstream->pullRequest();
+
+    return DEVICE_OK;
+}
+
+/**
+ * Determines if any connected channel wants data.
+ */
+bool
+SharedSplitter::anyChannelWanted()
+{
+    for (int i = 0; i < channelCount; i++)
+        if (channels[i]->downstream && channels[i]->isWanted() != DATASTREAM_NOT_WANTED)
+            return true;
+
+    return false;
+}
+
+/**
+ * Tells our upstream whether any connected channel wants data. Called whenever a channel changes.
+ */
+void
+SharedSplitter::updateWanted()
+{
+    upstream.dataWanted(anyChannelWanted() ? DATASTREAM_WANTED : DATASTREAM_NOT_WANTED);
+}
+
+/**
+ * Creates a new output.
+ *
+ * @param format the format of the channel, or DATASTREAM_FORMAT_UNKNOWN for the upstream format.
+ * @param sampleRate the rate of the channel, or 0 for the upstream rate.
+ * @return the channel, or NULL if SHARED_SPLITTER_MAX_CHANNELS or SHARED_SPLITTER_MAX_GROUPS would be exceeded.
+ */
+SharedSplitterChannel *
+SharedSplitter::createChannel(int format, float sampleRate)
+{
+    if (channelCount == SHARED_SPLITTER_MAX_CHANNELS)
+        return NULL;
+
+    int g = findGroup(format, sampleRate);
+
+    if (g < 0)
+        return NULL;
+
+    SharedSplitterChannel *channel = new SharedSplitterChannel(*this, g);
+
+    groups[g].channels++;
+    channels[channelCount++] = channel;
+
+    return channel;
+}
+
+/**
+ * Finds the group with the given format and rate, creating it if needed.
+ * DATASTREAM_FORMAT_UNKNOWN and a rate of 0 are first resolved to the upstream format and rate.
+ * @return the group index, or DEVICE_NO_RESOURCES if SHARED_SPLITTER_MAX_GROUPS are in use.
+ */
+int
+SharedSplitter::findGroup(int format, float sampleRate)
+{
+    int free = -1;
+
+    if (format == DATASTREAM_FORMAT_UNKNOWN)
+        format = upstream.getFormat();
+
+    if (sampleRate <= 0)
+        sampleRate = upstream.getSampleRate();
+
+    for (int g = 0; g < SHARED_SPLITTER_MAX_GROUPS; g++)
+    {
+        if (groups[g].channels && groups[g].format == format && groups[g].sampleRate == sampleRate)
+            return g;
+
+        if (!groups[g].channels && free < 0)
+            free = g;
+    }
+
+    if (free < 0)
+        return DEVICE_NO_RESOURCES;
+
+    SharedSplitterGroup &g = groups[free];
+
+    g.format = format;
+    g.sampleRate = sampleRate;
+    g.buffer = ManagedBuffer();
+    g.valid = false;
+    g.position = 0;
+
+    return free;
+}
+
+/**
+ * Moves a channel from one group to another, releasing the old group if it is no longer used.
+ */
+void
+SharedSplitter::moveChannel(SharedSplitterChannel *channel, int group)
+{
+    if (channel->group == group)
+        return;
+
+    groups[channel->group].channels--;
+    groups[group].channels++;
+    channel->group = group;
+}
+
+/**
+ * Provides the current buffer for the given group, converting it the first time it is asked for.
+ */
+ManagedBuffer
+SharedSplitter::getBuffer(int group)
+{
+    SharedSplitterGroup &g = groups[group];
+
+    if (g.valid)
+        return g.buffer;
+
+    g.valid = true;
+
+    // The same format and rate as the upstream: every channel of the group shares the upstream buffer itself.
+    if (g.format == upstream.getFormat() && g.sampleRate == upstream.getSampleRate())
+    {
+        g.buffer = buffer;
+        return g.buffer;
+    }
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            g.buffer = convertFrom<int8_t>(g);
+            break;
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            g.buffer = convertFrom<uint8_t>(g);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            g.buffer = convertFrom<int16_t>(g);
+            break;
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            g.buffer = convertFrom<uint16_t>(g);
+            break;
+
+        default:
+            g.buffer = ManagedBuffer();
+            return g.buffer;
+    }
+
+    copies++;
+    windowCopies++;
+    bytesCopied += g.buffer.length();
+    windowBytes += g.buffer.length();
+
+    return g.buffer;
+}
+
+/**
+ * Converts the current upstream buffer, of type I, into the given group's format.
+ */
+template <typename I> ManagedBuffer
+SharedSplitter::convertFrom(SharedSplitterGroup &g)
+{
+    switch (g.format)
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return convertBuffer<I, int8_t>(g);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return convertBuffer<I, uint8_t>(g);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return convertBuffer<I, int16_t>(g);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return convertBuffer<I, uint16_t>(g);
+    }
+
+    return ManagedBuffer();
+}
+
+/**
+ * Converts the current upstream buffer, of type I, into a buffer of type O at the group's rate.
+ */
+template <typename I, typename O> ManagedBuffer
+SharedSplitter::convertBuffer(SharedSplitterGroup &g)
+{
+    I *in = (I *)&buffer[0];
+    uint32_t n = buffer.length() / sizeof(I);
+
+    if (n == 0 || g.sampleRate <= 0)
+        return ManagedBuffer();
+
+    // The step through the upstream buffer per output sample, in Q16.
+    uint32_t step = max((uint32_t)(upstream.getSampleRate() * 65536.0f / g.sampleRate), (uint32_t)1);
+    uint32_t limit = n << 16;
+    uint32_t count = g.position < limit ? (limit - g.position + step - 1) / step : 0;
+
+    ManagedBuffer out = buffer_pool_allocate(count * sizeof(O));
+    O *p = (O *)&out[0];
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        shared_splitter_store(p++, shared_splitter_sample(in[g.position >> 16]));
+        g.position += step;
+    }
+
+    g.position -= limit;
+
+    return out;
+}
+
+/**
+ * Determines the number of distinct (format, rate) groups in use.
+ */
+int
+SharedSplitter::getGroupCount()
+{
+    int count = 0;
+
+    for (int g = 0; g < SHARED_SPLITTER_MAX_GROUPS; g++)
+        if (groups[g].channels)
+            count++;
+
+    return count;
+}
+
+/**
+ * Determines the number of buffers converted since the splitter was created.
+ */
+uint32_t
+SharedSplitter::getCopyCount()
+{
+    return copies;
+}
+
+/**
+ * Determines the number of buffers converted over the last complete second.
+ */
+uint32_t
+SharedSplitter::getCopiesPerSecond()
+{
+    return copiesPerSecond;
+}
+
+/**
+ * Determines the number of bytes written by conversions over the last complete second.
+ */
+uint32_t
+SharedSplitter::getBytesCopiedPerSecond()
+{
+    return bytesPerSecond;
+}
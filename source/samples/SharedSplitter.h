@@ -0,0 +1,237 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef SHARED_SPLITTER_H
+#define SHARED_SPLITTER_H
+
+#define SHARED_SPLITTER_MAX_CHANNELS    8
+#define SHARED_SPLITTER_MAX_GROUPS      4
+
+class SharedSplitter;
+
+/**
+ * The channels of a SharedSplitter with the same format and sample rate, and the one buffer they share.
+ */
+struct SharedSplitterGroup
+{
+    int             format;             // Always a concrete format and rate, never UNKNOWN or 0.
+    float           sampleRate;
+    ManagedBuffer   buffer;             // The converted buffer, shared by every channel of the group.
+    bool            valid;              // True once buffer holds the current upstream buffer.
+    uint32_t        position;           // Position of the next output sample in the upstream buffer, in Q16.
+    int             channels;           // Channels using the group.
+};
+
+/**
+ * A single output of a SharedSplitter.
+ */
+class SharedSplitterChannel : public DataSource
+{
+    friend class SharedSplitter;
+
+    SharedSplitter  &parent;
+    DataSink        *downstream;
+    int             group;
+
+    /**
+     * Creates a SharedSplitterChannel. Channels are created with SharedSplitter::createChannel().
+     */
+    SharedSplitterChannel(SharedSplitter &parent, int group);
+
+    public:
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Indicates whether our downstream component wants data. The splitter pulls from its upstream only while
+     * a connected channel wants data.
+     * @param wanted DATASTREAM_WANTED, DATASTREAM_NOT_WANTED or DATASTREAM_DONT_CARE.
+     */
+    virtual void dataWanted(int wanted);
+
+    /**
+     * Changes the format of this channel. The channel moves to the group with the new format and rate.
+     * @param format the format, or DATASTREAM_FORMAT_UNKNOWN for the upstream format.
+     * @return DEVICE_OK, or DEVICE_NO_RESOURCES if a new group would exceed SHARED_SPLITTER_MAX_GROUPS.
+     */
+    virtual int setFormat(int format);
+
+    /**
+     * Determines the sample rate of the buffers streamed out of this component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Changes the sample rate of this channel. The channel moves to the group with the new format and rate.
+     * @param sampleRate the rate, or 0 for the upstream rate.
+     * @return the new rate.
+     */
+    virtual float requestSampleRate(float sampleRate);
+};
+
+/**
+ * A fan out of one DataSource to several consumers, where channels that want the same format and sample
+ * rate receive the very same reference counted buffer.
+ *
+ * Channels are grouped by their (format, rate) pair, resolved against the upstream when the channel is created
+ * or changed, so a channel asking for the upstream format by name shares with one asking for
+ * DATASTREAM_FORMAT_UNKNOWN. Each upstream buffer is pulled once, and each group converts it at most once,
+ * the first time one of its channels pulls, so a group nobody is reading costs nothing.
+ *
+ * Only channels whose downstream wants data (isWanted() is not DATASTREAM_NOT_WANTED) are notified, and when
+ * no connected channel wants data the upstream is not pulled at all and is told DATASTREAM_NOT_WANTED, so an
+ * idle splitter lets the source behind it, such as the microphone, time out. A group with the upstream format and rate hands out the upstream buffer itself, with no copy
+ * at all, so adding another consumer of the raw stream adds no memory traffic.
+ *
+ * Sample rates are converted by picking the nearest earlier sample, as a decimating splitter does, so
+ * a lower rate should be paired with filtering if aliasing matters.
+ *
+ * The number of conversions (copies) and the bytes they write are counted, and reported per second.
+ */
+class SharedSplitter : public DataSink
+{
+    friend class SharedSplitterChannel;
+
+    DataSource              &upstream;
+    ManagedBuffer           buffer;     // Most recent upstream buffer.
+    SharedSplitterChannel   *channels[SHARED_SPLITTER_MAX_CHANNELS];
+    int                     channelCount;
+    SharedSplitterGroup     groups[SHARED_SPLITTER_MAX_GROUPS];
+    uint32_t                copies;
+    uint32_t                bytesCopied;
+    uint32_t                windowStart;        // Start of the current one second window, in milliseconds.
+    uint32_t                windowCopies;
+    uint32_t                windowBytes;
+    uint32_t                copiesPerSecond;
+    uint32_t                bytesPerSecond;
+
+    /**
+     * Determines if any connected channel wants data.
+     */
+    bool anyChannelWanted();
+
+    /**
+     * Tells our upstream whether any connected channel wants data. Called whenever a channel changes.
+     */
+    void updateWanted();
+
+    /**
+     * Finds the group with the given format and rate, creating it if needed.
+     * DATASTREAM_FORMAT_UNKNOWN and a rate of 0 are first resolved to the upstream format and rate.
+     * @return the group index, or DEVICE_NO_RESOURCES if SHARED_SPLITTER_MAX_GROUPS are in use.
+     */
+    int findGroup(int format, float sampleRate);
+
+    /**
+     * Moves a channel from one group to another, releasing the old group if it is no longer used.
+     */
+    void moveChannel(SharedSplitterChannel *channel, int group);
+
+    /**
+     * Provides the current buffer for the given group, converting it the first time it is asked for.
+     */
+    ManagedBuffer getBuffer(int group);
+
+    /**
+     * Converts the current upstream buffer, of type I, into the given group's format.
+     */
+    template <typename I> ManagedBuffer convertFrom(SharedSplitterGroup &g);
+
+    /**
+     * Converts the current upstream buffer, of type I, into a buffer of type O at the group's rate.
+     */
+    template <typename I, typename O> ManagedBuffer convertBuffer(SharedSplitterGroup &g);
+
+    public:
+    /**
+     * Creates a SharedSplitter attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source the DataSource to fan out.
+     */
+    SharedSplitter(DataSource &source);
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Creates a new output.
+     *
+     * @param format the format of the channel, or DATASTREAM_FORMAT_UNKNOWN for the upstream format.
+     * @param sampleRate the rate of the channel, or 0 for the upstream rate.
+     * @return the channel, or NULL if SHARED_SPLITTER_MAX_CHANNELS or SHARED_SPLITTER_MAX_GROUPS would be exceeded.
+     */
+    SharedSplitterChannel *createChannel(int format = DATASTREAM_FORMAT_UNKNOWN, float sampleRate = 0);
+
+    /**
+     * Determines the number of distinct (format, rate) groups in use.
+     */
+    int getGroupCount();
+
+    /**
+     * Determines the number of buffers converted since the splitter was created.
+     */
+    uint32_t getCopyCount();
+
+    /**
+     * Determines the number of buffers converted over the last complete second.
+     */
+    uint32_t getCopiesPerSecond();
+
+    /**
+     * Determines the number of bytes written by conversions over the last complete second.
+     */
+    uint32_t getBytesCopiedPerSecond();
+};
+
+#endif
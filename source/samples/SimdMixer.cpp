@@ -0,0 +1,445 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SimdMixer.h"
+#include "BufferPool.h"
+#include "nrf.h"
+
+/**
+ * Determines if samples of the given type are signed, and so centred on zero.
+ */
+static inline bool simd_mixer_signed(int8_t) { return true; }
+static inline bool simd_mixer_signed(uint8_t) { return false; }
+static inline bool simd_mixer_signed(int16_t) { return true; }
+static inline bool simd_mixer_signed(uint16_t) { return false; }
+
+static inline int simd_mixer_saturate(int v)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __SSAT(v, 16);
+#else
+    return v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+#endif
+}
+
+/**
+ * Scales a centred source sample by a Q12 scale, saturating to 16 bits.
+ * The product is taken in 64 bits: a full scale 16 bit sample with a small range overflows 32.
+ */
+static inline int simd_mixer_scale(int sample, int32_t scale)
+{
+    int64_t v = ((int64_t)sample * scale) >> 12;
+
+    return v < -32768 ? -32768 : v > 32767 ? 32767 : (int)v;
+}
+
+/**
+ * Converts a volume from 0 to CONFIG_MIXER_INTERNAL_RANGE into a Q15 gain.
+ */
+static inline uint32_t simd_mixer_gain(int volume)
+{
+    return (uint32_t)(volume * 32767 / CONFIG_MIXER_INTERNAL_RANGE);
+}
+
+/**
+ * Mixes two staged channels into the bus, given their Q15 gains packed as (gainB << 16) | gainA.
+ * All three arrays hold pairs of signed 16 bit samples, and words is the number of pairs.
+ */
+static void simd_mixer_accumulate(uint32_t *bus, const uint32_t *a, const uint32_t *b, uint32_t gains, int words)
+{
+    uint32_t *end = bus + words;
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    uint32_t x, y;
+    int32_t s0, s1;
+
+    while (bus < end)
+    {
+        x = *a++;
+        y = *b++;
+
+        // Gather the first sample of each channel into one word, and the second of each into another,
+        // so each __SMLAD applies both volumes and sums the channels for one output sample.
+        s0 = __SMLAD(__PKHBT(x, y, 16), gains, 1 << 14) >> 15;
+        s1 = __SMLAD(__PKHTB(y, x, 16), gains, 1 << 14) >> 15;
+
+        *bus = __QADD16(*bus, __PKHBT(__SSAT(s0, 16), __SSAT(s1, 16), 16));
+        bus++;
+    }
+#else
+    int ga = (int16_t)gains, gb = (int16_t)(gains >> 16);
+
+    while (bus < end)
+    {
+        int s0 = simd_mixer_saturate(((int16_t)*a * ga + (int16_t)*b * gb + (1 << 14)) >> 15);
+        int s1 = simd_mixer_saturate(((int16_t)(*a >> 16) * ga + (int16_t)(*b >> 16) * gb + (1 << 14)) >> 15);
+
+        s0 = simd_mixer_saturate((int16_t)*bus + s0);
+        s1 = simd_mixer_saturate((int16_t)(*bus >> 16) + s1);
+
+        *bus++ = ((uint32_t)s1 << 16) | (uint16_t)s0;
+        a++;
+        b++;
+    }
+#endif
+}
+
+/**
+ * Creates a SimdMixerChannel reading from the given source.
+ */
+SimdMixerChannel::SimdMixerChannel(DataSource &source, int range, int volume) : source(source)
+{
+    this->position = 0;
+
+    setRange(range);
+    setVolume(volume);
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Callback provided when data is ready. Samples are pulled as the mixer needs them, so nothing is done here.
+ */
+int
+SimdMixerChannel::pullRequest()
+{
+    return DEVICE_OK;
+}
+
+/**
+ * Fills the given array with the next n samples from the source, as signed 16 bit values.
+ */
+void
+SimdMixerChannel::stage(int16_t *out, int n)
+{
+    int staged;
+
+    while (n > 0)
+    {
+        if (position * DATASTREAM_FORMAT_BYTES_PER_SAMPLE(source.getFormat()) >= in.length())
+        {
+            in = source.pull();
+            position = 0;
+        }
+
+        switch (in.length() ? source.getFormat() : DATASTREAM_FORMAT_UNKNOWN)
+        {
+            case DATASTREAM_FORMAT_8BIT_SIGNED:
+                staged = stageBuffer<int8_t>(out, n);
+                break;
+
+            case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+                staged = stageBuffer<uint8_t>(out, n);
+                break;
+
+            case DATASTREAM_FORMAT_16BIT_SIGNED:
+                staged = stageBuffer<int16_t>(out, n);
+                break;
+
+            case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+                staged = stageBuffer<uint16_t>(out, n);
+                break;
+
+            default:
+                // The source has nothing (more) to give for now, so the channel is silent.
+                memset(out, 0, n * sizeof(int16_t));
+                in = ManagedBuffer();
+                return;
+        }
+
+        out += staged;
+        n -= staged;
+    }
+}
+
+/**
+ * Copies samples of type T from the current buffer, until n samples have been staged or the buffer is used.
+ */
+template <typename T> int
+SimdMixerChannel::stageBuffer(int16_t *out, int n)
+{
+    T *p = (T *)&in[0] + position;
+    int count = min(n, (int)(in.length() / sizeof(T)) - position);
+    int centre = simd_mixer_signed(T()) ? 0 : (range + 1) / 2;
+
+    for (int i = 0; i < count; i++)
+        out[i] = (int16_t)simd_mixer_scale(p[i] - centre, scale);
+
+    position += count;
+
+    return count;
+}
+
+/**
+ * Sets the volume of this channel.
+ * @param volume the volume, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+ */
+void
+SimdMixerChannel::setVolume(int volume)
+{
+    this->volume = min(max(volume, 0), CONFIG_MIXER_INTERNAL_RANGE);
+}
+
+/**
+ * Determines the volume of this channel, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+ */
+int
+SimdMixerChannel::getVolume()
+{
+    return volume;
+}
+
+/**
+ * Sets the range of the samples produced by the source, for example 255 for 8 bit or 1023 for a synthesizer.
+ */
+void
+SimdMixerChannel::setRange(int range)
+{
+    this->range = max(range, 1);
+    this->scale = (int32_t)((65535LL << 12) / this->range);
+}
+
+/**
+ * Creates a SimdMixer.
+ * @param sampleRate the output sample rate, in Hz.
+ */
+SimdMixer::SimdMixer(float sampleRate)
+{
+    this->downstream = NULL;
+    this->channelCount = 0;
+    this->sampleRate = sampleRate;
+    this->sampleRange = CONFIG_MIXER_INTERNAL_RANGE;
+    this->volume = CONFIG_MIXER_INTERNAL_RANGE;
+    this->orMask = 0;
+}
+
+/**
+ * Destructor. Deletes all channels.
+ */
+SimdMixer::~SimdMixer()
+{
+    while (channelCount)
+        removeChannel(channels[channelCount - 1]);
+}
+
+/**
+ * Adds a channel to the mixer.
+ *
+ * @param source the DataSource to mix. 8 and 16 bit, signed and unsigned, streams are supported.
+ * @param range the range of the samples produced by the source.
+ * @param volume the volume of the channel, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+ * @return the new channel, or NULL if the mixer already has SIMD_MIXER_MAX_CHANNELS channels.
+ */
+SimdMixerChannel *
+SimdMixer::addChannel(DataSource &source, int range, int volume)
+{
+    if (channelCount == SIMD_MIXER_MAX_CHANNELS)
+        return NULL;
+
+    SimdMixerChannel *channel = new SimdMixerChannel(source, range, volume);
+    channels[channelCount++] = channel;
+
+    // Start the stream flowing, if this is our first channel.
+    if (downstream && channelCount == 1)
+        downstream->pullRequest();
+
+    return channel;
+}
+
+/**
+ * Removes a channel from the mixer, and deletes it.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the channel is not part of this mixer.
+ */
+int
+SimdMixer::removeChannel(SimdMixerChannel *channel)
+{
+    for (int i = 0; i < channelCount; i++)
+    {
+        if (channels[i] == channel)
+        {
+            channels[i] = channels[--channelCount];
+            channel->source.disconnect();
+            delete channel;
+
+            return DEVICE_OK;
+        }
+    }
+
+    return DEVICE_INVALID_PARAMETER;
+}
+
+/**
+ * Determines the number of channels being mixed.
+ */
+int
+SimdMixer::getChannelCount()
+{
+    return channelCount;
+}
+
+/**
+ * Provide the next available ManagedBuffer to our downstream caller, holding the next SIMD_MIXER_BUFFER_SAMPLES of the mix.
+ */
+ManagedBuffer
+SimdMixer::pull()
+{
+    const int words = SIMD_MIXER_BUFFER_SAMPLES / 2;
+    SimdMixerChannel *a, *b;
+    uint32_t gains;
+
+    memset(bus, 0, sizeof(bus));
+
+    for (int c = 0; c < channelCount; c += 2)
+    {
+        a = channels[c];
+        b = c + 1 < channelCount ? channels[c + 1] : NULL;
+
+        a->stage((int16_t *)staging[0], SIMD_MIXER_BUFFER_SAMPLES);
+        gains = simd_mixer_gain(a->volume);
+
+        // An odd channel out is mixed with itself, at zero gain.
+        if (b)
+        {
+            b->stage((int16_t *)staging[1], SIMD_MIXER_BUFFER_SAMPLES);
+            gains |= simd_mixer_gain(b->volume) << 16;
+        }
+
+        simd_mixer_accumulate(bus, staging[0], b ? staging[1] : staging[0], gains, words);
+    }
+
+    // Scale the bus into the output range, centred on half of the range.
+    ManagedBuffer output = buffer_pool_allocate(SIMD_MIXER_BUFFER_SAMPLES * sizeof(uint16_t));
+    uint16_t *out = (uint16_t *)&output[0];
+    int16_t *in = (int16_t *)bus;
+    int half = (sampleRange + 1) / 2;
+    int k = half * volume / CONFIG_MIXER_INTERNAL_RANGE;
+    int v;
+
+    for (int i = 0; i < SIMD_MIXER_BUFFER_SAMPLES; i++)
+    {
+        v = ((in[i] * k) >> 15) + half;
+        out[i] = (uint16_t)(min(max(v, 0), sampleRange) | orMask);
+    }
+
+    // As for Mixer2, let our downstream know there is more to come while we have channels.
+    if (downstream && channelCount)
+        downstream->pullRequest();
+
+    return output;
+}
+
+/**
+ * Define a downstream component for data stream.
+ * @param sink The component that data will be delivered to, when it is available
+ */
+void
+SimdMixer::connect(DataSink &sink)
+{
+    downstream = &sink;
+}
+
+/**
+ * Determines if this source is connected to a downstream component
+ */
+bool
+SimdMixer::isConnected()
+{
+    return downstream != NULL;
+}
+
+/**
+ * Disconnect this source from its downstream component
+ */
+void
+SimdMixer::disconnect()
+{
+    downstream = NULL;
+}
+
+/**
+ * Determine the data format of the buffers streamed out of this component.
+ */
+int
+SimdMixer::getFormat()
+{
+    return DATASTREAM_FORMAT_16BIT_UNSIGNED;
+}
+
+/**
+ * Determines the output sample rate.
+ */
+float
+SimdMixer::getSampleRate()
+{
+    return sampleRate;
+}
+
+/**
+ * Sets the output sample rate. Channels are read at this rate.
+ * @return the new output sample rate.
+ */
+float
+SimdMixer::requestSampleRate(float sampleRate)
+{
+    this->sampleRate = sampleRate;
+    return sampleRate;
+}
+
+/**
+ * Sets the master volume.
+ * @param volume the volume, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+ */
+void
+SimdMixer::setVolume(int volume)
+{
+    this->volume = min(max(volume, 0), CONFIG_MIXER_INTERNAL_RANGE);
+}
+
+/**
+ * Determines the master volume, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+ */
+int
+SimdMixer::getVolume()
+{
+    return volume;
+}
+
+/**
+ * Sets the range of the output samples, which run from 0 to range. For NRF52PWM, use its getSampleRange().
+ */
+void
+SimdMixer::setSampleRange(int range)
+{
+    sampleRange = min(max(range, 1), 65535);
+}
+
+/**
+ * Sets a mask that is ORed into every output sample.
+ */
+void
+SimdMixer::setOrMask(uint32_t mask)
+{
+    orMask = mask;
+}
@@ -0,0 +1,209 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef SIMD_MIXER_H
+#define SIMD_MIXER_H
+
+// Length of each output buffer, in samples (a multiple of two), and the largest number of channels.
+#define SIMD_MIXER_BUFFER_SAMPLES       256
+#define SIMD_MIXER_MAX_CHANNELS         16
+
+#define SIMD_MIXER_DEFAULT_SAMPLE_RATE  44100
+
+class SimdMixer;
+
+/**
+ * A single input to a SimdMixer. Samples are read from the source at the mixer's sample rate.
+ */
+class SimdMixerChannel : public DataSink
+{
+    friend class SimdMixer;
+
+    DataSource      &source;
+    ManagedBuffer   in;                 // Buffer currently being read from the source.
+    int             position;           // Next sample to read from the buffer.
+    int             range;              // Range of the source samples, from 0 (or -range/2 if signed) to range.
+    int32_t         scale;              // Scale from source samples to 16 bit, in Q12.
+    int             volume;
+
+    /**
+     * Fills the given array with the next n samples from the source, as signed 16 bit values.
+     */
+    void stage(int16_t *out, int n);
+
+    /**
+     * Copies samples of type T from the current buffer, until n samples have been staged or the buffer is used.
+     */
+    template <typename T> int stageBuffer(int16_t *out, int n);
+
+    public:
+    /**
+     * Creates a SimdMixerChannel reading from the given source.
+     */
+    SimdMixerChannel(DataSource &source, int range, int volume);
+
+    /**
+     * Callback provided when data is ready. Samples are pulled as the mixer needs them, so nothing is done here.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Sets the volume of this channel.
+     * @param volume the volume, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+     */
+    void setVolume(int volume);
+
+    /**
+     * Determines the volume of this channel, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+     */
+    int getVolume();
+
+    /**
+     * Sets the range of the samples produced by the source, for example 255 for 8 bit or 1023 for a synthesizer.
+     */
+    void setRange(int range);
+};
+
+/**
+ * A DataSource that mixes up to SIMD_MIXER_MAX_CHANNELS sources, using dual 16 bit arithmetic so the cost
+ * per channel stays low enough for 8 or more voices within the output buffer deadline.
+ *
+ * Each channel is first staged as signed 16 bit samples. Channels are then mixed in pairs: a __SMLAD
+ * multiplies one sample from each of the two channels by that channel's Q15 volume and sums them, and the
+ * result is accumulated into a 16 bit mix bus with __QADD16, two output samples at a time. The bus therefore
+ * saturates, rather than wrapping, when many loud channels overlap. Finally the bus is scaled by the master
+ * volume into the output range, as 16 bit unsigned samples combined with the OR mask, ready for NRF52PWM.
+ *
+ * All channels are read at the mixer's sample rate. A source at another rate should be connected through
+ * a SampleRateConverter.
+ */
+class SimdMixer : public DataSource
+{
+    DataSink            *downstream;
+    SimdMixerChannel    *channels[SIMD_MIXER_MAX_CHANNELS];
+    int                 channelCount;
+    float               sampleRate;
+    int                 sampleRange;
+    int                 volume;
+    uint32_t            orMask;
+    uint32_t            bus[SIMD_MIXER_BUFFER_SAMPLES / 2];         // Mix bus, as packed pairs of signed 16 bit samples.
+    uint32_t            staging[2][SIMD_MIXER_BUFFER_SAMPLES / 2];  // A pair of staged channels, packed the same way.
+
+    public:
+    /**
+     * Creates a SimdMixer.
+     * @param sampleRate the output sample rate, in Hz.
+     */
+    SimdMixer(float sampleRate = SIMD_MIXER_DEFAULT_SAMPLE_RATE);
+
+    /**
+     * Destructor. Deletes all channels.
+     */
+    ~SimdMixer();
+
+    /**
+     * Adds a channel to the mixer.
+     *
+     * @param source the DataSource to mix. 8 and 16 bit, signed and unsigned, streams are supported.
+     * @param range the range of the samples produced by the source.
+     * @param volume the volume of the channel, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+     * @return the new channel, or NULL if the mixer already has SIMD_MIXER_MAX_CHANNELS channels.
+     */
+    SimdMixerChannel *addChannel(DataSource &source, int range = CONFIG_MIXER_INTERNAL_RANGE, int volume = CONFIG_MIXER_INTERNAL_RANGE);
+
+    /**
+     * Removes a channel from the mixer, and deletes it.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the channel is not part of this mixer.
+     */
+    int removeChannel(SimdMixerChannel *channel);
+
+    /**
+     * Determines the number of channels being mixed.
+     */
+    int getChannelCount();
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller, holding the next SIMD_MIXER_BUFFER_SAMPLES of the mix.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the buffers streamed out of this component.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the output sample rate.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Sets the output sample rate. Channels are read at this rate.
+     * @return the new output sample rate.
+     */
+    virtual float requestSampleRate(float sampleRate);
+
+    /**
+     * Sets the master volume.
+     * @param volume the volume, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+     */
+    void setVolume(int volume);
+
+    /**
+     * Determines the master volume, from 0 to CONFIG_MIXER_INTERNAL_RANGE.
+     */
+    int getVolume();
+
+    /**
+     * Sets the range of the output samples, which run from 0 to range. For NRF52PWM, use its getSampleRange().
+     */
+    void setSampleRange(int range);
+
+    /**
+     * Sets a mask that is ORed into every output sample.
+     */
+    void setOrMask(uint32_t mask);
+};
+
+#endif
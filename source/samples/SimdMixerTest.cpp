@@ -0,0 +1,219 @@
+#include "MicroBit.h"
+#include "SimdMixer.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define SIMD_MIXER_BENCHMARK_ITERATIONS     20
+#define SIMD_MIXER_BENCHMARK_RANGE          1023
+#define SIMD_MIXER_BENCHMARK_VOLUME         (CONFIG_MIXER_INTERNAL_RANGE / SIMD_MIXER_MAX_CHANNELS)
+#define SIMD_MIXER_BENCHMARK_TOLERANCE      2
+
+/**
+ * A DataSource that hands out the same buffer of a sawtooth on every pull, in the unsigned 0..1023
+ * format produced by the synthesizers.
+ */
+class SimdMixerBenchmarkSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+
+    SimdMixerBenchmarkSource(int period) : buffer(SIMD_MIXER_BUFFER_SAMPLES * sizeof(uint16_t))
+    {
+        uint16_t *p = (uint16_t *)&buffer[0];
+
+        for (int i = 0; i < SIMD_MIXER_BUFFER_SAMPLES; i++)
+            p[i] = (uint16_t)((i % period) * SIMD_MIXER_BENCHMARK_RANGE / (period - 1));
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return DATASTREAM_FORMAT_16BIT_UNSIGNED;
+    }
+};
+
+/**
+ * A straightforward floating point mix, one sample at a time, retained as the baseline for the benchmark.
+ * Each channel is scaled by its volume, and the mix by the master volume, as in SimdMixer.
+ */
+static ManagedBuffer
+simd_mixer_reference(SimdMixerBenchmarkSource **sources, int count, int volume, int outputRange)
+{
+    ManagedBuffer output(SIMD_MIXER_BUFFER_SAMPLES * sizeof(uint16_t));
+    ManagedBuffer in[SIMD_MIXER_MAX_CHANNELS];
+    uint16_t *out = (uint16_t *)&output[0];
+    float half = (SIMD_MIXER_BENCHMARK_RANGE + 1) / 2.0f;
+    float gain = (float)volume / CONFIG_MIXER_INTERNAL_RANGE;
+    int outputHalf = (outputRange + 1) / 2;
+
+    for (int c = 0; c < count; c++)
+        in[c] = sources[c]->pull();
+
+    for (int i = 0; i < SIMD_MIXER_BUFFER_SAMPLES; i++)
+    {
+        float mix = 0.0f;
+
+        for (int c = 0; c < count; c++)
+            mix += (((uint16_t *)&in[c][0])[i] - half) / half * gain;
+
+        mix = mix < -1.0f ? -1.0f : mix > 1.0f ? 1.0f : mix;
+        out[i] = (uint16_t)min((int)((mix + 1.0f) * outputHalf + 0.5f), outputRange);
+    }
+
+    return output;
+}
+
+/**
+ * Determines the largest difference between two buffers of 16 bit unsigned samples.
+ */
+static int
+simd_mixer_difference(ManagedBuffer &a, ManagedBuffer &b)
+{
+    uint16_t *p = (uint16_t *)&a[0];
+    uint16_t *q = (uint16_t *)&b[0];
+    int worst = 0;
+
+    for (int i = 0; i < SIMD_MIXER_BUFFER_SAMPLES; i++)
+        worst = max(worst, abs(p[i] - q[i]));
+
+    return worst;
+}
+
+/**
+ * Measures the cost of mixing 1 to SIMD_MIXER_MAX_CHANNELS channels into one output buffer, against the
+ * reference mix, and compares it to the time the buffer takes to play at 44.1kHz. The two mixes are also
+ * compared, and must agree to within SIMD_MIXER_BENCHMARK_TOLERANCE. Results are written to DMESG.
+ */
+void
+simd_mixer_benchmark()
+{
+    SimdMixerBenchmarkSource *sources[SIMD_MIXER_MAX_CHANNELS];
+    SimdMixer *mixer = new SimdMixer(SIMD_MIXER_DEFAULT_SAMPLE_RATE);
+    uint32_t deadline = (uint32_t)((uint64_t)SIMD_MIXER_BUFFER_SAMPLES * SystemCoreClock / SIMD_MIXER_DEFAULT_SAMPLE_RATE);
+    bool pass = true;
+
+    cycle_counter_enable();
+
+    DMESG("SIMD_MIXER_BENCHMARK: %d samples/buffer, deadline %d cycles", SIMD_MIXER_BUFFER_SAMPLES, (int)deadline);
+
+    for (int c = 0; c < SIMD_MIXER_MAX_CHANNELS; c++)
+    {
+        // Coprime periods, so the channels do not line up. The volume is low enough that the mix never clips.
+        sources[c] = new SimdMixerBenchmarkSource(37 + 6 * c);
+        mixer->addChannel(*sources[c], SIMD_MIXER_BENCHMARK_RANGE, SIMD_MIXER_BENCHMARK_VOLUME);
+
+        uint32_t start = cycle_counter_read();
+        for (int i = 0; i < SIMD_MIXER_BENCHMARK_ITERATIONS; i++)
+            mixer->pull();
+        uint32_t simdCycles = (cycle_counter_read() - start) / SIMD_MIXER_BENCHMARK_ITERATIONS;
+
+        start = cycle_counter_read();
+        for (int i = 0; i < SIMD_MIXER_BENCHMARK_ITERATIONS; i++)
+            simd_mixer_reference(sources, c + 1, SIMD_MIXER_BENCHMARK_VOLUME, CONFIG_MIXER_INTERNAL_RANGE);
+        uint32_t referenceCycles = (cycle_counter_read() - start) / SIMD_MIXER_BENCHMARK_ITERATIONS;
+
+        ManagedBuffer simd = mixer->pull();
+        ManagedBuffer reference = simd_mixer_reference(sources, c + 1, SIMD_MIXER_BENCHMARK_VOLUME, CONFIG_MIXER_INTERNAL_RANGE);
+        int error = simd_mixer_difference(simd, reference);
+
+        pass = pass && error <= SIMD_MIXER_BENCHMARK_TOLERANCE;
+
+        DMESG("   %d CHANNELS: SIMD %d cycles/buffer (%d%% of deadline) REFERENCE %d cycles/buffer (%d%%) MAX ERROR %d", c + 1,
+            (int)simdCycles, (int)(simdCycles * 100 / deadline), (int)referenceCycles, (int)(referenceCycles * 100 / deadline), error);
+    }
+
+    DMESG("   RESULTS: %s", pass ? "PASS" : "FAIL");
+
+    // The mixer disconnects and deletes its channels, so must go before the sources.
+    delete mixer;
+
+    for (int c = 0; c < SIMD_MIXER_MAX_CHANNELS; c++)
+        delete sources[c];
+}
+
+/**
+ * A DataSource that hands out a full scale ramp in 16 bit samples, signed or unsigned.
+ */
+class SimdMixer16BitSource : public DataSource
+{
+    public:
+    ManagedBuffer buffer;
+    int format;
+
+    SimdMixer16BitSource(int format) : buffer(SIMD_MIXER_BUFFER_SAMPLES * sizeof(int16_t))
+    {
+        int16_t *p = (int16_t *)&buffer[0];
+
+        this->format = format;
+
+        for (int i = 0; i < SIMD_MIXER_BUFFER_SAMPLES; i++)
+            p[i] = (int16_t)(i * 65535 / (SIMD_MIXER_BUFFER_SAMPLES - 1) - 32768) ^ (format == DATASTREAM_FORMAT_16BIT_UNSIGNED ? 0x8000 : 0);
+    }
+
+    virtual ManagedBuffer pull()
+    {
+        return buffer;
+    }
+
+    virtual int getFormat()
+    {
+        return format;
+    }
+};
+
+/**
+ * Mixes a full scale 16 bit ramp through one channel at full volume, and checks every output sample
+ * against the expected value: the ramp scaled up from the given range, clipped to 16 bits, and mapped
+ * onto the output range. Returns the largest difference.
+ */
+static int
+simd_mixer_16bit_check(int format, int range)
+{
+    SimdMixer16BitSource source(format);
+    SimdMixer mixer;
+
+    mixer.addChannel(source, range, CONFIG_MIXER_INTERNAL_RANGE);
+
+    ManagedBuffer output = mixer.pull();
+    uint16_t *out = (uint16_t *)&output[0];
+    int16_t *in = (int16_t *)&source.buffer[0];
+    int half = (CONFIG_MIXER_INTERNAL_RANGE + 1) / 2;
+    int worst = 0;
+
+    for (int i = 0; i < SIMD_MIXER_BUFFER_SAMPLES; i++)
+    {
+        int s = format == DATASTREAM_FORMAT_16BIT_UNSIGNED ? (uint16_t)in[i] - (range + 1) / 2 : in[i];
+        float x = s * 65535.0f / range;
+
+        x = x < -32768.0f ? -32768.0f : x > 32767.0f ? 32767.0f : x;
+        int expected = min(max((int)(x * half / 32768.0f + half + 0.5f), 0), CONFIG_MIXER_INTERNAL_RANGE);
+
+        worst = max(worst, abs(out[i] - expected));
+    }
+
+    return worst;
+}
+
+/**
+ * Checks that full scale 16 bit sources are mixed without wrapping: at their full range, and with the
+ * default range, where the samples are larger than the range and must clip. Results are written to DMESG.
+ */
+void
+simd_mixer_16bit_test()
+{
+    DMESG("SIMD_MIXER_16BIT_TEST: STARTING...");
+
+    int signedFull = simd_mixer_16bit_check(DATASTREAM_FORMAT_16BIT_SIGNED, 65535);
+    int unsignedFull = simd_mixer_16bit_check(DATASTREAM_FORMAT_16BIT_UNSIGNED, 65535);
+    int signedClipped = simd_mixer_16bit_check(DATASTREAM_FORMAT_16BIT_SIGNED, CONFIG_MIXER_INTERNAL_RANGE);
+    int unsignedClipped = simd_mixer_16bit_check(DATASTREAM_FORMAT_16BIT_UNSIGNED, CONFIG_MIXER_INTERNAL_RANGE);
+    bool pass = max(max(signedFull, unsignedFull), max(signedClipped, unsignedClipped)) <= SIMD_MIXER_BENCHMARK_TOLERANCE;
+
+    DMESG("   SIGNED: MAX ERROR %d, CLIPPED %d", signedFull, signedClipped);
+    DMESG("   UNSIGNED: MAX ERROR %d, CLIPPED %d", unsignedFull, unsignedClipped);
+    DMESG("   RESULTS: %s", pass ? "PASS" : "FAIL");
+}
@@ -0,0 +1,305 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SoundExpressionCompiler.h"
+#include "SoundSynthesizerEffects.h"
+#include "Tests.h"
+
+#if CONFIG_ENABLED(SOUND_EXPRESSION_BUILTINS)
+#include "SoundExpressionBuiltins.h"
+#endif
+
+/**
+ * Deliberately not constexpr: reaching it while decoding a sound expression in a constant expression
+ * (because a character is not a digit, or the frame is not SOUND_EXPRESSION_LENGTH long) is a compile error.
+ */
+int sound_expression_invalid()
+{
+    return 0;
+}
+
+/**
+ * Applies a random offset of up to +/- the given range to a value. As in SoundExpressions, a value pushed below
+ * zero is reflected back, not clamped.
+ */
+static int sound_expression_random(int value, int range)
+{
+    if (range == 0)
+        return value;
+
+    return abs(value + (int)uBit.random(2 * range + 1) - range);
+}
+
+/**
+ * Converts a compiled frame into a SoundEffect, with the mapping SoundExpressions uses. Any randomness in the
+ * frame is ignored.
+ */
+void sound_expression_effect(const SoundExpressionFrame &f, SoundEffect *fx)
+{
+    memset(fx, 0, sizeof(SoundEffect));
+
+    switch (f.wave)
+    {
+        case 1: fx->tone.tonePrint = Synthesizer::SawtoothTone; break;
+        case 2: fx->tone.tonePrint = Synthesizer::TriangleTone; break;
+        case 3: fx->tone.tonePrint = Synthesizer::SquareWaveTone; break;
+        case 4: fx->tone.tonePrint = Synthesizer::NoiseTone; break;
+        default: fx->tone.tonePrint = Synthesizer::SineTone; break;
+    }
+
+    fx->frequency = f.frequency;
+    fx->volume = f.volume / 1023.0f;
+    fx->duration = f.duration;
+
+    // Frequency, from the start to the end frequency along the given curve.
+    fx->effects[0].steps = f.steps;
+    fx->effects[0].parameter[0] = f.endFrequency;
+
+    switch (f.shape)
+    {
+        case 0: fx->effects[0].effect = SoundSynthesizerEffects::noInterpolation; break;
+        case 2: fx->effects[0].effect = SoundSynthesizerEffects::curveInterpolation; break;
+        case 5: fx->effects[0].effect = SoundSynthesizerEffects::exponentialRisingInterpolation; break;
+        case 6: fx->effects[0].effect = SoundSynthesizerEffects::exponentialFallingInterpolation; break;
+        case 18: fx->effects[0].effect = SoundSynthesizerEffects::logarithmicInterpolation; break;
+        default: fx->effects[0].effect = SoundSynthesizerEffects::linearInterpolation; break;
+    }
+
+    // Shapes 8 to 17 are arpeggios, ascending on even values and descending on odd ones.
+    if (f.shape >= 8 && f.shape <= 17)
+    {
+        fx->effects[0].effect = f.shape & 1 ? SoundSynthesizerEffects::appregrioDescending : SoundSynthesizerEffects::appregrioAscending;
+
+        switch ((f.shape - 8) / 2)
+        {
+            case 0: fx->effects[0].parameter_p[0] = MusicalProgressions::majorTriad; break;
+            case 1: fx->effects[0].parameter_p[0] = MusicalProgressions::minorTriad; break;
+            case 2: fx->effects[0].parameter_p[0] = MusicalProgressions::diminished; break;
+            case 3: fx->effects[0].parameter_p[0] = MusicalProgressions::chromatic; break;
+            default: fx->effects[0].parameter_p[0] = MusicalProgressions::wholeTone; break;
+        }
+    }
+
+    // Volume, ramping linearly to the end volume.
+    fx->effects[1].effect = SoundSynthesizerEffects::volumeRampEffect;
+    fx->effects[1].steps = SOUND_EXPRESSION_VOLUME_STEPS;
+    fx->effects[1].parameter[0] = f.endVolume / 1023.0f;
+
+    // Optional vibrato, tremolo or warble.
+    fx->effects[2].steps = f.fxSteps;
+    fx->effects[2].parameter[0] = f.fxParam;
+
+    switch (f.fx)
+    {
+        case 1: fx->effects[2].effect = SoundSynthesizerEffects::frequencyVibratoEffect; break;
+        case 2: fx->effects[2].effect = SoundSynthesizerEffects::volumeVibratoEffect; break;
+        case 3: fx->effects[2].effect = SoundSynthesizerEffects::warbleInterpolation; break;
+    }
+}
+
+/**
+ * Finds one of the built-in sounds ("giggle", "happy", ...) by name.
+ *
+ * The built-in sounds are defined by the CODAL library, so their compiled table is generated from its sources by
+ * utils/audio/sound_expression_gen.py, and included when SOUND_EXPRESSION_BUILTINS is enabled in codal.json.
+ *
+ * @return the entry, or NULL if the name is not a built-in sound, or the table is not included.
+ */
+const SoundExpressionEntry *
+sound_expression_builtin(const char *name)
+{
+#if CONFIG_ENABLED(SOUND_EXPRESSION_BUILTINS)
+    for (int i = 0; i < SOUND_EXPRESSION_BUILTIN_COUNT; i++)
+        if (strcmp(sound_expression_builtins[i].name, name) == 0)
+            return &sound_expression_builtins[i];
+#else
+    (void) name;
+#endif
+
+    return NULL;
+}
+
+/**
+ * Determines if any of the fields of a frame are randomised.
+ */
+static bool sound_expression_random(const SoundExpressionFrame &f)
+{
+    return f.frequencyRandomness || f.endFrequencyRandomness || f.volumeRandomness || f.endVolumeRandomness ||
+        f.durationRandomness || f.fxParamRandomness || f.fxStepsRandomness;
+}
+
+/**
+ * A buffer of SoundEffects to be played on its own fiber, by playAsync().
+ */
+struct SoundExpressionAsync
+{
+    SoundEmojiSynthesizer   *synth;
+    ManagedBuffer           effects;
+};
+
+static void sound_expression_play_async(void *param)
+{
+    SoundExpressionAsync *a = (SoundExpressionAsync *)param;
+
+    a->synth->play(a->effects);
+    delete a;
+}
+
+/**
+ * Creates a SoundExpressionPlayer.
+ *
+ * @param synth the synthesizer to play on.
+ * @param table an optional table of named expressions, for play(const char *).
+ * @param tableSize the number of entries in the table.
+ */
+SoundExpressionPlayer::SoundExpressionPlayer(SoundEmojiSynthesizer &synth, const SoundExpressionEntry *table, int tableSize) : synth(synth)
+{
+    this->table = table;
+    this->tableSize = tableSize;
+    this->slots = 0;
+}
+
+/**
+ * Converts compiled frames into SoundEffects, ready to play.
+ *
+ * @param frames the compiled frames, which must remain valid (typically a constexpr array in flash).
+ * @param count the number of frames.
+ * @return a handle for play(), or DEVICE_NO_RESOURCES if all SOUND_EXPRESSION_PLAYER_SLOTS are in use.
+ */
+int
+SoundExpressionPlayer::add(const SoundExpressionFrame *frames, int count)
+{
+    if (slots == SOUND_EXPRESSION_PLAYER_SLOTS)
+        return DEVICE_NO_RESOURCES;
+
+    ManagedBuffer b(count * sizeof(SoundEffect));
+    SoundEffect *fx = (SoundEffect *)&b[0];
+    bool random = false;
+
+    for (int i = 0; i < count; i++)
+    {
+        sound_expression_effect(frames[i], &fx[i]);
+        random |= sound_expression_random(frames[i]);
+    }
+
+    this->frames[slots] = frames;
+    this->counts[slots] = count;
+    this->effects[slots] = b;
+    this->randomised[slots] = random;
+
+    return slots++;
+}
+
+/**
+ * Provides the SoundEffects to play for the given slot: the compiled buffer itself, or, if any of its frames
+ * are randomised, a copy with fresh randomness applied.
+ */
+ManagedBuffer
+SoundExpressionPlayer::randomise(int slot)
+{
+    if (!randomised[slot])
+        return effects[slot];
+
+    ManagedBuffer b(&effects[slot][0], effects[slot].length());
+    SoundEffect *fx = (SoundEffect *)&b[0];
+
+    for (int i = 0; i < counts[slot]; i++)
+    {
+        const SoundExpressionFrame &f = frames[slot][i];
+
+        if (!sound_expression_random(f))
+            continue;
+
+        fx[i].frequency = sound_expression_random(f.frequency, f.frequencyRandomness);
+        fx[i].volume = sound_expression_random(f.volume, f.volumeRandomness) / 1023.0f;
+        fx[i].duration = sound_expression_random(f.duration, f.durationRandomness);
+        fx[i].effects[0].parameter[0] = sound_expression_random(f.endFrequency, f.endFrequencyRandomness);
+        fx[i].effects[1].parameter[0] = sound_expression_random(f.endVolume, f.endVolumeRandomness) / 1023.0f;
+        fx[i].effects[2].parameter[0] = sound_expression_random(f.fxParam, f.fxParamRandomness);
+        fx[i].effects[2].steps = sound_expression_random(f.fxSteps, f.fxStepsRandomness);
+    }
+
+    return b;
+}
+
+/**
+ * Plays an expression returned by add(), returning when it has finished.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the handle is not valid.
+ */
+int
+SoundExpressionPlayer::play(int handle)
+{
+    if (handle < 0 || handle >= slots)
+        return DEVICE_INVALID_PARAMETER;
+
+    synth.play(randomise(handle));
+
+    return DEVICE_OK;
+}
+
+/**
+ * Starts an expression returned by add() on its own fiber, and returns at once, as SoundExpressions::playAsync() does.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the handle is not valid.
+ */
+int
+SoundExpressionPlayer::playAsync(int handle)
+{
+    if (handle < 0 || handle >= slots)
+        return DEVICE_INVALID_PARAMETER;
+
+    SoundExpressionAsync *a = new SoundExpressionAsync();
+
+    a->synth = &synth;
+    a->effects = randomise(handle);
+    create_fiber(sound_expression_play_async, a);
+
+    return DEVICE_OK;
+}
+
+/**
+ * Plays an expression by name, from the table given to the constructor or the built-in sounds ("giggle",
+ * "happy", ...), adding it on first use.
+ * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the name is not known.
+ */
+int
+SoundExpressionPlayer::play(const char *name)
+{
+    const SoundExpressionEntry *entry = NULL;
+
+    for (int i = 0; i < tableSize && entry == NULL; i++)
+        if (strcmp(table[i].name, name) == 0)
+            entry = &table[i];
+
+    if (entry == NULL)
+        entry = sound_expression_builtin(name);
+
+    if (entry == NULL)
+        return DEVICE_INVALID_PARAMETER;
+
+    for (int s = 0; s < slots; s++)
+        if (frames[s] == entry->frames)
+            return play(s);
+
+    return play(add(entry->frames, entry->count));
+}
@@ -0,0 +1,216 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "SoundEmojiSynthesizer.h"
+
+#ifndef SOUND_EXPRESSION_COMPILER_H
+#define SOUND_EXPRESSION_COMPILER_H
+
+// Length of one encoded sound expression frame, in characters.
+#define SOUND_EXPRESSION_LENGTH         72
+
+// The largest number of compiled expressions a SoundExpressionPlayer can hold.
+#define SOUND_EXPRESSION_PLAYER_SLOTS   16
+
+// Steps in the volume ramp of every frame. SoundExpressions uses this, not the frame's own steps.
+#define SOUND_EXPRESSION_VOLUME_STEPS   36
+
+/**
+ * The fields of one frame of an encoded sound expression, as decimal digits at fixed offsets, as
+ * used by SoundExpressions. Characters 15-17 and 22-25 are unused.
+ */
+struct SoundExpressionFrame
+{
+    uint8_t         wave;               // [0]     0-4: sine, sawtooth, triangle, square, noise.
+    uint16_t        volume;             // [1-4]   0-1023.
+    uint16_t        frequency;          // [5-8]   Hz.
+    uint16_t        duration;           // [9-12]  ms.
+    uint8_t         shape;              // [13-14] Frequency interpolation curve.
+    uint16_t        endFrequency;       // [18-21] Hz.
+    uint16_t        endVolume;          // [26-29] 0-1023.
+    uint16_t        steps;              // [30-33] Interpolation steps.
+    uint8_t         fx;                 // [34-35] 0 none, 1 vibrato, 2 tremolo, 3 warble.
+    uint16_t        fxParam;            // [36-39]
+    uint16_t        fxSteps;            // [40-43]
+    uint16_t        frequencyRandomness;    // [44-47]
+    uint16_t        endFrequencyRandomness; // [48-51]
+    uint16_t        volumeRandomness;       // [52-55]
+    uint16_t        endVolumeRandomness;    // [56-59]
+    uint16_t        durationRandomness;     // [60-63]
+    uint16_t        fxParamRandomness;      // [64-67]
+    uint16_t        fxStepsRandomness;      // [68-71]
+};
+
+/**
+ * Deliberately not constexpr: reaching it while decoding a sound expression in a constant expression
+ * (because a character is not a digit, or the frame is not SOUND_EXPRESSION_LENGTH long) is a compile error.
+ */
+int sound_expression_invalid();
+
+/**
+ * Decodes a decimal field of a sound expression, at compile time when used in a constant expression.
+ */
+constexpr int sound_expression_digit(char c)
+{
+    return c >= '0' && c <= '9' ? c - '0' : sound_expression_invalid();
+}
+
+constexpr int sound_expression_field(const char *s, int offset, int length)
+{
+    return length == 0 ? 0 : sound_expression_field(s, offset, length - 1) * 10 + sound_expression_digit(s[offset + length - 1]);
+}
+
+constexpr bool sound_expression_terminated(const char *s)
+{
+    return s[SOUND_EXPRESSION_LENGTH] == '\0' || s[SOUND_EXPRESSION_LENGTH] == ',' ? true : sound_expression_invalid();
+}
+
+/**
+ * Decodes one frame of a sound expression. Declare the result constexpr to decode it at compile time, so only
+ * the binary frame is stored in flash:
+ *
+ *     static constexpr SoundExpressionFrame shake[] = { sound_expression_compile("0023730410500010003923...") };
+ *
+ * @param s the encoded frame, SOUND_EXPRESSION_LENGTH digits long.
+ * @param frame the index of the frame to decode, in a string of comma separated frames.
+ */
+constexpr SoundExpressionFrame sound_expression_compile(const char *s, int frame = 0)
+{
+    return frame > 0 ? sound_expression_compile(s + SOUND_EXPRESSION_LENGTH + 1, frame - 1) :
+        sound_expression_terminated(s) ? SoundExpressionFrame {
+            (uint8_t) sound_expression_field(s, 0, 1),
+            (uint16_t) sound_expression_field(s, 1, 4),
+            (uint16_t) sound_expression_field(s, 5, 4),
+            (uint16_t) sound_expression_field(s, 9, 4),
+            (uint8_t) sound_expression_field(s, 13, 2),
+            (uint16_t) sound_expression_field(s, 18, 4),
+            (uint16_t) sound_expression_field(s, 26, 4),
+            (uint16_t) sound_expression_field(s, 30, 4),
+            (uint8_t) sound_expression_field(s, 34, 2),
+            (uint16_t) sound_expression_field(s, 36, 4),
+            (uint16_t) sound_expression_field(s, 40, 4),
+            (uint16_t) sound_expression_field(s, 44, 4),
+            (uint16_t) sound_expression_field(s, 48, 4),
+            (uint16_t) sound_expression_field(s, 52, 4),
+            (uint16_t) sound_expression_field(s, 56, 4),
+            (uint16_t) sound_expression_field(s, 60, 4),
+            (uint16_t) sound_expression_field(s, 64, 4),
+            (uint16_t) sound_expression_field(s, 68, 4)
+        } : SoundExpressionFrame();
+}
+
+/**
+ * Converts a compiled frame into a SoundEffect, with the mapping SoundExpressions uses. Any randomness in the
+ * frame is ignored.
+ */
+void sound_expression_effect(const SoundExpressionFrame &f, SoundEffect *fx);
+
+/**
+ * A named, compiled sound expression, for use in a flash resident lookup table.
+ */
+struct SoundExpressionEntry
+{
+    const char                  *name;
+    const SoundExpressionFrame  *frames;
+    int                         count;
+};
+
+/**
+ * Finds one of the built-in sounds ("giggle", "happy", ...) by name.
+ *
+ * The built-in sounds are defined by the CODAL library, so their compiled table is generated from its sources by
+ * utils/audio/sound_expression_gen.py, and included when SOUND_EXPRESSION_BUILTINS is enabled in codal.json.
+ *
+ * @return the entry, or NULL if the name is not a built-in sound, or the table is not included.
+ */
+const SoundExpressionEntry *sound_expression_builtin(const char *name);
+
+/**
+ * Plays compiled sound expressions on a SoundEmojiSynthesizer.
+ *
+ * Each expression is converted to a buffer of SoundEffects once, when it is first added or played by name,
+ * so starting a sound needs no parsing and no heap allocation. An expression with randomness in any frame is
+ * instead copied each time it is played, and the randomness applied to the copy, so the compiled buffer is
+ * never changed, even while an earlier copy is still playing. play() returns when the sound has finished; playAsync() plays it on a new
+ * fiber, as SoundExpressions::playAsync() does, and that fiber is the only allocation.
+ */
+class SoundExpressionPlayer
+{
+    SoundEmojiSynthesizer           &synth;
+    const SoundExpressionEntry      *table;
+    int                             tableSize;
+    const SoundExpressionFrame      *frames[SOUND_EXPRESSION_PLAYER_SLOTS];
+    int                             counts[SOUND_EXPRESSION_PLAYER_SLOTS];
+    ManagedBuffer                   effects[SOUND_EXPRESSION_PLAYER_SLOTS];
+    bool                            randomised[SOUND_EXPRESSION_PLAYER_SLOTS];
+    int                             slots;
+
+    /**
+     * Provides the SoundEffects to play for the given slot: the compiled buffer itself, or, if any of its frames
+     * are randomised, a copy with fresh randomness applied.
+     */
+    ManagedBuffer randomise(int slot);
+
+    public:
+    /**
+     * Creates a SoundExpressionPlayer.
+     *
+     * @param synth the synthesizer to play on.
+     * @param table an optional table of named expressions, for play(const char *), searched before the built-ins.
+     * @param tableSize the number of entries in the table.
+     */
+    SoundExpressionPlayer(SoundEmojiSynthesizer &synth, const SoundExpressionEntry *table = NULL, int tableSize = 0);
+
+    /**
+     * Converts compiled frames into SoundEffects, ready to play.
+     *
+     * @param frames the compiled frames, which must remain valid (typically a constexpr array in flash).
+     * @param count the number of frames.
+     * @return a handle for play(), or DEVICE_NO_RESOURCES if all SOUND_EXPRESSION_PLAYER_SLOTS are in use.
+     */
+    int add(const SoundExpressionFrame *frames, int count);
+
+    /**
+     * Plays an expression returned by add(), returning when it has finished.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the handle is not valid.
+     */
+    int play(int handle);
+
+    /**
+     * Starts an expression returned by add() on its own fiber, and returns at once, as SoundExpressions::playAsync() does.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the handle is not valid.
+     */
+    int playAsync(int handle);
+
+    /**
+     * Plays an expression by name, from the table given to the constructor or the built-in sounds ("giggle",
+     * "happy", ...), adding it on first use.
+     * @return DEVICE_OK, or DEVICE_INVALID_PARAMETER if the name is not known.
+     */
+    int play(const char *name);
+};
+
+#endif
@@ -0,0 +1,75 @@
+// SoundExpressions keeps its parser private, so open it up here to compare its output with the compiler's.
+#define private public
+#include "SoundExpressions.h"
+#undef private
+
+#include "MicroBit.h"
+#include "SoundExpressionCompiler.h"
+#include "Tests.h"
+
+// Frames with no randomness, so the parser's output is deterministic: the OOB shake and screen down sounds,
+// "sad" with its zero-duration frame, and frames covering the remaining waves, shapes and effects.
+#define SOUND_EXPRESSION_TEST_FRAMES    10
+
+static const char *soundExpressionTestStrings[SOUND_EXPRESSION_TEST_FRAMES] = {
+    "002373041050001000392300001023010802050005000000000000000000000000000000",
+    "010230849100001000000100000000012800000100240000000000000000000000000000",
+    "010232279000001440226608881023012800000000240000000000000000000000000000",
+    "000000440000000440044008880000012800000000240000000000000000000000000000",
+    "310232226070801440162408881023012800000100240000000000000000000000000000",
+    "310231623093602440093908880000012800000100240000000000000000000000000000",
+    "108000440050002000088000000200012801001000240000000000000000000000000000",
+    "310230262040009000052300000000006402000500120000000000000000000000000000",
+    "405121000030018000010000001023003203000200080000000000000000000000000000",
+    "210000330020005000066000000512010000000000000000000000000000000000000000"
+};
+
+static constexpr SoundExpressionFrame soundExpressionTestFrames[SOUND_EXPRESSION_TEST_FRAMES] = {
+    sound_expression_compile("002373041050001000392300001023010802050005000000000000000000000000000000"),
+    sound_expression_compile("010230849100001000000100000000012800000100240000000000000000000000000000"),
+    sound_expression_compile("010232279000001440226608881023012800000000240000000000000000000000000000"),
+    sound_expression_compile("000000440000000440044008880000012800000000240000000000000000000000000000"),
+    sound_expression_compile("310232226070801440162408881023012800000100240000000000000000000000000000"),
+    sound_expression_compile("310231623093602440093908880000012800000100240000000000000000000000000000"),
+    sound_expression_compile("108000440050002000088000000200012801001000240000000000000000000000000000"),
+    sound_expression_compile("310230262040009000052300000000006402000500120000000000000000000000000000"),
+    sound_expression_compile("405121000030018000010000001023003203000200080000000000000000000000000000"),
+    sound_expression_compile("210000330020005000066000000512010000000000000000000000000000000000000000")
+};
+
+/**
+ * Checks that every compiled frame converts to exactly the SoundEffect, byte for byte, that the runtime
+ * SoundExpressions parser produces from the same string. Results are written to DMESG.
+ */
+void
+sound_expression_compiler_test()
+{
+    SoundEffect parsed, compiled;
+    int failures = 0;
+
+    DMESG("SOUND_EXPRESSION_COMPILER_TEST: STARTING...");
+
+    for (int i = 0; i < SOUND_EXPRESSION_TEST_FRAMES; i++)
+    {
+        memset(&parsed, 0, sizeof(SoundEffect));
+        uBit.audio.soundExpressions.parseSoundExpression(soundExpressionTestStrings[i], &parsed);
+        sound_expression_effect(soundExpressionTestFrames[i], &compiled);
+
+        uint8_t *p = (uint8_t *)&parsed;
+        uint8_t *c = (uint8_t *)&compiled;
+        int first = -1;
+
+        for (int b = 0; b < (int)sizeof(SoundEffect) && first < 0; b++)
+            if (p[b] != c[b])
+                first = b;
+
+        if (first >= 0)
+        {
+            failures++;
+            DMESG("   FRAME %d: DIFFERS FROM BYTE %d of %d", i, first, (int)sizeof(SoundEffect));
+        }
+    }
+
+    DMESG("   FRAMES: %d, DIFFERENT: %d", SOUND_EXPRESSION_TEST_FRAMES, failures);
+    DMESG("   RESULTS: %s", failures == 0 ? "PASS" : "FAIL");
+}
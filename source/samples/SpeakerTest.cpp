@@ -6,10 +6,15 @@
 #include "NRF52PWM.h"
 #include "StreamNormalizer.h"
 #include "SerialStreamer.h"
+#include "StreamFramer.h"
 #include "Synthesizer.h"
 #include "SoundEmojiSynthesizer.h"
 #include "SoundSynthesizerEffects.h"
 #include "Mixer2.h"
+#include "SimdMixer.h"
+#include "BufferPool.h"
+#include "WavetableTone.h"
+#include "PolyBlepTone.h"
 #include "SoundOutputPin.h"
 #include "Tests.h"
 
@@ -700,6 +705,102 @@ sound_emoji_test()
     DMESG("SOUND_EMOJI TEST: EXITING...");
 }
 
+void
+wavetable_tone_test()
+{
+    static uint16_t (*const tones[])(void *, int) = {
+        WavetableTone::SineTone, WavetableTone::TriangleTone, WavetableTone::SawtoothTone, WavetableTone::SquareWaveTone,
+        WavetableTone::OrganTone, WavetableTone::ReedTone, WavetableTone::PitchedNoiseTone
+    };
+
+    DMESG("WAVETABLE_TONE_TEST: STARTING...");
+
+    if (emojiSynth == NULL)
+        emojiSynth = new SoundEmojiSynthesizer(DEVICE_ID_SOUND_EMOJI_SYNTHESIZER_0);
+
+    if (speaker == NULL)
+        speaker = new NRF52PWM(NRF_PWM1, *emojiSynth, 44100);
+
+    emojiSynth->setSampleRange(speaker->getSampleRange());
+    emojiSynth->setOrMask(0x8000);
+
+    speaker->setDecoderMode(PWM_DECODER_LOAD_Common);
+    speaker->connectPin(uBit.io.P0, 0);
+
+    uBit.io.speaker.setHighDrive(true);
+
+    ManagedBuffer b(sizeof(SoundEffect));
+    SoundEffect *fx = (SoundEffect *)&b[0];
+
+    fx->duration = 1000;
+    fx->frequency = 261.63f;
+    fx->volume = 1.0f;
+
+    fx->effects[0].effect = SoundSynthesizerEffects::appregrioAscending;
+    fx->effects[0].parameter_p[0] = MusicalProgressions::pentatonic;
+    fx->effects[0].steps = 12;
+
+    // Play an arpeggio on each wavetable in turn.
+    for (int t = 0; ; t = (t + 1) % (sizeof(tones) / sizeof(tones[0])))
+    {
+        DMESG("WAVETABLE_TONE_TEST: TONE %d", t);
+        fx->tone.tonePrint = tones[t];
+        emojiSynth->play(b);
+        uBit.sleep(1500);
+    }
+}
+
+void
+polyblep_tone_test()
+{
+    static uint16_t (*const tones[][2])(void *, int) = {
+        {Synthesizer::SawtoothTone, PolyBlepTone::SawtoothTone},
+        {Synthesizer::SquareWaveTone, PolyBlepTone::SquareWaveTone}
+    };
+    static const int notes[] = {220, 440, 880, 1760, 3520};
+
+    DMESG("POLYBLEP_TONE_TEST: STARTING...");
+
+    if (synth == NULL)
+        synth = new Synthesizer();
+
+    // Run at 16kHz, where the naive waves alias most audibly.
+    synth->setSampleRate(16000);
+
+    if (normalizer == NULL)
+        normalizer = new StreamNormalizer(synth->output, 1.0f, false, DATASTREAM_FORMAT_16BIT_UNSIGNED);
+
+    if (speaker == NULL)
+        speaker = new NRF52PWM(NRF_PWM1, synth->output, synth->getSampleRate());
+
+    normalizer->setGain((float) speaker->getSampleRange() / 1023.0f);
+    normalizer->setOrMask(0x8000);
+
+    speaker->setDecoderMode(PWM_DECODER_LOAD_Common);
+    speaker->connectPin(uBit.io.speaker, 0);
+    speaker->connectPin(uBit.io.P0, 1);
+
+    uBit.io.speaker.setHighDrive(true);
+
+    // Play each note naive, then band limited, so the aliasing can be compared by ear.
+    while(1)
+    {
+        for (unsigned int t = 0; t < sizeof(tones) / sizeof(tones[0]); t++)
+        {
+            for (unsigned int n = 0; n < sizeof(notes) / sizeof(notes[0]); n++)
+            {
+                for (int blep = 0; blep < 2; blep++)
+                {
+                    DMESG("POLYBLEP_TONE_TEST: TONE %d NOTE %d %s", t, notes[n], blep ? "POLYBLEP" : "NAIVE");
+                    synth->setTone(tones[t][blep]);
+                    synth->setFrequency(notes[n], 500);
+                    uBit.sleep(700);
+                }
+            }
+        }
+    }
+}
+
 void
 mixer_test()
 {
@@ -830,6 +931,76 @@ mixer_test2()
     DMESG("MIXER_TEST: EXITING...");
 }
 
+#define SIMD_MIXER_TEST_VOICES 8
+
+void
+simd_mixer_test()
+{
+    static SoundEmojiSynthesizer *voices[SIMD_MIXER_TEST_VOICES];
+    static SimdMixer *simdMixer = NULL;
+    static BufferPool *pool = NULL;
+    static ManagedBuffer effects[SIMD_MIXER_TEST_VOICES];
+    static const float notes[SIMD_MIXER_TEST_VOICES] = {130.81f, 146.83f, 164.81f, 196.00f, 220.00f, 261.63f, 293.66f, 329.63f};
+
+    DMESG("SIMD_MIXER_TEST: STARTING...");
+
+    if (simdMixer == NULL)
+    {
+        // The mixer output comes from a pool, rather than the heap. Four buffers covers the one being mixed,
+        // the one the PWM is playing, and the one it has queued.
+        pool = new BufferPool();
+        pool->addClass(SIMD_MIXER_BUFFER_SAMPLES * sizeof(uint16_t), 4);
+        BufferPool::setDefault(pool);
+
+        simdMixer = new SimdMixer(44100);
+
+        for (int i = 0; i < SIMD_MIXER_TEST_VOICES; i++)
+        {
+            voices[i] = new SoundEmojiSynthesizer(DEVICE_ID_SOUND_EMOJI_SYNTHESIZER_0);
+            voices[i]->setSampleRange(1023);
+            simdMixer->addChannel(*voices[i], 1023, CONFIG_MIXER_INTERNAL_RANGE / SIMD_MIXER_TEST_VOICES);
+
+            // Each voice plays an arpeggio from a different note, alternately rising and falling.
+            effects[i] = ManagedBuffer(sizeof(SoundEffect));
+            SoundEffect *fx = (SoundEffect *)&effects[i][0];
+
+            fx->duration = 1000;
+            fx->tone.tonePrint = i & 1 ? Synthesizer::SawtoothTone : Synthesizer::SquareWaveTone;
+            fx->frequency = notes[i];
+            fx->volume = 1.0f;
+
+            fx->effects[0].effect = i & 1 ? SoundSynthesizerEffects::appregrioDescending : SoundSynthesizerEffects::appregrioAscending;
+            fx->effects[0].parameter_p[0] = MusicalProgressions::pentatonic;
+            fx->effects[0].steps = 12;
+        }
+    }
+
+    DMESG("SIMD_MIXER_TEST: %d VOICES INITIALISED... ", simdMixer->getChannelCount());
+
+    if (speaker == NULL)
+        speaker = new NRF52PWM(NRF_PWM1, *simdMixer, 44100);
+
+    simdMixer->setSampleRange(speaker->getSampleRange());
+    simdMixer->setOrMask(0x8000);
+
+    speaker->setDecoderMode(PWM_DECODER_LOAD_Common);
+    speaker->connectPin(uBit.io.P0, 0);
+
+    uBit.io.speaker.setHighDrive(true);
+
+    while(1)
+    {
+        DMESG("SIMD_MIXER_TEST: PLAY... ");
+
+        for (int i = 0; i < SIMD_MIXER_TEST_VOICES; i++)
+            voices[i]->play(effects[i]);
+
+        uBit.sleep(3000);
+
+        DMESG("SIMD_MIXER_TEST: POOL HITS %d MISSES %d HIGH WATER %d", (int)pool->getHitCount(), (int)pool->getMissCount(),
+            pool->getHighWater(SIMD_MIXER_BUFFER_SAMPLES * sizeof(uint16_t)));
+    }
+}
 
 void
 speaker_pin_test()
@@ -1083,6 +1254,28 @@ stream_mixer_to_serial()
     create_fiber(start_mixer_streaming);
 }
 
+static void
+start_mixer_streaming_framed()
+{
+    MicroBitAudio::requestActivation();
+
+    uBit.audio.setSpeakerEnabled(false);
+    uBit.io.P0.getDigitalValue();
+
+    uBit.audio.mixer.setOrMask(0);
+    uBit.audio.mixer.setFormat(DATASTREAM_FORMAT_8BIT_UNSIGNED);
+    uBit.audio.mixer.setSampleRange(255);
+
+    // Wrap each buffer in a StreamFramer header and CRC, so the host can detect gaps and corruption.
+    new SerialStreamer(*new StreamFramer(uBit.audio.mixer), SERIAL_STREAM_MODE_BINARY);
+}
+
+void
+stream_mixer_to_serial_framed()
+{
+    create_fiber(start_mixer_streaming_framed);
+}
+
 #ifdef CODE_TO_DERIVE_STEPSCOUNT_LIKE_JOSEPHINES_JS_SYNTH
 
 static const KeyValueTableEntry soundEmojiTonePrintData[] = {
@@ -0,0 +1,257 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "SpectrumAnalyser.h"
+#include "nrf.h"
+
+// Twiddle factors e^(-2*pi*i*k/N) for k < N/2, packed as (imaginary << 16) | real in Q15,
+// and the first half of a (symmetric) Hann window in Q15. Shared by all instances.
+static uint32_t spectrum_twiddle[SPECTRUM_FFT_SIZE / 2];
+static int16_t spectrum_window[SPECTRUM_FFT_SIZE / 2];
+static bool spectrum_tables_ready = false;
+
+/**
+ * Converts a raw sample into a signed Q14 value. Keeping one bit of headroom guarantees the magnitude
+ * of every complex value stays below full scale through the FFT, as each stage halves its output.
+ */
+static inline int spectrum_sample(int8_t s) { return s << 6; }
+static inline int spectrum_sample(uint8_t s) { return ((int)s - 128) << 6; }
+static inline int spectrum_sample(int16_t s) { return s >> 2; }
+static inline int spectrum_sample(uint16_t s) { return ((int)s - 32768) >> 2; }
+
+static inline uint32_t spectrum_pack(int re, int im)
+{
+    return ((uint32_t)im << 16) | (uint16_t)re;
+}
+
+/**
+ * In place, radix-2 decimation in time FFT over SPECTRUM_FFT_SIZE packed Q15 complex values.
+ * Each stage scales its output by 1/2, so the result is the DFT divided by SPECTRUM_FFT_SIZE.
+ */
+static void spectrum_fft(uint32_t *x)
+{
+    const int n = SPECTRUM_FFT_SIZE;
+    uint32_t a, b, w, t;
+    int32_t re, im;
+
+    // Bit reversal permutation.
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+
+        j ^= bit;
+
+        if (i < j)
+        {
+            t = x[i];
+            x[i] = x[j];
+            x[j] = t;
+        }
+    }
+
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        int half = len >> 1;
+        int step = n / len;
+
+        for (int k = 0; k < half; k++)
+        {
+            w = spectrum_twiddle[k * step];
+
+            for (int i = k; i < n; i += len)
+            {
+                a = x[i];
+                b = x[i + half];
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+                // Complex multiply b*w as two dual 16 bit MACs, then a halving butterfly.
+                re = __SMUSD(b, w) >> 15;
+                im = __SMUADX(b, w) >> 15;
+                t = __PKHBT(re, im, 16);
+
+                x[i] = __SHADD16(a, t);
+                x[i + half] = __SHSUB16(a, t);
+#else
+                int ar = (int16_t)a, ai = (int16_t)(a >> 16);
+                int br = (int16_t)b, bi = (int16_t)(b >> 16);
+                int wr = (int16_t)w, wi = (int16_t)(w >> 16);
+
+                re = (br * wr - bi * wi) >> 15;
+                im = (br * wi + bi * wr) >> 15;
+
+                x[i] = spectrum_pack((ar + re) >> 1, (ai + im) >> 1);
+                x[i + half] = spectrum_pack((ar - re) >> 1, (ai - im) >> 1);
+#endif
+            }
+        }
+    }
+}
+
+/**
+ * Creates a SpectrumAnalyser attached to the given source.
+ *
+ * @param source a DataSource to analyse.
+ * @param id the ID used to raise SPECTRUM_ANALYSER_EVT_UPDATED each time the band energies are updated.
+ */
+SpectrumAnalyser::SpectrumAnalyser(DataSource &source, uint16_t id) : upstream(source)
+{
+    this->id = id;
+    this->fill = 0;
+    this->frames = 0;
+
+    memset(bandEnergy, 0, sizeof(bandEnergy));
+
+    // Floating point is used only once, to build the tables.
+    if (!spectrum_tables_ready)
+    {
+        for (int k = 0; k < SPECTRUM_FFT_SIZE / 2; k++)
+        {
+            float phase = 2.0f * (float)M_PI * k / SPECTRUM_FFT_SIZE;
+            spectrum_twiddle[k] = spectrum_pack((int)(32767.0f * cosf(phase)), (int)(-32767.0f * sinf(phase)));
+            spectrum_window[k] = (int16_t)(32767.0f * 0.5f * (1.0f - cosf(2.0f * (float)M_PI * k / (SPECTRUM_FFT_SIZE - 1))));
+        }
+
+        spectrum_tables_ready = true;
+    }
+
+    // Register with our upstream component
+    source.connect(*this);
+}
+
+/**
+ * Callback provided when data is ready.
+ */
+int
+SpectrumAnalyser::pullRequest()
+{
+    ManagedBuffer buf = upstream.pull();
+
+    switch (upstream.getFormat())
+    {
+        case DATASTREAM_FORMAT_8BIT_SIGNED:
+            return analyseBuffer<int8_t>(buf);
+
+        case DATASTREAM_FORMAT_8BIT_UNSIGNED:
+            return analyseBuffer<uint8_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_SIGNED:
+            return analyseBuffer<int16_t>(buf);
+
+        case DATASTREAM_FORMAT_16BIT_UNSIGNED:
+            return analyseBuffer<uint16_t>(buf);
+    }
+
+    return DEVICE_NOT_SUPPORTED;
+}
+
+/**
+ * Appends the given samples to the frame, applying the analysis window, and analyses each frame as it fills.
+ */
+template <typename T> int
+SpectrumAnalyser::analyseBuffer(ManagedBuffer &buf)
+{
+    T *p = (T *)&buf[0];
+    T *end = p + buf.length() / sizeof(T);
+    int w;
+
+    while (p < end)
+    {
+        w = fill < SPECTRUM_FFT_SIZE / 2 ? spectrum_window[fill] : spectrum_window[SPECTRUM_FFT_SIZE - 1 - fill];
+        frame[fill++] = spectrum_pack((spectrum_sample(*p++) * w) >> 15, 0);
+
+        if (fill == SPECTRUM_FFT_SIZE)
+        {
+            analyseFrame();
+            fill = 0;
+        }
+    }
+
+    return DEVICE_OK;
+}
+
+/**
+ * Transforms the current frame in place, and updates the band energies.
+ */
+void
+SpectrumAnalyser::analyseFrame()
+{
+    uint64_t energy[SPECTRUM_BANDS] = {0};
+    int re, im, band;
+
+    spectrum_fft(frame);
+
+    // Accumulate the power in each bin of the positive half of the spectrum, excluding DC.
+    for (int k = 1; k < SPECTRUM_FFT_SIZE / 2; k++)
+    {
+        re = (int16_t)frame[k];
+        im = (int16_t)(frame[k] >> 16);
+        band = 31 - __CLZ(k);
+
+        energy[band] += re * re + im * im;
+    }
+
+    for (int b = 0; b < SPECTRUM_BANDS; b++)
+        bandEnergy[b] = energy[b] > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)energy[b];
+
+    frames++;
+
+    MicroBitEvent(id, SPECTRUM_ANALYSER_EVT_UPDATED);
+}
+
+/**
+ * Determines the energy in the given octave band, from the most recently analysed frame.
+ * @param band the band index, from 0 to SPECTRUM_BANDS-1.
+ * @return the band energy, in arbitrary linear units, or 0 if the band is invalid.
+ */
+uint32_t
+SpectrumAnalyser::getBandEnergy(int band)
+{
+    if (band < 0 || band >= SPECTRUM_BANDS)
+        return 0;
+
+    return bandEnergy[band];
+}
+
+/**
+ * Determines the lowest frequency covered by the given octave band, at the upstream sample rate.
+ * @param band the band index, from 0 to SPECTRUM_BANDS-1.
+ * @return the frequency in Hz.
+ */
+int
+SpectrumAnalyser::getBandFrequency(int band)
+{
+    return (int)((1 << band) * upstream.getSampleRate() / SPECTRUM_FFT_SIZE);
+}
+
+/**
+ * Determines the number of frames analysed since the component was created.
+ */
+uint32_t
+SpectrumAnalyser::getFrameCount()
+{
+    return frames;
+}
@@ -0,0 +1,101 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef SPECTRUM_ANALYSER_H
+#define SPECTRUM_ANALYSER_H
+
+// FFT length in samples (a power of two), and the number of octave bands reported.
+// Band b covers FFT bins [2^b, 2^(b+1)), so SPECTRUM_BANDS = log2(SPECTRUM_FFT_SIZE / 2).
+#define SPECTRUM_FFT_SIZE 256
+#define SPECTRUM_BANDS 7
+
+#define DEVICE_ID_SPECTRUM_ANALYSER 9010
+#define SPECTRUM_ANALYSER_EVT_UPDATED 1
+
+/**
+ * A DataSink that performs an in place, fixed point (Q15) FFT over each SPECTRUM_FFT_SIZE samples
+ * of its upstream, and publishes the energy in each octave band.
+ *
+ * All working storage is held in the component itself, so no heap is allocated per pull.
+ */
+class SpectrumAnalyser : public DataSink
+{
+    DataSource      &upstream;
+    uint16_t        id;
+    uint32_t        frame[SPECTRUM_FFT_SIZE];       // Complex samples, packed as (imaginary << 16) | real.
+    int             fill;
+    uint32_t        bandEnergy[SPECTRUM_BANDS];
+    uint32_t        frames;
+
+    /**
+     * Appends the given samples to the frame, applying the analysis window, and analyses each frame as it fills.
+     */
+    template <typename T> int analyseBuffer(ManagedBuffer &buf);
+
+    /**
+     * Transforms the current frame in place, and updates the band energies.
+     */
+    void analyseFrame();
+
+    public:
+    /**
+     * Creates a SpectrumAnalyser attached to the given source.
+     * Supports 8 and 16 bit, signed and unsigned, streams.
+     *
+     * @param source a DataSource to analyse.
+     * @param id the ID used to raise SPECTRUM_ANALYSER_EVT_UPDATED each time the band energies are updated.
+     */
+    SpectrumAnalyser(DataSource &source, uint16_t id = DEVICE_ID_SPECTRUM_ANALYSER);
+
+    /**
+     * Callback provided when data is ready.
+     * @return DEVICE_OK, or DEVICE_NOT_SUPPORTED if the upstream format cannot be analysed.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Determines the energy in the given octave band, from the most recently analysed frame.
+     * @param band the band index, from 0 to SPECTRUM_BANDS-1.
+     * @return the band energy, in arbitrary linear units, or 0 if the band is invalid.
+     */
+    uint32_t getBandEnergy(int band);
+
+    /**
+     * Determines the lowest frequency covered by the given octave band, at the upstream sample rate.
+     * @param band the band index, from 0 to SPECTRUM_BANDS-1.
+     * @return the frequency in Hz.
+     */
+    int getBandFrequency(int band);
+
+    /**
+     * Determines the number of frames analysed since the component was created.
+     */
+    uint32_t getFrameCount();
+};
+
+#endif
@@ -3,6 +3,12 @@
 #include "LevelDetector.h"
 #include "LevelDetectorSPL.h"
 #include "StreamRecording.h"
+#include "CompressedRecording.h"
+#include "FlashRecording.h"
+#include "FixedPointNormalizer.h"
+#include "LatencyTracer.h"
+#include "Mixer2.h"
+#include "NRF52PWM.h"
 #include "Tests.h"
 
 /**
@@ -53,9 +59,13 @@ void stream_test_all() {
 #endif
 
 void stream_test_record() {
+    static LatencyTracer tracer;
+
     uBit.audio.requestActivation();
     static SplitterChannel * input = uBit.audio.splitter->createChannel();
-    static StreamRecording * recording = new StreamRecording( *input );
+    // Measures how long each buffer waits between the splitter and the recording.
+    static LatencyProbe * inputProbe = new LatencyProbe( *input, tracer, "record", true );
+    static StreamRecording * recording = new StreamRecording( *inputProbe );
     static MixerChannel * output = uBit.audio.mixer.addChannel( *recording );
 
     uBit.audio.mic->setSampleRate( 11000 );
@@ -78,6 +88,8 @@ void stream_test_record() {
         uBit.sleep( 100 );
     }
     uBit.display.printChar( 'X' );
+    tracer.print();
+    tracer.reset();
 
     uBit.sleep( 1000 );
 
@@ -97,6 +109,140 @@ void stream_test_record() {
     recording->erase();
 }
 
+/**
+ * As stream_test_record, but recorded as IMA-ADPCM by a CompressedStreamRecording, so the same memory holds
+ * twice as much 8 bit audio.
+ */
+void stream_test_compressed_record() {
+    static LatencyTracer tracer;
+
+    uBit.audio.requestActivation();
+    static SplitterChannel * input = uBit.audio.splitter->createChannel();
+    // Measures how long each buffer waits between the splitter and the recording.
+    static LatencyProbe * inputProbe = new LatencyProbe( *input, tracer, "record", true );
+    static CompressedStreamRecording * recording = new CompressedStreamRecording( *inputProbe );
+    static MixerChannel * output = uBit.audio.mixer.addChannel( *recording );
+
+    uBit.audio.mic->setSampleRate( 11000 );
+    output->setSampleRate( 11000 );
+
+    output->setVolume( CONFIG_MIXER_INTERNAL_RANGE * 0.2 ); // 20% volume
+
+    uBit.display.printChar( '3', 1000 );
+    uBit.display.printChar( '2', 1000 );
+    uBit.display.printChar( '1', 1000 );
+
+    uBit.display.printChar( 'R' );
+    uBit.audio.mic->setSampleRate( 11000 );
+
+    recording->recordAsync();
+    while( recording->isRecording() ) {
+        uBit.display.printChar( '~' );
+        uBit.sleep( 100 );
+        uBit.display.printChar( '-' );
+        uBit.sleep( 100 );
+    }
+    uBit.display.printChar( 'X' );
+    tracer.print();
+    tracer.reset();
+
+    uBit.sleep( 1000 );
+
+    uBit.display.printChar( 'P' );
+    output->setSampleRate( 18000 );
+    recording->playAsync();
+    while( recording->isPlaying() ) {
+        uBit.display.printChar( '>' );
+        uBit.sleep( 100 );
+        uBit.display.printChar( ' ' );
+        uBit.sleep( 100 );
+    }
+    uBit.display.printChar( 'X' );
+
+    uBit.sleep( 1000 );
+
+    recording->erase();
+}
+
+/**
+ * Plays the microphone live through P0, with latency probes after the splitter, after a normalizer, and
+ * where the PWM takes each buffer from the mixer. The latency histograms are written to serial every few
+ * seconds. Hold A as they are written to clear them.
+ *
+ * The mixer and PWM are created here, rather than using uBit.audio.mixer, so a probe can sit between them.
+ */
+void stream_test_latency() {
+    static LatencyTracer tracer;
+
+    uBit.audio.requestActivation();
+    static SplitterChannel * input = uBit.audio.splitter->createChannel();
+    static LatencyProbe * micProbe = new LatencyProbe( *input, tracer, "splitter", true );
+    static FixedPointNormalizer * normalizer = new FixedPointNormalizer( *micProbe, 1.0f, true, DATASTREAM_FORMAT_16BIT_SIGNED );
+    static LatencyProbe * normalizerProbe = new LatencyProbe( normalizer->output, tracer, "normalizer" );
+    static Mixer2 * mixer = new Mixer2();
+    static MixerChannel * output = mixer->addChannel( *normalizerProbe );
+    static LatencyProbe * pwmProbe = new LatencyProbe( *mixer, tracer, "pwm" );
+    static NRF52PWM * pwm = new NRF52PWM( NRF_PWM2, *pwmProbe, 44100 );
+
+    mixer->setSampleRange( pwm->getSampleRange() );
+    mixer->setOrMask( 0x8000 );
+    pwm->setDecoderMode( PWM_DECODER_LOAD_Common );
+    pwm->connectPin( uBit.io.P0, 0 );
+
+    uBit.audio.mic->setSampleRate( 11000 );
+    output->setSampleRate( 11000 );
+    output->setVolume( CONFIG_MIXER_INTERNAL_RANGE * 0.2 ); // 20% volume
+
+    while( true ) {
+        uBit.sleep( 5000 );
+        tracer.print();
+
+        if( uBit.buttonA.isPressed() )
+            tracer.reset();
+    }
+}
+
+// The flash between the end of the program and this address is used for the recording,
+// staying clear of the pages at the top of flash used by MicroBitStorage and the bootloader.
+#define FLASH_RECORDING_TEST_END 0x70000
+
+extern uint32_t __etext, __data_start__, __data_end__;
+
+void stream_test_flash_record() {
+    // The program image ends with the initial values of .data, stored just after .text.
+    uint32_t start = (uint32_t)&__etext + ((uint32_t)&__data_end__ - (uint32_t)&__data_start__);
+    start = (start + FLASH_RECORDING_PAGE_SIZE - 1) & ~(FLASH_RECORDING_PAGE_SIZE - 1);
+    int pages = (FLASH_RECORDING_TEST_END - start) / FLASH_RECORDING_PAGE_SIZE;
+
+    uBit.audio.requestActivation();
+    uBit.audio.mic->setSampleRate( 8000 );
+
+    static SplitterChannel * input = uBit.audio.splitter->createChannel();
+    static FlashStreamRecording * recording = new FlashStreamRecording( *input, start, pages );
+    static MixerChannel * output = uBit.audio.mixer.addChannel( *recording, 8000 );
+
+    output->setVolume( CONFIG_MIXER_INTERNAL_RANGE * 0.2 ); // 20% volume
+
+    DMESG( "FLASH RECORDING: %d pages at 0x%x (%d seconds of ADPCM)", pages, start, pages * (FLASH_RECORDING_PAGE_SIZE - FLASH_RECORDING_HEADER_SIZE) * 2 / 8000 );
+
+    uBit.display.printChar( 'A' );
+    while( !uBit.buttonA.isPressed() )
+        uBit.sleep( 10 );
+
+    // Record for as long as button A is held, or until the flash region is full.
+    uBit.display.printChar( 'R' );
+    recording->recordAsync();
+    while( recording->isRecording() && uBit.buttonA.isPressed() )
+        uBit.sleep( 100 );
+    recording->stop();
+
+    DMESG( "FLASH RECORDING: %d samples, %d bytes dropped", (int)recording->getSampleCount(), (int)recording->getDroppedBytes() );
+
+    uBit.display.printChar( 'P' );
+    recording->play();
+    uBit.display.printChar( 'X' );
+}
+
 static const int STRSR_SAMPLE_RATE = 11000;
 
 static void strsr_handle_buttonA(MicroBitEvent) {
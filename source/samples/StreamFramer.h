@@ -0,0 +1,119 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+#include "DataStream.h"
+
+#ifndef STREAM_FRAMER_H
+#define STREAM_FRAMER_H
+
+#define STREAM_FRAME_SYNC 0x5AA5
+#define STREAM_FRAME_VERSION 1
+#define STREAM_FRAME_HEADER_SIZE 14
+#define STREAM_FRAME_CRC_SIZE 2
+
+/**
+ * Header placed in front of every buffer. All fields are little endian.
+ * The header is followed by the payload, then a CRC16 (CCITT, polynomial 0x1021, initial value 0xFFFF)
+ * computed over every byte from the version field to the end of the payload.
+ */
+struct StreamFrameHeader
+{
+    uint16_t        sync;               // STREAM_FRAME_SYNC (A5 5A on the wire)
+    uint8_t         version;            // STREAM_FRAME_VERSION
+    uint8_t         format;             // DATASTREAM_FORMAT_* of the payload.
+    uint16_t        sequence;           // Buffer sequence number, used to detect dropped buffers.
+    uint16_t        length;             // Payload length, in bytes.
+    uint16_t        sampleRate;         // Payload sample rate, in Hz.
+    uint32_t        timestamp;          // Time the buffer was framed, in microseconds since power on (low 32 bits).
+} __attribute__((packed));
+
+/**
+ * Computes (or continues) a CRC16-CCITT over the given data.
+ */
+uint16_t stream_frame_crc16(const uint8_t *data, int len, uint16_t crc = 0xFFFF);
+
+/**
+ * A stream stage that wraps each buffer from its upstream into a self describing frame, with a sync word,
+ * sequence number, format and sample rate header and a CRC16 trailer. Connect a binary serial streamer
+ * (SerialStreamer in SERIAL_STREAM_MODE_BINARY, or DmaSerialStreamer) downstream, and use
+ * utils/audio/serial_receiver.py on the host to measure throughput, gaps and latency.
+ */
+class StreamFramer : public DataSink, public DataSource
+{
+    DataSource      &upstream;
+    DataSink        *downstream;
+    uint16_t        sequence;
+
+    public:
+    /**
+     * Creates a StreamFramer attached to the given source.
+     * @param source the DataSource whose buffers are to be framed.
+     */
+    StreamFramer(DataSource &source);
+
+    /**
+     * Provide the next available ManagedBuffer to our downstream caller, as a frame.
+     */
+    virtual ManagedBuffer pull();
+
+    /**
+     * Callback provided when data is ready.
+     */
+    virtual int pullRequest();
+
+    /**
+     * Define a downstream component for data stream.
+     * @param sink The component that data will be delivered to, when it is available
+     */
+    virtual void connect(DataSink &sink);
+
+    /**
+     * Determines if this source is connected to a downstream component
+     */
+    virtual bool isConnected();
+
+    /**
+     * Disconnect this source from its downstream component
+     */
+    virtual void disconnect();
+
+    /**
+     * Determine the data format of the frames produced: always a byte stream.
+     */
+    virtual int getFormat();
+
+    /**
+     * Determines the sample rate of the upstream component.
+     */
+    virtual float getSampleRate();
+
+    /**
+     * Determines the sequence number that will be given to the next frame (the number of frames produced, modulo 2^16).
+     */
+    uint16_t getSequence();
+};
+
+#endif
@@ -17,7 +17,10 @@ void display_test2();
 void concurrent_display_test();
 void fade_test();
 void mems_mic_test();
+void mems_mic_fixed_point_test();
 void mems_mic_zero_offset_test();
+void mems_mic_adpcm_test();
+void mems_mic_agc_test();
 void speaker_test(int plays);
 void speaker_test2(int plays);
 void gpio_test();
@@ -82,12 +85,18 @@ void sound_emoji_streamer();
 void flash_storage_test();
 void sound_expression_test();
 void audio_sound_expression_test();
+void audio_compiled_expression_test();
+void sound_expression_compiler_test();
 void audio_virtual_pin_melody();
+void wavetable_tone_test();
+void polyblep_tone_test();
 void mixer_test();
 void mixer_test2();
+void simd_mixer_test();
 void speaker_pin_test();
 void say_hello();
 void stream_mixer_to_serial();
+void stream_mixer_to_serial_framed();
 void level_meter();
 void init_clap_detect();
 void ble_test();
@@ -96,8 +105,34 @@ void neopixel_test();
 void stream_test_mic_activate();
 void stream_test_getValue_interval();
 void stream_test_record();
+void stream_test_compressed_record();
+void stream_test_latency();
+void stream_test_flash_record();
 void stream_test_recording_sample_rates();
 void stream_test_all();
 void streamer_serial_test();
+void streamer_serial_shared_test();
+void streamer_serial_dma_test();
+void streamer_serial_framed_test();
+void noise_profiler_benchmark();
+void noise_profiler_continuous_test();
+void fixed_point_normalizer_benchmark();
+void fixed_point_normalizer_test();
+void simd_mixer_benchmark();
+void simd_mixer_16bit_test();
+void mixer2_scaling_benchmark();
+void wavetable_tone_benchmark();
+void polyblep_tone_benchmark();
+void buffer_pool_benchmark();
+void spectrum_analyser_test();
+void activity_gate_test();
+void biquad_filter_test();
+void sample_rate_converter_benchmark();
+void sample_rate_converter_test();
+void onset_detector_benchmark();
+void onset_detector_recording_benchmark();
+void rms_level_detector_event_test();
+void output_prefetcher_test();
+void biquad_filter_benchmark();
 
 #endif
@@ -0,0 +1,222 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "WavetableTone.h"
+
+// Generated by utils/audio/wavetable_gen.py. Each table has a copy of its first sample at the end,
+// so interpolation never needs to wrap.
+
+// A pure sine.
+static const uint16_t wavetable_sine[WAVETABLE_SIZE + 1] = {
+    512, 524, 537, 549, 562, 574, 587, 599, 611, 624, 636, 648, 660, 672, 684, 696,
+    707, 719, 730, 741, 753, 764, 774, 785, 796, 806, 816, 826, 836, 846, 855, 864,
+    873, 882, 890, 899, 907, 915, 922, 930, 937, 944, 950, 957, 963, 968, 974, 979,
+    984, 989, 993, 997, 1001, 1004, 1008, 1011, 1013, 1015, 1017, 1019, 1021, 1022, 1022, 1023,
+    1023, 1023, 1022, 1022, 1021, 1019, 1017, 1015, 1013, 1011, 1008, 1004, 1001, 997, 993, 989,
+    984, 979, 974, 968, 963, 957, 950, 944, 937, 930, 922, 915, 907, 899, 890, 882,
+    873, 864, 855, 846, 836, 826, 816, 806, 796, 785, 774, 764, 753, 741, 730, 719,
+    707, 696, 684, 672, 660, 648, 636, 624, 611, 599, 587, 574, 562, 549, 537, 524,
+    512, 499, 486, 474, 461, 449, 436, 424, 412, 399, 387, 375, 363, 351, 339, 327,
+    316, 304, 293, 282, 270, 259, 249, 238, 227, 217, 207, 197, 187, 177, 168, 159,
+    150, 141, 133, 124, 116, 108, 101, 93, 86, 79, 73, 66, 60, 55, 49, 44,
+    39, 34, 30, 26, 22, 19, 15, 12, 10, 8, 6, 4, 2, 1, 1, 0,
+    0, 0, 1, 1, 2, 4, 6, 8, 10, 12, 15, 19, 22, 26, 30, 34,
+    39, 44, 49, 55, 60, 66, 73, 79, 86, 93, 101, 108, 116, 124, 133, 141,
+    150, 159, 168, 177, 187, 197, 207, 217, 227, 238, 249, 259, 270, 282, 293, 304,
+    316, 327, 339, 351, 363, 375, 387, 399, 412, 424, 436, 449, 461, 474, 486, 499,
+    512,
+};
+
+// A triangle, rising from the midpoint.
+static const uint16_t wavetable_triangle[WAVETABLE_SIZE + 1] = {
+    512, 519, 527, 535, 543, 551, 559, 567, 575, 583, 591, 599, 607, 615, 623, 631,
+    639, 647, 655, 663, 671, 679, 687, 695, 703, 711, 719, 727, 735, 743, 751, 759,
+    767, 775, 783, 791, 799, 807, 815, 823, 831, 839, 847, 855, 863, 871, 879, 887,
+    895, 903, 911, 919, 927, 935, 943, 951, 959, 967, 975, 983, 991, 999, 1007, 1015,
+    1023, 1015, 1007, 999, 991, 983, 975, 967, 959, 951, 943, 935, 927, 919, 911, 903,
+    895, 887, 879, 871, 863, 855, 847, 839, 831, 823, 815, 807, 799, 791, 783, 775,
+    767, 759, 751, 743, 735, 727, 719, 711, 703, 695, 687, 679, 671, 663, 655, 647,
+    639, 631, 623, 615, 607, 599, 591, 583, 575, 567, 559, 551, 543, 535, 527, 519,
+    512, 504, 496, 488, 480, 472, 464, 456, 448, 440, 432, 424, 416, 408, 400, 392,
+    384, 376, 368, 360, 352, 344, 336, 328, 320, 312, 304, 296, 288, 280, 272, 264,
+    256, 248, 240, 232, 224, 216, 208, 200, 192, 184, 176, 168, 160, 152, 144, 136,
+    128, 120, 112, 104, 96, 88, 80, 72, 64, 56, 48, 40, 32, 24, 16, 8,
+    0, 8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120,
+    128, 136, 144, 152, 160, 168, 176, 184, 192, 200, 208, 216, 224, 232, 240, 248,
+    256, 264, 272, 280, 288, 296, 304, 312, 320, 328, 336, 344, 352, 360, 368, 376,
+    384, 392, 400, 408, 416, 424, 432, 440, 448, 456, 464, 472, 480, 488, 496, 504,
+    512,
+};
+
+// A rising sawtooth.
+static const uint16_t wavetable_sawtooth[WAVETABLE_SIZE + 1] = {
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60,
+    64, 68, 72, 76, 80, 84, 88, 92, 96, 100, 104, 108, 112, 116, 120, 124,
+    128, 132, 136, 140, 144, 148, 152, 156, 160, 164, 168, 172, 176, 180, 184, 188,
+    192, 196, 200, 204, 208, 212, 216, 220, 224, 228, 232, 236, 240, 244, 248, 252,
+    256, 260, 264, 268, 272, 276, 280, 284, 288, 292, 296, 300, 304, 308, 312, 316,
+    320, 324, 328, 332, 336, 340, 344, 348, 352, 356, 360, 364, 368, 372, 376, 380,
+    384, 388, 392, 396, 400, 404, 408, 412, 416, 420, 424, 428, 432, 436, 440, 444,
+    448, 452, 456, 460, 464, 468, 472, 476, 480, 484, 488, 492, 496, 500, 504, 508,
+    512, 515, 519, 523, 527, 531, 535, 539, 543, 547, 551, 555, 559, 563, 567, 571,
+    575, 579, 583, 587, 591, 595, 599, 603, 607, 611, 615, 619, 623, 627, 631, 635,
+    639, 643, 647, 651, 655, 659, 663, 667, 671, 675, 679, 683, 687, 691, 695, 699,
+    703, 707, 711, 715, 719, 723, 727, 731, 735, 739, 743, 747, 751, 755, 759, 763,
+    767, 771, 775, 779, 783, 787, 791, 795, 799, 803, 807, 811, 815, 819, 823, 827,
+    831, 835, 839, 843, 847, 851, 855, 859, 863, 867, 871, 875, 879, 883, 887, 891,
+    895, 899, 903, 907, 911, 915, 919, 923, 927, 931, 935, 939, 943, 947, 951, 955,
+    959, 963, 967, 971, 975, 979, 983, 987, 991, 995, 999, 1003, 1007, 1011, 1015, 1019,
+    0,
+};
+
+// A square, high for the first half cycle.
+static const uint16_t wavetable_square[WAVETABLE_SIZE + 1] = {
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023, 1023,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1023,
+};
+
+// Drawbar organ: the fundamental with its octave, twelfth, fifteenth and twenty-second.
+static const uint16_t wavetable_organ[WAVETABLE_SIZE + 1] = {
+    512, 554, 597, 638, 678, 716, 752, 786, 817, 844, 869, 891, 910, 926, 940, 951,
+    960, 968, 974, 979, 983, 987, 990, 993, 996, 1000, 1003, 1007, 1010, 1014, 1017, 1020,
+    1022, 1023, 1023, 1021, 1018, 1013, 1007, 998, 987, 975, 961, 945, 928, 911, 892, 874,
+    855, 837, 820, 805, 791, 779, 769, 761, 756, 753, 753, 755, 758, 764, 771, 779,
+    788, 797, 806, 815, 822, 829, 833, 836, 837, 836, 833, 828, 821, 813, 802, 791,
+    779, 766, 753, 740, 727, 715, 704, 694, 685, 677, 671, 666, 662, 659, 657, 655,
+    653, 651, 649, 647, 643, 639, 633, 626, 617, 608, 596, 584, 571, 557, 543, 529,
+    515, 502, 490, 479, 470, 462, 457, 454, 453, 454, 458, 463, 471, 479, 489, 500,
+    511, 523, 534, 544, 552, 560, 565, 569, 570, 569, 566, 561, 553, 544, 533, 521,
+    508, 494, 480, 466, 452, 439, 427, 415, 406, 397, 390, 384, 380, 376, 374, 372,
+    370, 368, 366, 364, 361, 357, 352, 346, 338, 329, 319, 308, 296, 283, 270, 257,
+    244, 232, 221, 210, 202, 195, 190, 187, 186, 187, 190, 194, 201, 208, 217, 226,
+    235, 244, 252, 259, 265, 268, 270, 270, 267, 262, 254, 244, 232, 218, 203, 186,
+    168, 149, 131, 112, 95, 78, 62, 48, 36, 25, 16, 10, 5, 2, 0, 0,
+    1, 3, 6, 9, 13, 16, 20, 23, 27, 30, 33, 36, 40, 44, 49, 55,
+    63, 72, 83, 97, 113, 132, 154, 179, 206, 237, 271, 307, 345, 385, 426, 469,
+    512,
+};
+
+// Reed: odd harmonics up to the fifteenth, falling at 1/n^1.5.
+static const uint16_t wavetable_reed[WAVETABLE_SIZE + 1] = {
+    512, 563, 613, 659, 701, 737, 767, 790, 808, 821, 831, 837, 842, 846, 851, 857,
+    864, 873, 882, 893, 903, 913, 923, 931, 937, 942, 945, 948, 950, 952, 954, 956,
+    960, 964, 969, 974, 979, 985, 990, 994, 997, 999, 1000, 1001, 1001, 1001, 1001, 1002,
+    1003, 1005, 1008, 1011, 1014, 1017, 1019, 1021, 1023, 1023, 1023, 1022, 1020, 1019, 1018, 1017,
+    1017, 1017, 1018, 1019, 1020, 1022, 1023, 1023, 1023, 1021, 1019, 1017, 1014, 1011, 1008, 1005,
+    1003, 1002, 1001, 1001, 1001, 1001, 1000, 999, 997, 994, 990, 985, 979, 974, 969, 964,
+    960, 956, 954, 952, 950, 948, 945, 942, 937, 931, 923, 913, 903, 893, 882, 873,
+    864, 857, 851, 846, 842, 837, 831, 821, 808, 790, 767, 737, 701, 659, 613, 563,
+    512, 460, 410, 364, 322, 286, 256, 233, 215, 202, 192, 186, 181, 177, 172, 166,
+    159, 150, 141, 130, 120, 110, 100, 92, 86, 81, 78, 75, 73, 71, 69, 67,
+    63, 59, 54, 49, 44, 38, 33, 29, 26, 24, 23, 22, 22, 22, 22, 21,
+    20, 18, 15, 12, 9, 6, 4, 2, 0, 0, 0, 1, 3, 4, 5, 6,
+    6, 6, 5, 4, 3, 1, 0, 0, 0, 2, 4, 6, 9, 12, 15, 18,
+    20, 21, 22, 22, 22, 22, 23, 24, 26, 29, 33, 38, 44, 49, 54, 59,
+    63, 67, 69, 71, 73, 75, 78, 81, 86, 92, 100, 110, 120, 130, 141, 150,
+    159, 166, 172, 177, 181, 186, 192, 202, 215, 233, 256, 286, 322, 364, 410, 460,
+    512,
+};
+
+// One cycle of noise, repeated at the frequency of the tone, so it sounds as a pitched buzz.
+static const uint16_t wavetable_pitched_noise[WAVETABLE_SIZE + 1] = {
+    241, 377, 516, 722, 50, 378, 793, 569, 15, 654, 255, 432, 605, 857, 240, 1005,
+    882, 334, 699, 544, 220, 106, 71, 326, 132, 724, 597, 388, 268, 769, 953, 180,
+    341, 1007, 397, 561, 477, 1019, 896, 728, 981, 999, 157, 380, 703, 166, 503, 177,
+    606, 893, 338, 18, 974, 235, 852, 25, 392, 46, 353, 133, 829, 417, 150, 625,
+    813, 956, 10, 30, 1022, 823, 466, 400, 688, 989, 751, 500, 425, 148, 924, 765,
+    651, 592, 552, 52, 431, 576, 970, 344, 796, 280, 933, 964, 442, 441, 361, 20,
+    678, 767, 452, 511, 861, 288, 0, 359, 677, 81, 301, 219, 249, 791, 513, 630,
+    591, 1007, 490, 304, 1011, 737, 642, 461, 615, 120, 962, 844, 8, 197, 575, 17,
+    575, 486, 464, 452, 18, 697, 976, 754, 518, 828, 357, 652, 990, 304, 799, 598,
+    593, 142, 25, 577, 856, 82, 40, 983, 230, 330, 299, 446, 768, 338, 245, 103,
+    712, 689, 535, 498, 395, 12, 718, 84, 887, 665, 627, 492, 720, 246, 698, 359,
+    391, 630, 775, 817, 1009, 819, 311, 865, 100, 664, 38, 73, 193, 763, 314, 682,
+    862, 427, 850, 411, 636, 63, 607, 325, 489, 124, 0, 114, 927, 396, 615, 514,
+    312, 508, 976, 90, 283, 805, 503, 489, 765, 892, 455, 685, 195, 619, 138, 1017,
+    367, 308, 260, 97, 238, 383, 948, 778, 159, 778, 652, 551, 356, 806, 397, 527,
+    251, 389, 612, 684, 394, 739, 641, 638, 792, 799, 1008, 825, 971, 351, 564, 259,
+    241,
+};
+
+/**
+ * Reads the given table at a tone print position, interpolating linearly between adjacent samples.
+ */
+static inline uint16_t wavetable_read(const uint16_t *table, int position)
+{
+    int i = (position >> WAVETABLE_FRACTION_BITS) & (WAVETABLE_SIZE - 1);
+    int f = position & ((1 << WAVETABLE_FRACTION_BITS) - 1);
+    int a = table[i];
+
+    return (uint16_t)(a + (((table[i + 1] - a) * f) >> WAVETABLE_FRACTION_BITS));
+}
+
+uint16_t WavetableTone::SineTone(void *, int position)
+{
+    return wavetable_read(wavetable_sine, position);
+}
+
+uint16_t WavetableTone::TriangleTone(void *, int position)
+{
+    return wavetable_read(wavetable_triangle, position);
+}
+
+uint16_t WavetableTone::SawtoothTone(void *, int position)
+{
+    return wavetable_read(wavetable_sawtooth, position);
+}
+
+uint16_t WavetableTone::SquareWaveTone(void *, int position)
+{
+    return wavetable_read(wavetable_square, position);
+}
+
+uint16_t WavetableTone::OrganTone(void *, int position)
+{
+    return wavetable_read(wavetable_organ, position);
+}
+
+uint16_t WavetableTone::ReedTone(void *, int position)
+{
+    return wavetable_read(wavetable_reed, position);
+}
+
+uint16_t WavetableTone::PitchedNoiseTone(void *, int position)
+{
+    return wavetable_read(wavetable_pitched_noise, position);
+}
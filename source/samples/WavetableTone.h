@@ -0,0 +1,60 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Lancaster University.
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+*/
+
+#include "MicroBit.h"
+#include "CodalConfig.h"
+
+#ifndef WAVETABLE_TONE_H
+#define WAVETABLE_TONE_H
+
+// Tone prints are given a position from 0 to 2^WAVETABLE_POSITION_BITS - 1 through each cycle. Tables hold
+// 2^WAVETABLE_SIZE_BITS samples, and the remaining low bits of the position interpolate between them.
+#define WAVETABLE_POSITION_BITS     10
+#define WAVETABLE_SIZE_BITS         8
+#define WAVETABLE_SIZE              (1 << WAVETABLE_SIZE_BITS)
+#define WAVETABLE_FRACTION_BITS     (WAVETABLE_POSITION_BITS - WAVETABLE_SIZE_BITS)
+
+/**
+ * Tone prints for Synthesizer and SoundEmojiSynthesizer that read one cycle of a waveform from a
+ * precomputed table in flash, with linear interpolation, so each sample costs a pair of table reads and
+ * a multiply whatever the waveform. They can be used anywhere a Synthesizer tone print is accepted.
+ *
+ * The tables are generated by utils/audio/wavetable_gen.py. Every tone print returns a value from 0 to 1023.
+ *
+ * PitchedNoiseTone repeats a single cycle of noise, so it is heard as a buzz at the frequency of the tone.
+ * It is not a substitute for Synthesizer::NoiseTone, which produces unpitched noise.
+ */
+class WavetableTone
+{
+    public:
+    static uint16_t SineTone(void *arg, int position);
+    static uint16_t TriangleTone(void *arg, int position);
+    static uint16_t SawtoothTone(void *arg, int position);
+    static uint16_t SquareWaveTone(void *arg, int position);
+    static uint16_t OrganTone(void *arg, int position);
+    static uint16_t ReedTone(void *arg, int position);
+    static uint16_t PitchedNoiseTone(void *arg, int position);
+};
+
+#endif
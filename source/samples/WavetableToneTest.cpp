@@ -0,0 +1,58 @@
+#include "MicroBit.h"
+#include "Synthesizer.h"
+#include "WavetableTone.h"
+#include "CycleCounter.h"
+#include "Tests.h"
+
+#define WAVETABLE_BENCHMARK_SAMPLES     4096
+
+typedef uint16_t (*WavetableBenchmarkTone)(void *arg, int position);
+
+/**
+ * Measures the mean cost of a tone print, called through a pointer as the synthesizers do, in hundredths of a cycle per sample.
+ */
+static int
+wavetable_benchmark_cost(WavetableBenchmarkTone tone)
+{
+    volatile uint32_t sum = 0;
+
+    uint32_t start = cycle_counter_read();
+    for (int i = 0; i < WAVETABLE_BENCHMARK_SAMPLES; i++)
+        sum += tone(NULL, (i * 37) & 1023);
+
+    return (int)((uint64_t)(cycle_counter_read() - start) * 100 / WAVETABLE_BENCHMARK_SAMPLES);
+}
+
+/**
+ * Compares the cost per sample of the Synthesizer tone prints against their wavetable equivalents, and
+ * reports how many voices of each the CPU could generate at 44.1kHz. Tables with no Synthesizer
+ * equivalent are measured alone. Results are written to DMESG.
+ */
+void
+wavetable_tone_benchmark()
+{
+    static const WavetableBenchmarkTone tones[][2] = {
+        {Synthesizer::SineTone, WavetableTone::SineTone},
+        {Synthesizer::TriangleTone, WavetableTone::TriangleTone},
+        {Synthesizer::SawtoothTone, WavetableTone::SawtoothTone},
+        {Synthesizer::SquareWaveTone, WavetableTone::SquareWaveTone},
+        {NULL, WavetableTone::OrganTone},
+        {NULL, WavetableTone::ReedTone},
+        {NULL, WavetableTone::PitchedNoiseTone},
+    };
+    static const char *names[] = {"SINE", "TRIANGLE", "SAWTOOTH", "SQUARE", "ORGAN", "REED", "PITCHED NOISE"};
+
+    cycle_counter_enable();
+
+    DMESG("WAVETABLE_TONE_BENCHMARK: %d samples (cycles/sample x 100, voices at 44.1kHz)", WAVETABLE_BENCHMARK_SAMPLES);
+
+    for (unsigned int t = 0; t < sizeof(names) / sizeof(names[0]); t++)
+    {
+        int synthesizer = tones[t][0] ? wavetable_benchmark_cost(tones[t][0]) : 0;
+        int wavetable = wavetable_benchmark_cost(tones[t][1]);
+
+        DMESG("   %s: SYNTHESIZER %d (%d voices) WAVETABLE %d (%d voices)", names[t],
+            synthesizer, synthesizer ? (int)((uint64_t)SystemCoreClock * 100 / 44100 / synthesizer) : 0,
+            wavetable, (int)((uint64_t)SystemCoreClock * 100 / 44100 / max(wavetable, 1)));
+    }
+}
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Lancaster University.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Decodes the IMA-ADPCM stream produced by AdpcmSerialStreamer into a WAV file.
+
+   USAGE: adpcm_decode.py [--port /dev/ttyACM0 [--baud 115200] [--seconds 10] | --input capture.bin] output.wav
+"""
+
+import argparse
+import struct
+import sys
+import wave
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+]
+
+INDEX_TABLE = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+SYNC = b"AD"
+HEADER = struct.Struct("<2shBBHH")
+MAX_BLOCK_SAMPLES = 256
+
+
+def decode_block(predictor, index, codes, samples):
+    """Decodes a block of 4 bit codes (low nibble first), returning a list of 16 bit samples."""
+    out = []
+    for i in range(samples):
+        code = (codes[i >> 1] >> (4 * (i & 1))) & 0x0F
+        step = STEP_TABLE[index]
+        delta = step >> 3
+        if code & 4:
+            delta += step
+        if code & 2:
+            delta += step >> 1
+        if code & 1:
+            delta += step >> 2
+        predictor += -delta if code & 8 else delta
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + INDEX_TABLE[code]))
+        out.append(predictor)
+    return out
+
+
+def parse_stream(data):
+    """Yields (sequence, sample_rate, samples) for each valid block found in data."""
+    pos = 0
+    while True:
+        pos = data.find(SYNC, pos)
+        if pos < 0 or pos + HEADER.size > len(data):
+            return
+        _, predictor, index, sequence, samples, rate = HEADER.unpack_from(data, pos)
+        size = HEADER.size + (samples + 1) // 2
+        if index > 88 or samples == 0 or samples > MAX_BLOCK_SAMPLES:
+            pos += 1
+            continue
+        if pos + size > len(data):
+            return
+        codes = data[pos + HEADER.size:pos + size]
+        yield sequence, rate, decode_block(predictor, index, codes, samples)
+        pos += size
+
+
+def capture(port, baud, seconds):
+    import serial
+    import time
+    data = bytearray()
+    with serial.Serial(port, baud, timeout=0.1) as s:
+        end = time.time() + seconds
+        while time.time() < end:
+            data += s.read(4096)
+    return bytes(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode an AdpcmSerialStreamer capture into a WAV file.")
+    parser.add_argument("--port", help="serial port to capture from (requires pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--seconds", type=float, default=10.0, help="capture duration when reading from --port")
+    parser.add_argument("--input", help="previously captured raw serial data")
+    parser.add_argument("output", help="WAV file to write")
+    args = parser.parse_args()
+
+    if args.port:
+        data = capture(args.port, args.baud, args.seconds)
+    elif args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("one of --port or --input is required")
+
+    pcm = []
+    rate = 0
+    blocks = 0
+    dropped = 0
+    last = None
+    for sequence, block_rate, samples in parse_stream(data):
+        if last is not None:
+            dropped += (sequence - last - 1) & 0xFF
+        last = sequence
+        rate = rate or block_rate
+        blocks += 1
+        pcm.extend(samples)
+
+    if not blocks:
+        print("No ADPCM blocks found", file=sys.stderr)
+        return 1
+
+    with wave.open(args.output, "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        w.writeframes(struct.pack("<%dh" % len(pcm), *pcm))
+
+    print("%d blocks, %d samples at %d Hz, %d blocks dropped" % (blocks, len(pcm), rate, dropped))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Lancaster University.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Converts a labelled PCM capture into source/samples/OnsetReplayRecording.h, for onset_detector_recording_benchmark.
+
+   The PCM is the raw payload written by serial_receiver.py --output, which also reports the format and
+   sample rate to pass here. The labels file lists the start of each clap, in milliseconds from the start
+   of the capture, one per line. Blank lines and anything after a # are ignored.
+
+   The recording is compiled into flash, so keep it short: 12 seconds of 8 bit audio at 11kHz is 132KB.
+   Build with "ONSET_REPLAY_RECORDING": 1 in the config section of codal.json to include it.
+
+   USAGE: onset_replay_gen.py --format 2 --rate 11000 payload.raw labels.txt > source/samples/OnsetReplayRecording.h
+"""
+
+import argparse
+import sys
+
+FORMATS = {
+    1: ("DATASTREAM_FORMAT_8BIT_UNSIGNED", 1),
+    2: ("DATASTREAM_FORMAT_8BIT_SIGNED", 1),
+    3: ("DATASTREAM_FORMAT_16BIT_UNSIGNED", 2),
+    4: ("DATASTREAM_FORMAT_16BIT_SIGNED", 2),
+}
+
+
+def read_labels(path):
+    """Reads the clap start times, in milliseconds."""
+    labels = []
+    with open(path) as f:
+        for line in f:
+            line = line.split("#")[0].strip()
+            if line:
+                labels.append(int(round(float(line))))
+    return sorted(labels)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate an onset detector replay recording from a labelled PCM capture.")
+    parser.add_argument("--format", type=int, required=True, choices=sorted(FORMATS),
+                        help="DataStream format of the capture, as reported by serial_receiver.py")
+    parser.add_argument("--rate", type=int, required=True, help="sample rate of the capture, in Hz")
+    parser.add_argument("pcm", help="raw PCM payload")
+    parser.add_argument("labels", help="clap start times, in milliseconds")
+    args = parser.parse_args()
+
+    name, width = FORMATS[args.format]
+
+    with open(args.pcm, "rb") as f:
+        pcm = f.read()
+    pcm = pcm[:len(pcm) - len(pcm) % width]
+    labels = read_labels(args.labels)
+
+    print("// Generated by utils/audio/onset_replay_gen.py from %s and %s." % (args.pcm, args.labels))
+    print("#define ONSET_RECORDING_FORMAT          %s" % name)
+    print("#define ONSET_RECORDING_SAMPLE_RATE     %d" % args.rate)
+    print("#define ONSET_RECORDING_SAMPLES         %d" % (len(pcm) // width))
+    print("#define ONSET_RECORDING_CLAPS           %d" % len(labels))
+    print()
+    print("static const uint8_t onset_recording_pcm[] = {")
+    for i in range(0, len(pcm), 16):
+        print("    " + ", ".join("%d" % b for b in pcm[i:i + 16]) + ",")
+    print("};")
+    print()
+    print("// Clap start times, in milliseconds.")
+    print("static const int onset_recording_claps[ONSET_RECORDING_CLAPS + 1] = {")
+    for i in range(0, len(labels), 8):
+        print("    " + ", ".join("%d" % l for l in labels[i:i + 8]) + ",")
+    print("    -1,")
+    print("};")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
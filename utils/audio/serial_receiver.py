@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Lancaster University.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Receives the framed stream produced by StreamFramer, and reports throughput, gaps and latency.
+
+   USAGE: serial_receiver.py --port /dev/ttyACM0 [--baud 115200] [--seconds 10] [--output payload.raw]
+          serial_receiver.py --input capture.bin
+
+   Latency is reported relative to the fastest frame seen, as the device and host clocks are not
+   synchronised: it measures the queueing and transport delay added on top of the best case.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+SYNC = b"\xa5\x5a"
+HEADER = struct.Struct("<2sBBHHHI")
+VERSION = 1
+MAX_PAYLOAD = 8192
+
+FORMAT_BYTES = {1: 1, 2: 1, 3: 2, 4: 2, 5: 3, 6: 3, 7: 4, 8: 4}
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        crc &= 0xFFFF
+    return crc
+
+
+class Receiver:
+    def __init__(self):
+        self.buffer = bytearray()
+        self.frames = 0
+        self.payload_bytes = 0
+        self.samples = 0
+        self.gaps = 0
+        self.lost = 0
+        self.crc_errors = 0
+        self.skipped = 0
+        self.last_sequence = None
+        self.min_offset = None
+        self.latencies = []
+        self.device_wraps = 0
+        self.last_timestamp = None
+        self.format = None
+        self.sample_rate = None
+        self.output = None
+
+    def feed(self, data, now):
+        """Adds received bytes, and processes every complete frame found. now is the host time in seconds."""
+        self.buffer += data
+        while True:
+            pos = self.buffer.find(SYNC)
+            if pos < 0:
+                # Keep a trailing byte in case it is the first half of a sync word.
+                self.skipped += max(0, len(self.buffer) - 1)
+                del self.buffer[:-1]
+                return
+            if pos:
+                self.skipped += pos
+                del self.buffer[:pos]
+            if len(self.buffer) < HEADER.size:
+                return
+            _, version, fmt, sequence, length, rate, timestamp = HEADER.unpack_from(self.buffer)
+            if version != VERSION or length > MAX_PAYLOAD:
+                self.skipped += 1
+                del self.buffer[:1]
+                continue
+            size = HEADER.size + length + 2
+            if len(self.buffer) < size:
+                return
+            crc = self.buffer[size - 2] | (self.buffer[size - 1] << 8)
+            if crc16(self.buffer[2:size - 2]) != crc:
+                self.crc_errors += 1
+                self.skipped += 1
+                del self.buffer[:1]
+                continue
+            self.frame(fmt, sequence, rate, timestamp, bytes(self.buffer[HEADER.size:size - 2]), now)
+            del self.buffer[:size]
+
+    def frame(self, fmt, sequence, rate, timestamp, payload, now):
+        if self.last_sequence is not None:
+            missing = (sequence - self.last_sequence - 1) & 0xFFFF
+            if missing:
+                self.gaps += 1
+                self.lost += missing
+        self.last_sequence = sequence
+
+        # Unwrap the 32 bit device timestamp.
+        if self.last_timestamp is not None and timestamp < self.last_timestamp:
+            self.device_wraps += 1
+        self.last_timestamp = timestamp
+        device = (self.device_wraps << 32) + timestamp
+
+        offset = now * 1e6 - device
+        if self.min_offset is None or offset < self.min_offset:
+            self.min_offset = offset
+        self.latencies.append(offset)
+
+        self.frames += 1
+        self.payload_bytes += len(payload)
+        self.samples += len(payload) // FORMAT_BYTES.get(fmt, 1)
+        self.format = fmt
+        self.sample_rate = rate
+
+        if self.output:
+            self.output.write(payload)
+
+    def report(self, elapsed):
+        print("frames:      %d" % self.frames)
+        print("format:      %s, %s Hz" % (self.format, self.sample_rate))
+        if elapsed > 0:
+            print("throughput:  %.0f payload bytes/s, %.0f samples/s" % (self.payload_bytes / elapsed, self.samples / elapsed))
+        print("gaps:        %d (%d frames lost)" % (self.gaps, self.lost))
+        print("crc errors:  %d" % self.crc_errors)
+        print("skipped:     %d bytes" % self.skipped)
+        if self.latencies:
+            relative = sorted((l - self.min_offset) / 1000.0 for l in self.latencies)
+            print("latency:     mean %.2f ms, p95 %.2f ms, max %.2f ms (above minimum)" % (
+                sum(relative) / len(relative), relative[int(0.95 * (len(relative) - 1))], relative[-1]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Receive and check a StreamFramer stream.")
+    parser.add_argument("--port", help="serial port to receive from (requires pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--seconds", type=float, default=10.0, help="receive duration when reading from --port")
+    parser.add_argument("--input", help="previously captured raw serial data (latency is not meaningful)")
+    parser.add_argument("--output", help="file to write the concatenated payloads to")
+    args = parser.parse_args()
+
+    receiver = Receiver()
+    if args.output:
+        receiver.output = open(args.output, "wb")
+
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.05) as s:
+            s.reset_input_buffer()
+            start = time.time()
+            while time.time() - start < args.seconds:
+                data = s.read(4096)
+                if data:
+                    receiver.feed(data, time.time())
+            elapsed = time.time() - start
+    elif args.input:
+        with open(args.input, "rb") as f:
+            receiver.feed(f.read(), time.time())
+        elapsed = 0
+    else:
+        parser.error("one of --port or --input is required")
+
+    if receiver.output:
+        receiver.output.close()
+
+    receiver.report(elapsed)
+    return 0 if receiver.frames else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
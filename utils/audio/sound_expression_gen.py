@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Lancaster University.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Generates source/samples/SoundExpressionBuiltins.h, the built-in sound expressions ("giggle", "happy", ...)
+   compiled for SoundExpressionPlayer.
+
+   The built-in sounds are defined by the CODAL library, not by this tree, so they are read from its
+   SoundExpressions.cpp, as checked out by build.py. Every lower case name string that is followed, with
+   only punctuation or an assignment between them, by a string of comma separated 72 digit frames is taken
+   as a built-in. Adjacent string literals are joined first, as the compiler would.
+
+   Build with "SOUND_EXPRESSION_BUILTINS": 1 in the config section of codal.json to include the table.
+
+   USAGE: sound_expression_gen.py [libraries/codal-microbit-v2/source/SoundExpressions.cpp] > source/samples/SoundExpressionBuiltins.h
+"""
+
+import argparse
+import re
+import sys
+
+DEFAULT_SOURCE = "libraries/codal-microbit-v2/source/SoundExpressions.cpp"
+FRAME_LENGTH = 72
+
+STRING = re.compile(r'"((?:[^"\\]|\\.)*)"')
+ADJACENT = re.compile(r'"\s*"')
+NAME = re.compile(r'^[a-z]+$')
+EXPRESSION = re.compile(r'^\d{%d}(,\d{%d})*$' % (FRAME_LENGTH, FRAME_LENGTH))
+BETWEEN = re.compile(r'^[\s,:(){}\[\]]*(\w+\s*=)?\s*$')
+
+
+def builtins(source):
+    """Finds the (name, expression) pairs in the given C++ source, in the order they appear."""
+    source = re.sub(r'//[^\n]*', '', source)
+    source = ADJACENT.sub('', source)
+    strings = list(STRING.finditer(source))
+    found = []
+    for name, expression in zip(strings, strings[1:]):
+        between = source[name.end():expression.start()]
+        if NAME.match(name.group(1)) and EXPRESSION.match(expression.group(1)) and BETWEEN.match(between):
+            if name.group(1) not in [n for n, _ in found]:
+                found.append((name.group(1), expression.group(1)))
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the built-in sound expression table from the CODAL sources.")
+    parser.add_argument("source", nargs="?", default=DEFAULT_SOURCE, help="CODAL SoundExpressions.cpp")
+    args = parser.parse_args()
+
+    with open(args.source) as f:
+        sounds = builtins(f.read())
+
+    if not sounds:
+        sys.stderr.write("No built-in sound expressions found in %s\n" % args.source)
+        return 1
+
+    print("// Generated by utils/audio/sound_expression_gen.py from %s." % args.source)
+    print("// The encoded strings are only used in constant expressions, so only the compiled frames are stored.")
+    print()
+    for name, expression in sounds:
+        frames = expression.split(",")
+        print("#define SOUND_EXPRESSION_BUILTIN_%s \\" % name.upper())
+        print("    \"" + ",\" \\\n    \"".join(frames) + "\"")
+        print()
+        print("static constexpr SoundExpressionFrame sound_expression_builtin_%s[] = {" % name)
+        for i in range(len(frames)):
+            print("    sound_expression_compile(SOUND_EXPRESSION_BUILTIN_%s, %d)," % (name.upper(), i))
+        print("};")
+        print()
+    print("#define SOUND_EXPRESSION_BUILTIN_COUNT  %d" % len(sounds))
+    print()
+    print("static const SoundExpressionEntry sound_expression_builtins[SOUND_EXPRESSION_BUILTIN_COUNT] = {")
+    for name, expression in sounds:
+        print("    { \"%s\", sound_expression_builtin_%s, %d }," % (name, name, len(expression.split(","))))
+    print("};")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
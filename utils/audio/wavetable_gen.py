@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Lancaster University.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+
+"""Generates the wavetables in source/samples/WavetableTone.cpp.
+
+   Each table holds WAVETABLE_SIZE samples of one cycle, from 0 to 1023, plus a copy of the first
+   sample so that interpolation never needs to wrap.
+
+   USAGE: wavetable_gen.py > tables.inc
+"""
+
+import math
+
+WAVETABLE_SIZE = 256
+MAX_VALUE = 1023
+
+
+def additive(harmonics):
+    """One cycle built from (harmonic, amplitude) pairs, in sine phase."""
+    return [sum(a * math.sin(2 * math.pi * h * i / WAVETABLE_SIZE) for h, a in harmonics)
+            for i in range(WAVETABLE_SIZE)]
+
+
+def noise():
+    """Uniform noise from a fixed LCG, so the table is the same on every run."""
+    state = 1
+    out = []
+    for _ in range(WAVETABLE_SIZE):
+        state = (state * 1664525 + 1013904223) & 0xFFFFFFFF
+        out.append((state >> 16) / 32768.0 - 1.0)
+    return out
+
+
+TABLES = [
+    ("sine", "A pure sine.",
+     additive([(1, 1.0)])),
+    ("triangle", "A triangle, rising from the midpoint.",
+     [1 - abs(((i / WAVETABLE_SIZE + 0.25) % 1.0) * 4 - 2) for i in range(WAVETABLE_SIZE)]),
+    ("sawtooth", "A rising sawtooth.",
+     [2.0 * i / WAVETABLE_SIZE - 1 for i in range(WAVETABLE_SIZE)]),
+    ("square", "A square, high for the first half cycle.",
+     [1.0 if i < WAVETABLE_SIZE // 2 else -1.0 for i in range(WAVETABLE_SIZE)]),
+    ("organ", "Drawbar organ: the fundamental with its octave, twelfth, fifteenth and twenty-second.",
+     additive([(1, 1.0), (2, 0.5), (3, 0.25), (4, 0.25), (8, 0.125)])),
+    ("reed", "Reed: odd harmonics up to the fifteenth, falling at 1/n^1.5.",
+     additive([(h, h ** -1.5) for h in range(1, 16, 2)])),
+    ("pitched_noise", "One cycle of noise, repeated at the frequency of the tone, so it sounds as a pitched buzz.",
+     noise()),
+]
+
+
+def scale(samples):
+    """Scales a cycle to fill 0..MAX_VALUE, and appends the guard sample."""
+    peak = max(abs(s) for s in samples)
+    values = [int(round((s / peak + 1) * MAX_VALUE / 2)) for s in samples]
+    return values + values[:1]
+
+
+def main():
+    for name, description, samples in TABLES:
+        values = scale(samples)
+        print("// %s" % description)
+        print("static const uint16_t wavetable_%s[WAVETABLE_SIZE + 1] = {" % name)
+        for i in range(0, len(values), 16):
+            print("    " + ", ".join("%d" % v for v in values[i:i + 16]) + ",")
+        print("};")
+        print()
+
+
+if __name__ == "__main__":
+    main()